@@ -11,16 +11,73 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <sys/wait.h>
 
 #include "skip_list.h"
+#include "unrolled_skip_list.h"
+#include "string_skip_list.h"
+#include "shared_skip_list.h"
+#include "memtable.h"
 
 using namespace std;
 
 size_t num_threads = 1;
 SkipList skiplist;
+UnrolledSkipList unrolled_skiplist;
+StringSkipList string_skiplist;
+SharedSkipList shared_skiplist;
+MemTable *memtable;
 size_t max_number = 100;
+int hit_ratio = 50;
+bool lazy_index = false;
 struct timespec start_time, end_time;
 
+// Number of keys passed to one multi_get call
+#define MULTI_GET_BATCH 256
+
+// Snapshot written and loaded by the load benchmark
+#define SNAPSHOT_FILE "benchmark_snapshot.bin"
+
+// Write-ahead log of the wal benchmark
+#define LOG_FILE "benchmark.wal"
+
+// Skew of the keys of the cache benchmark
+#define ZIPF_THETA 0.99
+
+// Interval of the index maintenance of the contention benchmarks with --lazy_index
+#define INDEX_INTERVAL_MS 1
+
+// The reverse benchmark asks for the REVERSE_LIMIT largest keys not greater than a number. The forward scan
+// guesses they are among the REVERSE_WINDOW keys before it.
+#define REVERSE_LIMIT 10
+#define REVERSE_WINDOW 1000
+
+// Number of keys per page of the paginate benchmark
+#define PAGE_SIZE 1000
+
+// Number of intervals summed by the aggregate benchmark, and their largest length
+#define AGGREGATE_QUERIES 1000
+#define AGGREGATE_WINDOW 100000
+
+// Number of values per key of the multimap benchmark
+#define MULTIMAP_VALUES 100
+
+// Number of sites and sections of the URL keys of the strings benchmark
+#define URL_SITES 100
+#define URL_SECTIONS 50
+
+// Length of the values of the value log benchmark
+#define LARGE_VALUE_LENGTH 200
+
+/**
+    Latencies in nanoseconds of the inserts of the contention benchmarks, appended by each thread when it is done
+*/
+vector<long long> add_latencies;
+mutex latency_mutex;
+
 /**
     Integers to be used for operations
 */
@@ -34,17 +91,38 @@ vector<pair<int,int>> numbers_range;
 */
 void show_usage(){
 	cout << "Usage: \n\n" ;
-	cout << "./benchmark [--name] -i <max_number> -t <num_threads> --benchmark=<insert, delete, search, range, all_operations, high_contention, low_contention> [--help] \n" ;
+	cout << "./benchmark [--name] -i <max_number> -t <num_threads> --benchmark=<insert, delete, search, range, all_operations, high_contention, low_contention, multiget, unrolled, remove_range, load, wal, memtable, filter, hash, cache, queue, reshard, reverse, paginate, aggregate, multimap, strings, value_log, shared> [--hit_ratio=<percent>] [--lazy_index] [--stats] [--help] \n" ;
 	cout << "--name                         Prints full name \n" ;
 	cout << "-i <max_number>                Numbers from 0 to max_number are inserted into skip list, subset is chosen for get, delete, and range \n" ;
 	cout << "-t <num_threads>               Max number of threads to use \n" ;
 	cout << "--benchmark=<insert>           Performs multithreaded insert based on input \n" ;
 	cout << "--benchmark=<delete>           Performs multithreaded delete based on input \n" ;
 	cout << "--benchmark=<search>           Performs multithreaded search based on input \n" ;
-	cout << "--benchmark=<range>            Performs multithreaded range based on input \n" ;
+	cout << "--benchmark=<range>            Compares a scan of all numbers with parallel_scan from 1 to num_threads threads, then performs multithreaded range based on input \n" ;
 	cout << "--benchmark=<all_operations>   Performs multithreaded all operations \n" ;
 	cout << "--benchmark=<high_contention>  Simulates high contention \n" ;
 	cout << "--benchmark=<low_contention>   Simulates low contention \n" ;
+	cout << "--benchmark=<multiget>         Compares a loop of search with batched multi_get on shuffled keys \n" ;
+	cout << "--benchmark=<unrolled>         Compares search on the skip list with the unrolled skip list \n" ;
+	cout << "--benchmark=<remove_range>     Performs multithreaded delete of all numbers, one remove_range per thread \n" ;
+	cout << "--benchmark=<load>             Compares rebuilding the skip list from a snapshot with load and with add \n" ;
+	cout << "--benchmark=<wal>              Compares insert throughput with each write-ahead log mode, from 1 to num_threads threads \n" ;
+	cout << "--benchmark=<memtable>         Performs multithreaded insert and search on a memtable flushing to run files \n" ;
+	cout << "--benchmark=<filter>           Compares search with and without a counting bloom filter \n" ;
+	cout << "--benchmark=<hash>             Compares search on shuffled keys with and without a hash index \n" ;
+	cout << "--benchmark=<cache>            Looks up Zipfian keys in a bounded skip list, inserting the misses, and prints the hit rate \n" ;
+	cout << "--benchmark=<queue>            Compares pop_min with pop_min_relaxed, from 1 to num_threads threads \n" ;
+	cout << "--benchmark=<reshard>          Compares moving the upper half of the keys to a new skip list with range, add and remove and with split_at \n" ;
+	cout << "--benchmark=<reverse>          Compares finding the 10 largest keys below a number with a forward range and with a descending scan \n" ;
+	cout << "--benchmark=<paginate>         Compares reading all the keys with one range and in pages of 1000 keys \n" ;
+	cout << "--benchmark=<aggregate>        Compares summing the values of random intervals by folding range and with aggregate \n" ;
+	cout << "--benchmark=<multimap>         Compares adding 100 values per key to a multimap one at a time and with add_all \n" ;
+	cout << "--benchmark=<strings>          Compares insert and search on URL keys in the string skip list with and without abbreviated keys, and their memory. Every insert re-encodes a whole block \n" ;
+	cout << "--benchmark=<value_log>        Compares the node bytes, search and replacing values of 200 bytes stored in the nodes and in a value log, then compacts it \n" ;
+	cout << "--benchmark=<shared>           Compares <num_threads> processes each building its own skip list with one skip list in shared memory \n" ;
+	cout << "--hit_ratio=<percent>          Percentage of the lookups of the filter benchmark which find their key (default 50) \n" ;
+	cout << "--lazy_index                   Contention benchmarks link new nodes at level 0 and build the index in the background \n" ;
+    cout << "--stats                        Prints the skip list statistics after the benchmark \n";
     cout << "--help                         Prints the usage of the program \n"; 
     cout << "\n[ max_number must be between INT_MIN and INT_MAX and exclusive of INT_MIN and INT_MAX ]\n";
 	exit(EXIT_FAILURE);
@@ -61,6 +139,14 @@ void show_elapsed_time(){
 	printf("Elapsed (s): %lf\n",elapsed_s);
 }
 
+/**
+    Display the number of operations per second between start_time and end_time
+*/
+void show_throughput(const char *label, size_t operations){
+    double elapsed_s = (end_time.tv_sec-start_time.tv_sec) + (end_time.tv_nsec-start_time.tv_nsec)/1000000000.0;
+    printf("%s: %lf s, %.0lf ops/s\n", label, elapsed_s, operations / elapsed_s);
+}
+
 void generate_input(int max_number){
     // generating insert data
     for(int i = 1; i <= max_number; i++){
@@ -110,6 +196,47 @@ void skiplist_search(size_t start, size_t end){
 }
 
 
+void skiplist_multi_get(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    vector<string> values;
+    for(size_t i = start; i < end; i += MULTI_GET_BATCH){
+        vector<int> batch(numbers_get.begin() + i, numbers_get.begin() + min(end, i + MULTI_GET_BATCH));
+        skiplist.multi_get(batch, values);
+    }
+}
+
+void unrolled_skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        unrolled_skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void unrolled_skiplist_search(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        string s = unrolled_skiplist.search(numbers_get[i]);
+    }
+}
+
+void memtable_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        memtable->add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void memtable_search(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        string s = memtable->search(numbers_get[i]);
+    }
+}
+
+void skiplist_remove_range(int start, int end){
+    skiplist.remove_range(start, end);
+}
+
 void skiplist_range(int start, int end){
     map<int, string> range_output = skiplist.range(start, end);
 }
@@ -160,6 +287,52 @@ void search_benchmark(){
     threads.clear();
 
 }
+void multiget_benchmark(){
+    vector<thread> threads;
+
+    // multi get
+    int chunk_size = ceil(float(numbers_get.size()) / num_threads);
+    for(size_t i = 0; i < numbers_get.size(); i = i + chunk_size){
+        threads.push_back(thread(skiplist_multi_get, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    threads.clear();
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+void remove_range_benchmark(){
+    vector<thread> threads;
+
+    // one window of the keys per thread
+    int chunk_size = ceil(float(numbers_delete.size()) / num_threads);
+    for(size_t i = 0; i < numbers_delete.size(); i = i + chunk_size){
+        size_t last = min(numbers_delete.size(), i + chunk_size) - 1;
+        threads.push_back(thread(skiplist_remove_range, numbers_delete[i], numbers_delete[last]));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    threads.clear();
+}
+
 void range_benchmark(){
     vector<thread> threads;
 
@@ -175,6 +348,39 @@ void range_benchmark(){
 
 }
 
+/**
+    Counts and sums every number with parallel_scan from 1 to num_threads threads, and prints the speedup over
+    the scan by the calling thread alone
+*/
+void parallel_scan_benchmark(){
+    long long count = 0, sum = 0;
+    double serial_s = 0;
+    for (size_t threads = 1; threads <= num_threads; threads++){
+        // One accumulator per part, padded so that the parts do not share cache lines
+        vector<long long> counts(threads * 8), sums(threads * 8);
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        int parts = skiplist.parallel_scan(1, max_number, threads, [&counts, &sums](int part, int key, const string &value){
+            counts[part * 8]++;
+            sums[part * 8] += key;
+        });
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+
+        long long parallel_count = 0, parallel_sum = 0;
+        for (int i = 0; i < parts; i++){
+            parallel_count += counts[i * 8];
+            parallel_sum += sums[i * 8];
+        }
+        double elapsed_s = (end_time.tv_sec-start_time.tv_sec) + (end_time.tv_nsec-start_time.tv_nsec)/1000000000.0;
+        if(threads == 1){
+            serial_s = elapsed_s;
+            count = parallel_count;
+            sum = parallel_sum;
+        }
+        printf("Parallel scan, %zu threads: %lf s, %.0lf ops/s, speedup %.2lf%s\n", threads, elapsed_s, parallel_count / elapsed_s,
+            serial_s / elapsed_s, parallel_count == count && parallel_sum == sum ? "" : " (MISMATCH)");
+    }
+}
+
 void skiplist_combined_operations(){
 
     int start = (rand() % static_cast<int>(numbers_insert.size() + 1));
@@ -211,17 +417,60 @@ void all_operations_benchmark(){
     concurrent_skiplist_combined();
 }
 
+/**
+    Returns a skip list for the contention benchmarks, with a lazy index maintained in the background if asked for
+*/
+SkipList contention_list(int max_elements){
+    SkipListOptions options;
+    options.lazy_index = lazy_index;
+    SkipList list(max_elements, 0.5, options);
+    list.start_index_maintenance(INDEX_INTERVAL_MS);
+    return list;
+}
+
+/**
+    Adds a batch of latencies measured by one thread
+*/
+void record_latencies(const vector<long long> &latencies){
+    lock_guard<mutex> guard(latency_mutex);
+    add_latencies.insert(add_latencies.end(), latencies.begin(), latencies.end());
+}
+
+/**
+    Prints the write throughput and the median and 99th percentile latency of the inserts
+*/
+void show_latencies(size_t operations){
+    show_throughput("Writes", operations);
+    if(add_latencies.empty()){
+        return;
+    }
+    sort(add_latencies.begin(), add_latencies.end());
+    printf("Insert latency: p50 %lld ns, p99 %lld ns\n", add_latencies[add_latencies.size() / 2], add_latencies[add_latencies.size() * 99 / 100]);
+}
+
+/**
+    Times one insert
+*/
+long long timed_add(int key, string value){
+    auto start = chrono::steady_clock::now();
+    skiplist.add(key, value);
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+
 void high_contention_benchmark_thread(){
+    vector<long long> latencies;
+    latencies.reserve(max_number);
 
     for(size_t i = 0; i < max_number; i++){
-        skiplist.add(3 , "3");
+        latencies.push_back(timed_add(3 , "3"));
         skiplist.remove(3);
     }
 
+    record_latencies(latencies);
 }
 
 void high_contention_benchmark(){   
-    skiplist = SkipList(3, 0.5);
+    skiplist = contention_list(3);
 
     skiplist.add(1, "1");
     skiplist.add(2, "2");
@@ -236,6 +485,16 @@ void high_contention_benchmark(){
     }
 }
 
+void skiplist_timed_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    vector<long long> latencies;
+    latencies.reserve(end - start);
+    for(size_t i = start; i < end; i++){
+        latencies.push_back(timed_add(numbers_insert[i], to_string(numbers_insert[i])));
+    }
+    record_latencies(latencies);
+}
+
 void low_contention_benchmark(){
 
     vector<thread> threads;
@@ -245,12 +504,12 @@ void low_contention_benchmark(){
         numbers_insert.push_back(i);
     }
 
-    skiplist = SkipList(numbers_insert.size(), 0.5);
+    skiplist = contention_list(numbers_insert.size());
 
     // insert
     int chunk_size = ceil(float(numbers_insert.size()) / num_threads);
     for(size_t i = 0; i < numbers_insert.size(); i = i + chunk_size){
-        threads.push_back(thread(skiplist_add, i, i+chunk_size));
+        threads.push_back(thread(skiplist_timed_add, i, i+chunk_size));
     }
     for (auto &th : threads) {
         th.join();
@@ -260,6 +519,634 @@ void low_contention_benchmark(){
 }
 
 
+/**
+    Inserts every number with 1, 2, 4, ... up to num_threads threads, without a log and with each mode of the log
+*/
+void wal_benchmark(){
+    size_t threads = num_threads;
+    const char *labels[] = {"No log", "Sync", "Periodic", "Async"};
+    WalMode modes[] = {WAL_SYNC, WAL_SYNC, WAL_PERIODIC, WAL_ASYNC};
+
+    for(num_threads = 1; num_threads <= threads; num_threads *= 2){
+        for(int i = 0; i < 4; i++){
+            remove(LOG_FILE);
+            skiplist = SkipList(numbers_insert.size(), 0.5);
+            if(i > 0 && !skiplist.open_log(LOG_FILE, modes[i])){
+                cout << "Could not open " << LOG_FILE << "\n";
+                exit(EXIT_FAILURE);
+            }
+            clock_gettime(CLOCK_MONOTONIC,&start_time);
+            insert_benchmark();
+            clock_gettime(CLOCK_MONOTONIC,&end_time);
+            skiplist.close_log();
+
+            char label[64];
+            snprintf(label, sizeof(label), "%zu threads, %s", num_threads, labels[i]);
+            show_throughput(label, numbers_insert.size());
+        }
+    }
+    remove(LOG_FILE);
+    num_threads = threads;
+}
+
+/**
+    Times the search of every number of numbers_get and prints the throughput and the average time per lookup
+*/
+void timed_search(const char *label){
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    search_benchmark();
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    double elapsed_ns = (end_time.tv_sec-start_time.tv_sec)*1000000000.0 + (end_time.tv_nsec-start_time.tv_nsec);
+    printf("%s: %.0lf ops/s, %.0lf ns per lookup per thread\n", label, numbers_get.size() / elapsed_ns * 1000000000.0, elapsed_ns * num_threads / numbers_get.size());
+}
+
+/**
+    Inserts the even numbers into a skip list with and without a filter, then searches a mix of even (hits) and
+    odd (misses) numbers, and misses only
+*/
+void filter_benchmark(){
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        numbers_insert[i] = 2 * numbers_insert[i];
+    }
+
+    mt19937 generator(1);
+    uniform_int_distribution<int> any_number(1, max_number);
+    uniform_int_distribution<int> percent(0, 99);
+    vector<int> mixed(numbers_get.size());
+    vector<int> misses(numbers_get.size());
+    for(size_t i = 0; i < numbers_get.size(); i++){
+        int number = any_number(generator);
+        mixed[i] = percent(generator) < hit_ratio ? 2 * number : 2 * number - 1;
+        misses[i] = 2 * number - 1;
+    }
+
+    SkipListOptions options;
+    options.filter_counters_per_key = 10;
+    SkipList lists[] = {SkipList(numbers_insert.size(), 0.5), SkipList(numbers_insert.size(), 0.5, options)};
+    const char *labels[][2] = {{"No filter, mixed", "No filter, misses"}, {"Filter, mixed", "Filter, misses"}};
+
+    for(int i = 0; i < 2; i++){
+        skiplist = lists[i];
+        insert_benchmark();
+        numbers_get = mixed;
+        timed_search(labels[i][0]);
+        numbers_get = misses;
+        timed_search(labels[i][1]);
+    }
+}
+
+/**
+    Returns count keys between 1 and max_number drawn from a Zipfian distribution.
+    The ranks are mapped to keys by a random permutation, so the hot keys are spread over the skip list.
+*/
+vector<int> zipf_keys(size_t count, int max_number, double theta){
+    vector<double> cumulative(max_number);
+    double sum = 0;
+    for(int rank = 0; rank < max_number; rank++){
+        sum += 1.0 / pow(rank + 1, theta);
+        cumulative[rank] = sum;
+    }
+
+    vector<int> permutation(max_number);
+    for(int i = 0; i < max_number; i++){
+        permutation[i] = i + 1;
+    }
+    mt19937 generator(1);
+    shuffle(permutation.begin(), permutation.end(), generator);
+
+    uniform_real_distribution<double> uniform(0, sum);
+    vector<int> keys(count);
+    for(size_t i = 0; i < count; i++){
+        size_t rank = lower_bound(cumulative.begin(), cumulative.end(), uniform(generator)) - cumulative.begin();
+        keys[i] = permutation[min(rank, (size_t) max_number - 1)];
+    }
+    return keys;
+}
+
+atomic<long long> cache_hits;
+
+/**
+    Looks up the keys of numbers_get and inserts the ones which are missing, like a cache filled on a miss
+*/
+void skiplist_cache_lookup(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    long long hits = 0;
+    for(size_t i = start; i < end; i++){
+        if(skiplist.search(numbers_get[i]) != ""){
+            hits++;
+        }else{
+            skiplist.add(numbers_get[i], to_string(numbers_get[i]));
+        }
+    }
+    cache_hits += hits;
+}
+
+/**
+    Runs the Zipfian lookups against skip lists bounded to 1% and 10% of the keys, and to all of them
+*/
+void cache_benchmark(){
+    numbers_get = zipf_keys(4 * max_number, max_number, ZIPF_THETA);
+
+    int percents[] = {1, 10, 100};
+    for(int i = 0; i < 3; i++){
+        SkipListOptions options;
+        options.cache_max_elements = max(1, (int) max_number * percents[i] / 100);
+        skiplist = SkipList(options.cache_max_elements, 0.5, options);
+        cache_hits = 0;
+
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(skiplist_cache_lookup, numbers_get.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+
+        char label[96];
+        snprintf(label, sizeof(label), "Capacity %d%% of the keys, hit rate %.1lf%%, %lld evictions", percents[i], 100.0 * cache_hits / numbers_get.size(), skiplist.evictions());
+        show_throughput(label, numbers_get.size());
+    }
+}
+
+void skiplist_pop_min(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    int key;
+    string value;
+    for(size_t i = start; i < end; i++){
+        skiplist.pop_min(key, value);
+    }
+}
+
+void skiplist_pop_min_relaxed(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    int key;
+    string value;
+    for(size_t i = start; i < end; i++){
+        skiplist.pop_min_relaxed(key, value, num_threads);
+    }
+}
+
+/**
+    Fills the skip list and pops every number with 1, 2, 4, ... up to num_threads threads, exactly and relaxed
+*/
+void queue_benchmark(){
+    size_t threads = num_threads;
+    const char *labels[] = {"pop_min", "pop_min_relaxed"};
+    void (*pops[])(size_t, size_t) = {skiplist_pop_min, skiplist_pop_min_relaxed};
+
+    for(num_threads = 1; num_threads <= threads; num_threads *= 2){
+        for(int i = 0; i < 2; i++){
+            skiplist = SkipList(numbers_insert.size(), 0.5);
+            insert_benchmark();
+            clock_gettime(CLOCK_MONOTONIC,&start_time);
+            run_chunks(pops[i], numbers_insert.size());
+            clock_gettime(CLOCK_MONOTONIC,&end_time);
+
+            char label[64];
+            snprintf(label, sizeof(label), "%zu threads, %s", num_threads, labels[i]);
+            show_throughput(label, numbers_insert.size());
+        }
+    }
+    num_threads = threads;
+}
+
+/**
+    Finds the largest keys not greater than each number with a forward range over the window before it
+*/
+void skiplist_latest_forward(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        map<int, string> range_output = skiplist.range(numbers_get[i] - REVERSE_WINDOW + 1, numbers_get[i]);
+        vector<pair<int, string>> latest;
+        for (auto it = range_output.rbegin(); it != range_output.rend() && latest.size() < REVERSE_LIMIT; it++){
+            latest.push_back(*it);
+        }
+    }
+}
+
+/**
+    Finds the largest keys not greater than each number with a descending scan
+*/
+void skiplist_latest_reverse(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        vector<pair<int, string>> latest = skiplist.range_limit(1, numbers_get[i], REVERSE_LIMIT, true);
+    }
+}
+
+/**
+    Asks for the REVERSE_LIMIT largest keys not greater than random numbers, with a forward range and discarding
+    what comes before them, and with a descending scan
+*/
+void reverse_benchmark(){
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    insert_benchmark();
+    shuffle(numbers_get.begin(), numbers_get.end(), mt19937(1));
+    numbers_get.resize(min(numbers_get.size(), (size_t) 100000));
+
+    const char *labels[] = {"Forward range and discard", "Descending scan"};
+    void (*scans[])(size_t, size_t) = {skiplist_latest_forward, skiplist_latest_reverse};
+    for(int i = 0; i < 2; i++){
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(scans[i], numbers_get.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+        show_throughput(labels[i], numbers_get.size());
+    }
+}
+
+/**
+    Reads every number back with one range, and then in pages of PAGE_SIZE keys, and prints the time of the
+    longest call
+*/
+void paginate_benchmark(){
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    insert_benchmark();
+
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    size_t total = skiplist.range(1, max_number).size();
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Single range", total);
+
+    long long longest_ns = 0;
+    size_t pages = 0;
+    RangeCursor cursor;
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    map<int, string> page = skiplist.range(1, max_number, PAGE_SIZE, cursor);
+    total = page.size();
+    while(!cursor.done){
+        auto page_start = chrono::steady_clock::now();
+        page = skiplist.range(cursor, PAGE_SIZE);
+        longest_ns = max(longest_ns, (long long) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - page_start).count());
+        total += page.size();
+        pages++;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Pages", total);
+    printf("Longest page: %lld ns over %zu pages\n", longest_ns, pages);
+}
+
+/**
+    Measure of the aggregate benchmark, the value parsed as a number
+*/
+double value_measure(int key, const string &value){
+    return stod(value);
+}
+
+double value_sum(double a, double b){
+    return a + b;
+}
+
+/**
+    Sums the values of AGGREGATE_QUERIES random intervals of up to AGGREGATE_WINDOW keys, first by folding the
+    result of range, then with aggregate. Also prints the cost of the inserts with the aggregates.
+*/
+void aggregate_benchmark(){
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_chunks(skiplist_add, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Insert", numbers_insert.size());
+
+    SkipListOptions options;
+    options.aggregate.measure = value_measure;
+    options.aggregate.combine = value_sum;
+    options.aggregate.identity = 0;
+    SkipList plain = skiplist;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_chunks(skiplist_add, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Insert with aggregates", numbers_insert.size());
+
+    vector<pair<int, int>> intervals;
+    for (int i = 0; i < AGGREGATE_QUERIES; i++){
+        int start = rand() % max_number + 1;
+        intervals.push_back(make_pair(start, start + rand() % AGGREGATE_WINDOW));
+    }
+
+    double folded = 0;
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    for (auto const& interval : intervals){
+        for (auto const& x : plain.range(interval.first, interval.second)){
+            folded += stod(x.second);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Range and fold", intervals.size());
+
+    // The first call repairs the aggregates left stale by the inserts
+    double total = 0, aggregated = 0;
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    skiplist.aggregate(1, max_number, total);
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("First aggregate", 1);
+
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    for (auto const& interval : intervals){
+        skiplist.aggregate(interval.first, interval.second, total);
+        aggregated += total;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Aggregate", intervals.size());
+    if(aggregated != folded){
+        printf("Sums differ: %lf and %lf\n", folded, aggregated);
+    }
+}
+
+/**
+    Adds the numbers to the multimap, each as a value of the key number / MULTIMAP_VALUES
+*/
+void skiplist_multimap_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i] / MULTIMAP_VALUES, to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Adds the numbers to the multimap with one add_all per key
+*/
+void skiplist_multimap_add_all(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    vector<string> values;
+    for(size_t i = start; i < end; i++){
+        values.push_back(to_string(numbers_insert[i]));
+        if(i + 1 == end || numbers_insert[i + 1] / MULTIMAP_VALUES != numbers_insert[i] / MULTIMAP_VALUES){
+            skiplist.add_all(numbers_insert[i] / MULTIMAP_VALUES, values);
+            values.clear();
+        }
+    }
+}
+
+/**
+    Adds MULTIMAP_VALUES values per key to a multimap, one at a time and then with add_all, and reads them back
+    with equal_range
+*/
+void multimap_benchmark(){
+    SkipListOptions options;
+    options.multimap = true;
+
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_chunks(skiplist_multimap_add, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Add", numbers_insert.size());
+
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_chunks(skiplist_multimap_add_all, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Add all", numbers_insert.size());
+
+    size_t values = 0;
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    for (size_t key = 0; key <= max_number / MULTIMAP_VALUES; key++){
+        values += skiplist.equal_range(key).size();
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Equal range", values);
+}
+
+/**
+    URL keys of the strings benchmark, indexed by number
+*/
+vector<string> url_keys;
+
+/**
+    Returns a URL for the number. Numbers close to each other share their site and section.
+*/
+string url_key(int number){
+    return "https://www.site-" + to_string(number / (URL_SITES * URL_SECTIONS) % URL_SITES) + ".example.com/catalog/section-"
+        + to_string(number / URL_SITES % URL_SECTIONS) + "/item-" + to_string(number) + ".html";
+}
+
+void string_skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        string_skiplist.add(url_keys[numbers_insert[i]], to_string(numbers_insert[i]));
+    }
+}
+
+void string_skiplist_search(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        string s = string_skiplist.search(url_keys[numbers_get[i]]);
+    }
+}
+
+/**
+    Inserts and searches URL keys in the string skip list comparing abbreviated keys and comparing whole keys, and
+    prints the bytes per key of the string skip list next to the raw key bytes and to keys stored one std::string each
+*/
+void strings_benchmark(){
+    url_keys.clear();
+    for (size_t number = 0; number <= max_number; number++){
+        url_keys.push_back(url_key(number));
+    }
+
+    // Every insert decodes and encodes again the whole block of its key
+    const char *insert_labels[] = {"Insert, whole keys", "Insert, abbreviated keys"};
+    const char *labels[] = {"Search, whole keys", "Search, abbreviated keys"};
+    for (int abbreviated = 0; abbreviated <= 1; abbreviated++){
+        string_skiplist = StringSkipList(numbers_insert.size(), 0.5, abbreviated);
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(string_skiplist_add, numbers_insert.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+        show_throughput(insert_labels[abbreviated], numbers_insert.size());
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(string_skiplist_search, numbers_get.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+        show_throughput(labels[abbreviated], numbers_get.size());
+    }
+
+    // A std::string longer than its inline buffer allocates its bytes apart
+    double raw_bytes = 0, string_bytes = 0;
+    for (size_t i = 0; i < numbers_insert.size(); i++){
+        const string &key = url_keys[numbers_insert[i]];
+        raw_bytes += key.size();
+        string_bytes += sizeof(string) + (key.size() > 15 ? key.size() + 1 : 0);
+    }
+    size_t keys = numbers_insert.size();
+    printf("Bytes per key: raw %.1lf, std::string %.1lf, string skip list %.1lf\n", raw_bytes / keys, string_bytes / keys,
+        (double) string_skiplist.memory_usage() / keys);
+}
+
+/**
+    Returns a value of LARGE_VALUE_LENGTH bytes for the number
+*/
+string large_value(int number){
+    string value = to_string(number) + "-";
+    return value + string(LARGE_VALUE_LENGTH - value.size(), 'v');
+}
+
+void skiplist_add_large(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], large_value(numbers_insert[i]));
+    }
+}
+
+/**
+    Replaces the value of every number, with update when the skip list has a value log and with remove and add
+    otherwise
+*/
+void skiplist_replace_large(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(!skiplist.update(numbers_insert[i], large_value(numbers_insert[i] + 1))){
+            skiplist.remove(numbers_insert[i]);
+            skiplist.add(numbers_insert[i], large_value(numbers_insert[i] + 1));
+        }
+    }
+}
+
+/**
+    Adds values of LARGE_VALUE_LENGTH bytes with the values in the nodes and in a value log, then compares the
+    bytes of the nodes, search, and replacing every value. Then compacts the value log.
+*/
+void value_log_benchmark(){
+    const char *labels[] = {"values in the nodes", "value log"};
+    for (int separated = 0; separated <= 1; separated++){
+        SkipListOptions options;
+        options.value_log = separated;
+        skiplist = SkipList(numbers_insert.size(), 0.5, options);
+        run_chunks(skiplist_add_large, numbers_insert.size());
+        printf("Node bytes per key, %s: %.1lf\n", labels[separated], (double) skiplist.stats().node_bytes / numbers_insert.size());
+
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(skiplist_search, numbers_get.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+        show_throughput((string("Search, ") + labels[separated]).c_str(), numbers_get.size());
+
+        clock_gettime(CLOCK_MONOTONIC,&start_time);
+        run_chunks(skiplist_replace_large, numbers_insert.size());
+        clock_gettime(CLOCK_MONOTONIC,&end_time);
+        show_throughput((string("Replace, ") + labels[separated]).c_str(), numbers_insert.size());
+    }
+
+    long long live = 0, segments = 0;
+    skiplist.value_log_usage(live, segments);
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    long long freed = skiplist.compact_values();
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    double seconds = (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+    printf("Compaction: %lld of %lld segment bytes freed in %lf seconds, %lld bytes live\n", freed, segments, seconds, live);
+}
+
+/**
+    Builds a skip list of every number, as each worker process does when it keeps its own copy
+*/
+void skiplist_copy(size_t start, size_t end){
+    SkipList copy(numbers_insert.size(), 0.5);
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        copy.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void shared_skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        shared_skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void shared_skiplist_search(size_t start, size_t end){
+    if(end >= numbers_get.size()) end = numbers_get.size();
+    for(size_t i = start; i < end; i++){
+        string s = shared_skiplist.search(numbers_get[i]);
+    }
+}
+
+/**
+    Runs the function over the vector in num_threads processes, one part per process
+*/
+void run_processes(void (*function)(size_t, size_t), size_t size){
+    vector<pid_t> children;
+    int part_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + part_size){
+        pid_t pid = fork();
+        if(pid == 0){
+            function(i, i + part_size);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (size_t i = 0; i < children.size(); i++){
+        waitpid(children[i], NULL, 0);
+    }
+}
+
+/**
+    Compares num_threads worker processes each building its own skip list of the numbers with the processes
+    building one skip list in shared memory, then searching it
+*/
+void shared_benchmark(){
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    insert_benchmark();
+    long long copy_bytes = skiplist.stats().node_bytes;
+
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_processes(skiplist_copy, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Insert, a copy per process", numbers_insert.size());
+
+    string name = "/skiplist_benchmark_" + to_string(getpid());
+    SharedSkipList::remove_region(name);
+    if(!shared_skiplist.create(name, (uint64_t) numbers_insert.size() * 256 + (1 << 20), numbers_insert.size(), 0.5)){
+        cout << "Shared memory region could not be created" << endl;
+        return;
+    }
+
+    // The processes inherit the mapping of the region
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_processes(shared_skiplist_add, numbers_insert.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Insert, shared", numbers_insert.size());
+
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    run_processes(shared_skiplist_search, numbers_get.size());
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Search, shared", numbers_get.size());
+
+    printf("Bytes: %lu copies %lld, shared region %lld\n", num_threads, copy_bytes * (long long) num_threads,
+        shared_skiplist.memory_usage());
+    shared_skiplist.close();
+    SharedSkipList::remove_region(name);
+}
+
+/**
+    Moves the upper half of the numbers to a new skip list, first with range, add and remove, then with split_at.
+    Then puts them back with concat.
+*/
+void reshard_benchmark(){
+    int middle = max_number / 2 + 1;
+    size_t moved = max_number - middle + 1;
+
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    insert_benchmark();
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    SkipList upper(numbers_insert.size(), 0.5);
+    map<int, string> range_output = skiplist.range(middle, max_number);
+    for (auto const& x : range_output){
+        upper.add(x.first, x.second);
+    }
+    for (auto const& x : range_output){
+        skiplist.remove(x.first);
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Range, add and remove", moved);
+
+    // split_at needs a skip list to fill, not one holding the keys moved above
+    upper.destroy();
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    insert_benchmark();
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    skiplist.split_at(middle, upper);
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Split", moved);
+
+    clock_gettime(CLOCK_MONOTONIC,&start_time);
+    skiplist.concat(upper);
+    clock_gettime(CLOCK_MONOTONIC,&end_time);
+    show_throughput("Concat", moved);
+}
+
 /**
     Performs the insert, delete, get and range opetations on the skiplist to benchmark test it.
 */
@@ -269,6 +1156,9 @@ int main(int argc, char *argv[]){
         {"name", no_argument, NULL, 'n'},
         {"benchmark", required_argument, NULL, 'b'},
         {"help", no_argument, NULL, 'h'},
+        {"stats", no_argument, NULL, 's'},
+        {"hit_ratio", required_argument, NULL, 'r'},
+        {"lazy_index", no_argument, NULL, 'l'},
         {0, 0, 0, 0}
     };
 
@@ -276,6 +1166,7 @@ int main(int argc, char *argv[]){
     bool name = false;
     string benchmark = "";
     bool help = false;
+    bool stats = false;
 
     while (true) {
         int option_index = 0;
@@ -294,6 +1185,15 @@ int main(int argc, char *argv[]){
             case 'h':
                 help = true;
                 break;
+            case 's':
+                stats = true;
+                break;
+            case 'r':
+                hit_ratio = stoi(optarg);
+                break;
+            case 'l':
+                lazy_index = true;
+                break;
             case 't':
                 num_threads = stoi(optarg);
                 break;
@@ -334,6 +1234,13 @@ int main(int argc, char *argv[]){
                 clock_gettime(CLOCK_MONOTONIC,&start_time);
                 delete_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "remove_range"){
+                generate_input(max_number);
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                insert_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                remove_range_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
 	        }else if (benchmark == "search"){
                 generate_input(max_number);
                 skiplist = SkipList(numbers_insert.size(), 0.5);
@@ -345,6 +1252,7 @@ int main(int argc, char *argv[]){
                 generate_input(max_number);
                 skiplist = SkipList(numbers_insert.size(), 0.5);
                 insert_benchmark();
+                parallel_scan_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&start_time);
                 range_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&end_time);
@@ -355,19 +1263,153 @@ int main(int argc, char *argv[]){
                 clock_gettime(CLOCK_MONOTONIC,&start_time);
                 all_operations_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "multiget"){
+                generate_input(max_number);
+                shuffle(numbers_get.begin(), numbers_get.end(), mt19937(1));
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                insert_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                search_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Search loop", numbers_get.size());
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                multiget_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Multi get", numbers_get.size());
+	        }else if (benchmark == "unrolled"){
+                generate_input(max_number);
+                shuffle(numbers_get.begin(), numbers_get.end(), mt19937(1));
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                unrolled_skiplist = UnrolledSkipList(numbers_insert.size(), 0.5);
+                insert_benchmark();
+                run_chunks(unrolled_skiplist_add, numbers_insert.size());
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                search_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Skip list search", numbers_get.size());
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                run_chunks(unrolled_skiplist_search, numbers_get.size());
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Unrolled skip list search", numbers_get.size());
+	        }else if (benchmark == "load"){
+                generate_input(max_number);
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                insert_benchmark();
+                if(!skiplist.save(SNAPSHOT_FILE)){
+                    cout << "Could not write " << SNAPSHOT_FILE << "\n";
+                    exit(EXIT_FAILURE);
+                }
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                insert_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Replay with add", numbers_insert.size());
+                skiplist = SkipList(numbers_insert.size(), 0.5);
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                skiplist.load(SNAPSHOT_FILE);
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Load snapshot", numbers_insert.size());
+                remove(SNAPSHOT_FILE);
+	        }else if (benchmark == "wal"){
+                generate_input(max_number);
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                wal_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "memtable"){
+                generate_input(max_number);
+                shuffle(numbers_insert.begin(), numbers_insert.end(), mt19937(1));
+                shuffle(numbers_get.begin(), numbers_get.end(), mt19937(2));
+                memtable = new MemTable(MemTableOptions());
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                run_chunks(memtable_add, numbers_insert.size());
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Memtable insert", numbers_insert.size());
+                memtable->flush();
+                printf("Run files: %zu\n", memtable->run_count());
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                run_chunks(memtable_search, numbers_get.size());
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+                show_throughput("Memtable search", numbers_get.size());
+                size_t runs = memtable->run_count();
+                delete memtable;
+                for (size_t i = 0; i < runs; i++){
+                    remove(("./run_" + to_string(i) + ".sst").c_str());
+                }
+	        }else if (benchmark == "filter"){
+                generate_input(max_number);
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                filter_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "hash"){
+                generate_input(max_number);
+                shuffle(numbers_get.begin(), numbers_get.end(), mt19937(1));
+                SkipListOptions options;
+                options.hash_index = true;
+                SkipList lists[] = {SkipList(numbers_insert.size(), 0.5), SkipList(numbers_insert.size(), 0.5, options)};
+                const char *labels[] = {"Skip list search", "Hash index search"};
+                for(int i = 0; i < 2; i++){
+                    skiplist = lists[i];
+                    insert_benchmark();
+                    clock_gettime(CLOCK_MONOTONIC,&start_time);
+                    search_benchmark();
+                    clock_gettime(CLOCK_MONOTONIC,&end_time);
+                    show_throughput(labels[i], numbers_get.size());
+                }
+	        }else if (benchmark == "cache"){
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                cache_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "queue"){
+                generate_input(max_number);
+                clock_gettime(CLOCK_MONOTONIC,&start_time);
+                queue_benchmark();
+                clock_gettime(CLOCK_MONOTONIC,&end_time);
+	        }else if (benchmark == "reshard"){
+                generate_input(max_number);
+                reshard_benchmark();
+	        }else if (benchmark == "reverse"){
+                generate_input(max_number);
+                reverse_benchmark();
+	        }else if (benchmark == "paginate"){
+                generate_input(max_number);
+                paginate_benchmark();
+	        }else if (benchmark == "aggregate"){
+                generate_input(max_number);
+                aggregate_benchmark();
+	        }else if (benchmark == "multimap"){
+                generate_input(max_number);
+                multimap_benchmark();
+	        }else if (benchmark == "strings"){
+                generate_input(max_number);
+                shuffle(numbers_insert.begin(), numbers_insert.end(), mt19937(1));
+                shuffle(numbers_get.begin(), numbers_get.end(), mt19937(2));
+                strings_benchmark();
+	        }else if (benchmark == "value_log"){
+                generate_input(max_number);
+                value_log_benchmark();
+	        }else if (benchmark == "shared"){
+                generate_input(max_number);
+                shared_benchmark();
 	        }else if (benchmark == "high_contention"){
                 clock_gettime(CLOCK_MONOTONIC,&start_time);
                 high_contention_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&end_time);
+                skiplist.stop_index_maintenance();
+                show_latencies(2 * num_threads * max_number);
 	        }else if (benchmark == "low_contention"){
                 clock_gettime(CLOCK_MONOTONIC,&start_time);
                 low_contention_benchmark();
                 clock_gettime(CLOCK_MONOTONIC,&end_time);
+                skiplist.stop_index_maintenance();
+                show_latencies(max_number);
 	        }else{
 	            cout << "Invalid benchmark type \n";
 	            show_usage();
 	        }
             show_elapsed_time();
+            if(stats){
+                print_stats(skiplist.stats(), cout);
+            }
 	    }
     }else{
         show_usage();
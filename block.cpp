@@ -0,0 +1,140 @@
+/**
+    One block of sorted keys in the unrolled skip list and its properties
+*/
+
+#include <limits>
+#include "block.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+    Constructor
+*/
+Block::Block(int l, int level){
+    low = l;
+    for (int i = 0; i < BLOCK_CAPACITY; i++){
+        keys[i].store(numeric_limits<int>::max(), memory_order_relaxed);
+        values[i].store(NULL, memory_order_relaxed);
+    }
+    count.store(0, memory_order_relaxed);
+    removed.store(false, memory_order_relaxed);
+    version.store(0, memory_order_relaxed);
+    next = new atomic<Block*>[level + 1];
+    for (int i = 0; i <= level; i++){
+        next[i].store(NULL, memory_order_relaxed);
+    }
+    top_level = level;
+}
+
+/**
+    Returns the number of keys in the block smaller than key, which is the position of key if present.
+    Uses AVX2 or SSE2 compare and movemask when available, otherwise a scalar loop.
+    The keys are copied first, as a writer may be storing them meanwhile.
+*/
+int Block::lower_bound(int key){
+    int copied[BLOCK_CAPACITY];
+    for (int i = 0; i < BLOCK_CAPACITY; i++){
+        copied[i] = keys[i].load(memory_order_acquire);
+    }
+
+    int position = 0;
+#if defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi32(key);
+    for (int i = 0; i < BLOCK_CAPACITY; i += 8){
+        __m256i chunk = _mm256_loadu_si256((const __m256i*) (copied + i));
+        __m256i smaller = _mm256_cmpgt_epi32(needle, chunk);
+        position += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(smaller)));
+    }
+#elif defined(__SSE2__)
+    __m128i needle = _mm_set1_epi32(key);
+    for (int i = 0; i < BLOCK_CAPACITY; i += 4){
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (copied + i));
+        __m128i smaller = _mm_cmplt_epi32(chunk, needle);
+        position += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(smaller)));
+    }
+#else
+    for (int i = 0; i < BLOCK_CAPACITY; i++){
+        position += copied[i] < key;
+    }
+#endif
+    return position;
+}
+
+/**
+    Inserts the key and value at the position, shifting the larger keys right. The block must not be full.
+    Called by a writer holding the lock of the block.
+*/
+void Block::insert_at(int position, int key, string *value){
+    int n = count.load(memory_order_relaxed);
+    for (int i = n; i > position; i--){
+        keys[i].store(keys[i - 1].load(memory_order_relaxed), memory_order_release);
+        values[i].store(values[i - 1].load(memory_order_relaxed), memory_order_release);
+    }
+    keys[position].store(key, memory_order_release);
+    values[position].store(value, memory_order_release);
+    count.store(n + 1, memory_order_release);
+}
+
+/**
+    Removes the key at the position, shifting the larger keys left.
+    Called by a writer holding the lock of the block.
+*/
+void Block::erase_at(int position){
+    int n = count.load(memory_order_relaxed);
+    for (int i = position; i < n - 1; i++){
+        keys[i].store(keys[i + 1].load(memory_order_relaxed), memory_order_release);
+        values[i].store(values[i + 1].load(memory_order_relaxed), memory_order_release);
+    }
+    count.store(n - 1, memory_order_release);
+    keys[n - 1].store(numeric_limits<int>::max(), memory_order_release);
+    values[n - 1].store(NULL, memory_order_release);
+}
+
+/**
+    Returns the next block at the given level
+*/
+Block* Block::get_next(int level){
+    return next[level].load(memory_order_acquire);
+}
+
+/**
+    Links the next block at the given level and publishes it to lock free readers
+*/
+void Block::set_next(int level, Block* block){
+    next[level].store(block, memory_order_release);
+}
+
+/**
+    Locks the block
+*/
+void Block::lock(){
+    block_lock.lock();
+}
+
+/**
+    Unlocks the block
+*/
+void Block::unlock(){
+    block_lock.unlock();
+}
+
+/**
+    Makes the version odd before modifying the block. Called with the lock of the block held.
+    The stores which follow are releases, so a reader which loads one of them loads this version or a later one.
+*/
+void Block::begin_write(){
+    version.store(version.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/**
+    Makes the version even again once the block is modified
+*/
+void Block::end_write(){
+    version.store(version.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+Block::~Block(){
+    delete[] next;
+}
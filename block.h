@@ -0,0 +1,63 @@
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include <mutex>
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+// Number of keys stored in one block. Must be a multiple of 8 for the vector search.
+#define BLOCK_CAPACITY 32
+
+/**
+    One block of the unrolled skip list.
+    Level 0 of the unrolled skip list is a linked list of blocks holding sorted keys, the upper levels index blocks by their low key.
+    Readers load the keys, values and count while writers store them, so they are atomics: writers store them with
+    release and readers load them with acquire, which lets a reader check the version again after its loads
+    without a fence.
+*/
+class Block{
+    public:
+        // Every key stored in the block is greater than or equal to low. Fixed when the block is created.
+        int low;
+
+        // Sorted keys. Unused slots hold INT_MAX so that the vector compare never counts them.
+        atomic<int> keys[BLOCK_CAPACITY];
+
+        // Values are stored out of line so that a block of keys fits in a few cache lines
+        atomic<string*> values[BLOCK_CAPACITY];
+
+        // Number of keys used in the block
+        atomic<int> count;
+
+        // Set once the block is empty and being unlinked. Nothing is added to it any more, and the threads which
+        // reach it look for the block owning their key again.
+        atomic<bool> removed;
+
+        // Even while the block is stable, odd while a writer modifies keys, values, count or the next block at level 0
+        atomic<unsigned long long> version;
+
+        // Lock to lock the block when modifying it
+        mutex block_lock;
+
+        // Stores the reference of the next block until the top level of the block
+        atomic<Block*> *next;
+
+        // The Maximum level until which the block is available
+        int top_level;
+
+        Block(int low, int level);
+        ~Block();
+        int lower_bound(int key);
+        void insert_at(int position, int key, string *value);
+        void erase_at(int position);
+        Block* get_next(int level);
+        void set_next(int level, Block* block);
+        void lock();
+        void unlock();
+        void begin_write();
+        void end_write();
+};
+
+#endif
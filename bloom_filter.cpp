@@ -0,0 +1,129 @@
+/**
+    Implements the hashing of the bloom filters
+*/
+
+#include <stdlib.h>
+#include <new>
+#include "bloom_filter.h"
+
+/**
+    Mixes the key into 64 well distributed bits (the finalizer of splitmix64)
+*/
+uint64_t bloom_hash(int key){
+    uint64_t x = (uint32_t) key;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+    Number of bits set per key which minimises the false positive rate, bits_per_key * ln 2
+*/
+uint32_t bloom_hash_count(int bits_per_key){
+    uint32_t count = (uint32_t) (bits_per_key * 0.69);
+    if(count < 1){
+        count = 1;
+    }
+    if(count > 30){
+        count = 30;
+    }
+    return count;
+}
+
+void bloom_set(unsigned char *bits, uint64_t bit_count, uint32_t hash_count, int key){
+    uint64_t hash = bloom_hash(key);
+    uint32_t h1 = (uint32_t) hash;
+    uint32_t h2 = (uint32_t) (hash >> 32) | 1;
+    for (uint32_t i = 0; i < hash_count; i++){
+        uint64_t bit = (h1 + (uint64_t) i * h2) % bit_count;
+        bits[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+bool bloom_test(const unsigned char *bits, uint64_t bit_count, uint32_t hash_count, int key){
+    uint64_t hash = bloom_hash(key);
+    uint32_t h1 = (uint32_t) hash;
+    uint32_t h2 = (uint32_t) (hash >> 32) | 1;
+    for (uint32_t i = 0; i < hash_count; i++){
+        uint64_t bit = (h1 + (uint64_t) i * h2) % bit_count;
+        if(!(bits[bit / 8] & (1 << (bit % 8)))){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+    Allocates counters_per_key counters for each of max_elements keys, rounded up to whole blocks
+*/
+CountingBloomFilter::CountingBloomFilter(long long max_elements, int counters_per_key){
+    block_count = (max_elements * counters_per_key + COUNTING_BLOOM_BLOCK - 1) / COUNTING_BLOOM_BLOCK;
+    if(block_count == 0){
+        block_count = 1;
+    }
+    hash_count = bloom_hash_count(counters_per_key);
+
+    // Blocks are aligned to the cache line
+    void *memory = NULL;
+    if(posix_memalign(&memory, COUNTING_BLOOM_BLOCK, block_count * COUNTING_BLOOM_BLOCK) != 0){
+        throw bad_alloc();
+    }
+    counters = (atomic<uint8_t>*) memory;
+    for (uint64_t i = 0; i < block_count * COUNTING_BLOOM_BLOCK; i++){
+        new (&counters[i]) atomic<uint8_t>(0);
+    }
+}
+
+/**
+    Block of the key, chosen by the upper half of its hash
+*/
+atomic<uint8_t>* CountingBloomFilter::block(uint64_t hash){
+    return counters + ((hash >> 32) % block_count) * COUNTING_BLOOM_BLOCK;
+}
+
+void CountingBloomFilter::add(int key){
+    uint64_t hash = bloom_hash(key);
+    atomic<uint8_t> *counter = block(hash);
+    uint32_t h1 = (uint32_t) hash;
+    uint32_t h2 = (h1 >> 16) | 1;
+    for (uint32_t i = 0; i < hash_count; i++){
+        atomic<uint8_t> &c = counter[(h1 + i * h2) % COUNTING_BLOOM_BLOCK];
+        uint8_t value = c.load(memory_order_relaxed);
+        while(value != COUNTING_BLOOM_STUCK && !c.compare_exchange_weak(value, value + 1, memory_order_relaxed)){
+        }
+    }
+}
+
+void CountingBloomFilter::remove(int key){
+    uint64_t hash = bloom_hash(key);
+    atomic<uint8_t> *counter = block(hash);
+    uint32_t h1 = (uint32_t) hash;
+    uint32_t h2 = (h1 >> 16) | 1;
+    for (uint32_t i = 0; i < hash_count; i++){
+        atomic<uint8_t> &c = counter[(h1 + i * h2) % COUNTING_BLOOM_BLOCK];
+        uint8_t value = c.load(memory_order_relaxed);
+        while(value != COUNTING_BLOOM_STUCK && value != 0 && !c.compare_exchange_weak(value, value - 1, memory_order_relaxed)){
+        }
+    }
+}
+
+/**
+    Returns false if the key is certainly not in the skip list
+*/
+bool CountingBloomFilter::may_contain(int key){
+    uint64_t hash = bloom_hash(key);
+    atomic<uint8_t> *counter = block(hash);
+    uint32_t h1 = (uint32_t) hash;
+    uint32_t h2 = (h1 >> 16) | 1;
+    for (uint32_t i = 0; i < hash_count; i++){
+        if(counter[(h1 + i * h2) % COUNTING_BLOOM_BLOCK].load(memory_order_relaxed) == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+CountingBloomFilter::~CountingBloomFilter(){
+    free(counters);
+}
@@ -0,0 +1,50 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+/**
+    Bloom filters over integer keys.
+    Every key sets hash_count bits of a bit array, chosen by double hashing of one 64 bit hash of the key.
+    A key whose bits are not all set was never added.
+*/
+
+// Bits per key of the bloom filters of sorted run files, about 1% false positives
+#define BLOOM_BITS_PER_KEY 10
+
+uint64_t bloom_hash(int key);
+uint32_t bloom_hash_count(int bits_per_key);
+void bloom_set(unsigned char *bits, uint64_t bit_count, uint32_t hash_count, int key);
+bool bloom_test(const unsigned char *bits, uint64_t bit_count, uint32_t hash_count, int key);
+
+// Counters per block of the counting bloom filter, one cache line
+#define COUNTING_BLOOM_BLOCK 64
+
+// A counter which reaches this value is never decremented again, so an overflow cannot cause a false negative
+#define COUNTING_BLOOM_STUCK 255
+
+/**
+    Concurrent counting bloom filter, so that keys can be removed as well as added.
+    Each key picks one block of COUNTING_BLOOM_BLOCK 8 bit counters and increments hash_count counters inside it,
+    so a lookup touches a single cache line. Counters are updated with relaxed atomics: an add increments before
+    the key becomes visible and a remove decrements after the key is gone, so a key that exists is never missed.
+*/
+class CountingBloomFilter{
+    private:
+        atomic<uint8_t> *counters;
+        uint64_t block_count;
+        uint32_t hash_count;
+
+        atomic<uint8_t>* block(uint64_t hash);
+    public:
+        CountingBloomFilter(long long max_elements, int counters_per_key);
+        ~CountingBloomFilter();
+        void add(int key);
+        void remove(int key);
+        bool may_contain(int key);
+};
+
+#endif
@@ -0,0 +1,43 @@
+/**
+    Implements the coarse cached clock used for expiry
+*/
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include "coarse_clock.h"
+
+using namespace std;
+
+static atomic<long long> cached_now_ms(0);
+static once_flag clock_started;
+
+/**
+    Reads the wall clock
+*/
+static long long system_now_ms(){
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+    Refreshes the cached time for the lifetime of the process
+*/
+static void start_clock(){
+    cached_now_ms.store(system_now_ms());
+    thread([](){
+        while(true){
+            this_thread::sleep_for(chrono::milliseconds(COARSE_CLOCK_RESOLUTION_MS));
+            cached_now_ms.store(system_now_ms(), memory_order_relaxed);
+        }
+    }).detach();
+}
+
+long long coarse_now_ms(){
+    long long now = cached_now_ms.load(memory_order_relaxed);
+    if(now == 0){
+        call_once(clock_started, start_clock);
+        now = cached_now_ms.load(memory_order_relaxed);
+    }
+    return now;
+}
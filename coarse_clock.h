@@ -0,0 +1,14 @@
+#ifndef COARSE_CLOCK_H
+#define COARSE_CLOCK_H
+
+// Resolution of the coarse clock in milliseconds
+#define COARSE_CLOCK_RESOLUTION_MS 5
+
+/**
+    Wall clock time in milliseconds since the epoch, cached in memory and refreshed every
+    COARSE_CLOCK_RESOLUTION_MS by a background thread, so that reading it is one relaxed load and no system call.
+    The thread is started by the first call.
+*/
+long long coarse_now_ms();
+
+#endif
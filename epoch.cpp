@@ -0,0 +1,166 @@
+/**
+    Implements the epoch based reclamation.
+
+    A thread entering a critical section counts itself in its stripe under the parity of the current epoch, and
+    checks the epoch did not move meanwhile. The epoch moves from e to e + 1 only while no thread is counted
+    under the parity of e - 1, which is also the one of e + 1. An object retired in epoch e may have been loaded
+    by threads which entered in e - 1 or e: those of e - 1 are gone once the epoch reaches e + 1, and those of e
+    once it reaches e + 2.
+*/
+
+#include "epoch.h"
+
+static atomic<unsigned int> next_epoch_stripe(0);
+
+/**
+    Returns the stripe of the calling thread. Threads are assigned stripes round robin on first use.
+*/
+static int local_stripe(){
+    static thread_local int stripe = next_epoch_stripe.fetch_add(1, memory_order_relaxed) % EPOCH_STRIPES;
+    return stripe;
+}
+
+/**
+    Constructor
+*/
+EpochReclaimer::EpochReclaimer(){
+    epoch = 2;
+    for (int i = 0; i < EPOCH_STRIPES; i++){
+        stripes[i].active[0] = 0;
+        stripes[i].active[1] = 0;
+        retired[i].since_reclaim = 0;
+    }
+}
+
+/**
+    Enters a critical section of the calling thread.
+    Returns the ticket to pass to exit.
+*/
+uint64_t EpochReclaimer::enter(){
+    int stripe = local_stripe();
+    while(true){
+        uint64_t current = epoch.load();
+        stripes[stripe].active[current & 1].fetch_add(1);
+        if(epoch.load() == current){
+            return ((uint64_t) stripe << 1) | (current & 1);
+        }
+        stripes[stripe].active[current & 1].fetch_sub(1);
+    }
+}
+
+/**
+    Exits the critical section of a ticket
+*/
+void EpochReclaimer::exit(uint64_t ticket){
+    stripes[ticket >> 1].active[ticket & 1].fetch_sub(1, memory_order_release);
+}
+
+/**
+    Moves the epoch from e to e + 1 if no thread is left in e - 1.
+    Returns false if a thread still is.
+*/
+bool EpochReclaimer::try_advance(){
+    uint64_t current = epoch.load();
+    for (int i = 0; i < EPOCH_STRIPES; i++){
+        if(stripes[i].active[(current + 1) & 1].load() != 0){
+            return false;
+        }
+    }
+    epoch.compare_exchange_strong(current, current + 1);
+    return true;
+}
+
+/**
+    Retires an object the caller removed from every shared structure: deleter frees it once no thread may still
+    be reading it. Every EPOCH_RECLAIM_INTERVAL objects of a stripe, frees what can be freed.
+*/
+void EpochReclaimer::retire(void *object, EpochDeleter deleter, void *context){
+    RetiredList &list = retired[local_stripe()];
+    bool reclaim_now;
+    {
+        lock_guard<mutex> guard(list.retired_mutex);
+        RetiredObject retired_object = {object, context, deleter, epoch.load()};
+        list.objects.push_back(retired_object);
+        reclaim_now = ++list.since_reclaim >= EPOCH_RECLAIM_INTERVAL;
+        if(reclaim_now){
+            list.since_reclaim = 0;
+        }
+    }
+    if(reclaim_now){
+        reclaim();
+    }
+}
+
+/**
+    Advances the epoch as far as the threads in their critical sections allow, up to two epochs, and frees the
+    objects retired at least two epochs ago.
+    Returns the number of objects freed.
+*/
+long long EpochReclaimer::reclaim(){
+    if(try_advance()){
+        try_advance();
+    }
+    uint64_t current = epoch.load();
+
+    long long freed = 0;
+    vector<RetiredObject> safe;
+    for (int i = 0; i < EPOCH_STRIPES; i++){
+        safe.clear();
+        {
+            lock_guard<mutex> guard(retired[i].retired_mutex);
+            vector<RetiredObject> &objects = retired[i].objects;
+            size_t kept = 0;
+            for (size_t j = 0; j < objects.size(); j++){
+                if(objects[j].epoch + 2 <= current){
+                    safe.push_back(objects[j]);
+                }else{
+                    objects[kept++] = objects[j];
+                }
+            }
+            objects.resize(kept);
+        }
+
+        // Deleters run without the lock, they may take locks of their own
+        for (size_t j = 0; j < safe.size(); j++){
+            safe[j].deleter(safe[j].object, safe[j].context);
+        }
+        freed += safe.size();
+    }
+    return freed;
+}
+
+/**
+    Frees every retired object. Only once no thread is in a critical section any more.
+    Returns the number of objects freed.
+*/
+long long EpochReclaimer::drain(){
+    long long freed = 0;
+    for (int i = 0; i < EPOCH_STRIPES; i++){
+        vector<RetiredObject> objects;
+        {
+            lock_guard<mutex> guard(retired[i].retired_mutex);
+            objects.swap(retired[i].objects);
+        }
+        for (size_t j = 0; j < objects.size(); j++){
+            objects[j].deleter(objects[j].object, objects[j].context);
+        }
+        freed += objects.size();
+    }
+    return freed;
+}
+
+/**
+    Returns the number of objects retired and not freed yet
+*/
+long long EpochReclaimer::retired_count(){
+    long long count = 0;
+    for (int i = 0; i < EPOCH_STRIPES; i++){
+        lock_guard<mutex> guard(retired[i].retired_mutex);
+        count += retired[i].objects.size();
+    }
+    return count;
+}
+
+EpochReclaimer::~EpochReclaimer(){
+    drain();
+}
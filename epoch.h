@@ -0,0 +1,99 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// Number of stripes of the threads in a critical section
+#define EPOCH_STRIPES 16
+
+// Number of objects the threads of a stripe retire between two attempts to free them
+#define EPOCH_RECLAIM_INTERVAL 64
+
+/**
+    Frees an object once no thread may still be reading it
+*/
+typedef void (*EpochDeleter)(void *object, void *context);
+
+/**
+    Object removed from the shared structures in an epoch, freed by its deleter two epochs later
+*/
+struct RetiredObject{
+    void *object;
+    void *context;
+    EpochDeleter deleter;
+    uint64_t epoch;
+};
+
+/**
+    Number of threads of a stripe in a critical section, by the parity of the epoch they entered in, padded to
+    a cache line
+*/
+struct EpochStripe{
+    atomic<long long> active[2];
+    char padding[64 - 2 * sizeof(atomic<long long>)];
+};
+
+/**
+    Objects retired by the threads of a stripe
+*/
+struct RetiredList{
+    mutex retired_mutex;
+    vector<RetiredObject> objects;
+    int since_reclaim;
+};
+
+/**
+    Epoch based reclamation. Readers enter a critical section before they load a pointer to a shared object and
+    exit it once they are done with the object, and writers retire an object once they removed it from every
+    shared structure. The epoch only advances once no thread is left in the epoch before it, so an object
+    retired in epoch e is freed once the epoch reaches e + 2, when every thread which may have loaded it has
+    exited. Neither readers nor writers ever wait: a thread staying long in its critical section only delays
+    the freeing.
+*/
+class EpochReclaimer{
+    private:
+        atomic<uint64_t> epoch;
+        EpochStripe stripes[EPOCH_STRIPES];
+        RetiredList retired[EPOCH_STRIPES];
+
+        bool try_advance();
+    public:
+        EpochReclaimer();
+        ~EpochReclaimer();
+
+        uint64_t enter();
+        void exit(uint64_t ticket);
+        void retire(void *object, EpochDeleter deleter, void *context = NULL);
+        long long reclaim();
+        long long drain();
+        long long retired_count();
+};
+
+/**
+    Critical section of the calling thread while the guard is in scope. Does nothing if reclaimer is NULL.
+*/
+struct EpochGuard{
+    EpochReclaimer *reclaimer;
+    uint64_t ticket;
+
+    EpochGuard(EpochReclaimer *r){
+        reclaimer = r;
+        ticket = r != NULL ? r->enter() : 0;
+    }
+
+    ~EpochGuard(){
+        if(reclaimer != NULL){
+            reclaimer->exit(ticket);
+        }
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/**
+    Implements the hash index of the skip list
+*/
+
+#include "hash_index.h"
+#include "bloom_filter.h"
+
+/**
+    Allocates one bucket per expected element, rounded up to a power of two
+*/
+HashIndex::HashIndex(long long max_elements){
+    size_t bucket_count = 1;
+    while((long long) bucket_count < max_elements){
+        bucket_count *= 2;
+    }
+    bucket_mask = bucket_count - 1;
+    buckets = new atomic<Node*>[bucket_count];
+    for (size_t i = 0; i < bucket_count; i++){
+        buckets[i].store(NULL, memory_order_relaxed);
+    }
+}
+
+size_t HashIndex::bucket(int key){
+    return bloom_hash(key) & bucket_mask;
+}
+
+/**
+    Adds the node at the head of its bucket. Called before the node is linked into the skip list.
+*/
+void HashIndex::insert(Node *node){
+    size_t index = bucket(node->get_key());
+    lock_guard<mutex> guard(locks[index % HASH_INDEX_LOCKS]);
+    node->hash_next.store(buckets[index].load(memory_order_relaxed), memory_order_relaxed);
+    buckets[index].store(node, memory_order_release);
+}
+
+/**
+    Unlinks the node from its bucket. Called once the node is unlinked from the skip list.
+*/
+void HashIndex::remove(Node *node){
+    size_t index = bucket(node->get_key());
+    lock_guard<mutex> guard(locks[index % HASH_INDEX_LOCKS]);
+
+    atomic<Node*> *link = &buckets[index];
+    Node *curr = link->load(memory_order_relaxed);
+    while(curr != NULL && curr != node){
+        link = &curr->hash_next;
+        curr = link->load(memory_order_relaxed);
+    }
+    if(curr != NULL){
+        link->store(node->hash_next.load(memory_order_relaxed), memory_order_release);
+    }
+}
+
+/**
+    Returns the node of key which is not marked for delete, or NULL
+*/
+Node* HashIndex::find(int key){
+    Node *curr = buckets[bucket(key)].load(memory_order_acquire);
+    while(curr != NULL){
+        if(curr->get_key() == key && !curr->is_marked()){
+            return curr;
+        }
+        curr = curr->hash_next.load(memory_order_acquire);
+    }
+    return NULL;
+}
+
+HashIndex::~HashIndex(){
+    delete[] buckets;
+}
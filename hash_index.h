@@ -0,0 +1,35 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <atomic>
+#include <mutex>
+#include "node.h"
+
+using namespace std;
+
+// Number of locks shared by the buckets of the hash index
+#define HASH_INDEX_LOCKS 1024
+
+/**
+    Concurrent hash table from key to node, alongside the towers of the skip list.
+    The buckets are chains through Node::hash_next. Writers lock one of HASH_INDEX_LOCKS stripes, readers follow
+    the chains without locks. An unlinked node keeps its hash_next, so a reader standing on it can go on.
+    The skip list retires the node once it left both its towers and its chain, and node_reclaimer frees it after
+    every reader which may have reached it through either has left.
+*/
+class HashIndex{
+    private:
+        atomic<Node*> *buckets;
+        size_t bucket_mask;
+        mutex locks[HASH_INDEX_LOCKS];
+
+        size_t bucket(int key);
+    public:
+        HashIndex(long long max_elements);
+        ~HashIndex();
+        void insert(Node *node);
+        void remove(Node *node);
+        Node* find(int key);
+};
+
+#endif
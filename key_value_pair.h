@@ -1,3 +1,6 @@
+#ifndef KEY_VALUE_PAIR_H
+#define KEY_VALUE_PAIR_H
+
 using namespace std;
 
 #include <string>
@@ -12,4 +15,6 @@ class KeyValuePair{
         ~KeyValuePair();
         int get_key();
         string get_value();
-};
\ No newline at end of file
+};
+
+#endif
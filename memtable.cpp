@@ -0,0 +1,230 @@
+/**
+    Implements the LSM memtable on top of the concurrent skip list
+*/
+
+#include <iostream>
+#include <stdio.h>
+#include <chrono>
+#include "memtable.h"
+#include "bloom_filter.h"
+
+/**
+    Default options: flush every 4 MB into the current directory
+*/
+MemTableOptions::MemTableOptions(){
+    flush_bytes = 4 << 20;
+    directory = ".";
+}
+
+/**
+    The values live in a value log, so a write of a key already in the list swaps its value in place
+*/
+static SkipListOptions memtable_list_options(){
+    SkipListOptions options;
+    options.value_log = true;
+    return options;
+}
+
+MemTableList::MemTableList(int max_elements) : list(max_elements, 0.5, memtable_list_options()){
+    writers = 0;
+    frozen = false;
+    bytes = 0;
+}
+
+/**
+    The last version using the list is gone, so no thread can reach its nodes any more
+*/
+MemTableList::~MemTableList(){
+    list.destroy();
+}
+
+/**
+    Constructor, starts the flush thread
+*/
+MemTable::MemTable(MemTableOptions memtable_options){
+    options = memtable_options;
+    next_run_id = 0;
+    flush_running = true;
+
+    shared_ptr<MemTableVersion> first = make_shared<MemTableVersion>();
+    first->active = make_shared<MemTableList>(options.flush_bytes / MEMTABLE_NODE_OVERHEAD);
+    atomic_store(&version, first);
+
+    flush_thread = thread(&MemTable::flush_frozen, this);
+}
+
+shared_ptr<MemTableVersion> MemTable::current(){
+    return atomic_load(&version);
+}
+
+/**
+    Stores the tagged value of key in the active skip list, replacing the previous one in place.
+    The handle of the value is swapped under the lock of the node, so a search of the key always finds one of
+    the two values in the active list.
+*/
+bool MemTable::write(int key, const string &stored){
+    while(true){
+        shared_ptr<MemTableVersion> v = current();
+        MemTableList *active = v->active.get();
+
+        // A writer announces itself before checking frozen, and the flush thread waits for the writers of a
+        // list after setting frozen, so every write to a frozen list ends before the list is flushed
+        active->writers.fetch_add(1);
+        if(active->frozen.load()){
+            active->writers.fetch_sub(1);
+            continue;
+        }
+
+        while(!active->list.add(key, stored) && !active->list.update(key, stored)){
+        }
+        size_t bytes = active->bytes.fetch_add(stored.size() + MEMTABLE_NODE_OVERHEAD) + stored.size() + MEMTABLE_NODE_OVERHEAD;
+        active->writers.fetch_sub(1);
+
+        if(bytes >= options.flush_bytes){
+            freeze(v->active, false);
+        }
+        return true;
+    }
+}
+
+/**
+    Inserts or replaces the value of key
+*/
+bool MemTable::add(int key, string value){
+    return write(key, MEMTABLE_PUT + value);
+}
+
+/**
+    Deletes key by writing a tombstone which hides its older values
+*/
+bool MemTable::remove(int key){
+    return write(key, string(1, MEMTABLE_DELETE));
+}
+
+/**
+    Returns the value of key, or empty if the key does not exist or was deleted
+*/
+string MemTable::search(int key){
+    shared_ptr<MemTableVersion> v = current();
+
+    string stored = v->active->list.search(key);
+    for (size_t i = 0; stored == "" && i < v->frozen.size(); i++){
+        stored = v->frozen[i]->list.search(key);
+    }
+    for (size_t i = 0; stored == "" && i < v->runs.size(); i++){
+        v->runs[i]->reader.get(key, stored);
+    }
+
+    if(stored == "" || stored[0] == MEMTABLE_DELETE){
+        return "";
+    }
+    return stored.substr(1);
+}
+
+/**
+    Replaces the active list with a new one and hands it to the flush thread.
+    Writers do not wait: if another thread is changing the version, the next write tries again.
+*/
+void MemTable::freeze(const shared_ptr<MemTableList> &list, bool wait){
+    unique_lock<mutex> guard(version_mutex, defer_lock);
+    if(wait){
+        guard.lock();
+    }else if(!guard.try_lock()){
+        return;
+    }
+
+    shared_ptr<MemTableVersion> v = current();
+    if(v->active != list){
+        return;
+    }
+
+    shared_ptr<MemTableVersion> next = make_shared<MemTableVersion>(*v);
+    next->active = make_shared<MemTableList>(options.flush_bytes / MEMTABLE_NODE_OVERHEAD);
+    next->frozen.insert(next->frozen.begin(), list);
+
+    // Frozen before the version is published, so the flush thread never sees the list before a writer would
+    list->frozen.store(true);
+    atomic_store(&version, next);
+    guard.unlock();
+
+    lock_guard<mutex> flush_guard(flush_mutex);
+    flush_condition.notify_one();
+}
+
+/**
+    Flush thread: writes the oldest frozen list to a run file and replaces the list with the run.
+    Stops once it is asked to and no frozen list is left.
+*/
+void MemTable::flush_frozen(){
+    unique_lock<mutex> guard(flush_mutex);
+    while(true){
+        shared_ptr<MemTableVersion> v = current();
+        if(v->frozen.empty()){
+            if(!flush_running){
+                return;
+            }
+            flush_condition.wait(guard);
+            continue;
+        }
+        guard.unlock();
+
+        shared_ptr<MemTableList> list = v->frozen.back();
+        while(list->writers.load() != 0){
+            this_thread::yield();
+        }
+
+        shared_ptr<SortedRun> run = make_shared<SortedRun>();
+        run->path = options.directory + "/run_" + to_string(next_run_id) + ".sst";
+        if(list->list.save(run->path, BLOOM_BITS_PER_KEY) && run->reader.open(run->path)){
+            next_run_id++;
+            lock_guard<mutex> version_guard(version_mutex);
+            shared_ptr<MemTableVersion> next = make_shared<MemTableVersion>(*current());
+            next->frozen.pop_back();
+            next->runs.insert(next->runs.begin(), run);
+            atomic_store(&version, next);
+        }else{
+            // The list stays frozen and searchable, try again later
+            cerr << "memtable: could not write " << run->path << '\n';
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+
+        guard.lock();
+        flushed_condition.notify_all();
+    }
+}
+
+/**
+    Freezes the active list and waits until every frozen list is written to a run file
+*/
+void MemTable::flush(){
+    shared_ptr<MemTableVersion> v = current();
+    if(v->active->bytes.load() > 0){
+        freeze(v->active, true);
+    }
+
+    unique_lock<mutex> guard(flush_mutex);
+    while(!current()->frozen.empty()){
+        flushed_condition.wait(guard);
+    }
+}
+
+size_t MemTable::frozen_count(){
+    return current()->frozen.size();
+}
+
+size_t MemTable::run_count(){
+    return current()->runs.size();
+}
+
+/**
+    Flushes the active list, so every write is in a run file, and stops the flush thread
+*/
+MemTable::~MemTable(){
+    flush();
+    {
+        lock_guard<mutex> guard(flush_mutex);
+        flush_running = false;
+    }
+    flush_condition.notify_one();
+    flush_thread.join();
+}
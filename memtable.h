@@ -0,0 +1,109 @@
+#ifndef MEMTABLE_H
+#define MEMTABLE_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "skip_list.h"
+#include "snapshot.h"
+
+using namespace std;
+
+// Estimated bytes of a node besides its value, used to decide when the active skip list is full
+#define MEMTABLE_NODE_OVERHEAD 64
+
+// First byte of every value stored in the skip lists and run files: a value, or a delete (tombstone)
+#define MEMTABLE_PUT 'p'
+#define MEMTABLE_DELETE 'd'
+
+/**
+    Options of a memtable
+*/
+struct MemTableOptions{
+    // Size in bytes after which the active skip list is frozen and flushed
+    size_t flush_bytes;
+
+    // Directory of the sorted run files
+    string directory;
+
+    MemTableOptions();
+};
+
+/**
+    A skip list of the memtable with the number of writers still adding to it
+*/
+struct MemTableList{
+    SkipList list;
+    atomic<int> writers;
+    atomic<bool> frozen;
+    atomic<size_t> bytes;
+
+    MemTableList(int max_elements);
+    ~MemTableList();
+};
+
+/**
+    A sorted run file, mapped into memory
+*/
+struct SortedRun{
+    string path;
+    SnapshotReader reader;
+};
+
+/**
+    The lists and runs of the memtable at one point in time. A version is never changed once published, the
+    memtable publishes a new one instead, so readers use the version they loaded without any lock.
+*/
+struct MemTableVersion{
+    shared_ptr<MemTableList> active;
+
+    // Newest first
+    vector<shared_ptr<MemTableList>> frozen;
+    vector<shared_ptr<SortedRun>> runs;
+};
+
+/**
+    LSM memtable on top of the skip list.
+    Writes go to the active skip list. Once it holds flush_bytes, it is frozen and a new active list takes over.
+    A background thread writes the frozen lists, oldest first, to sorted run files with a sparse index and a
+    bloom filter, and releases them. A search checks the active list, the frozen lists and then the runs,
+    newest first, and stops at the first value or delete of the key.
+*/
+class MemTable{
+    private:
+        MemTableOptions options;
+
+        // Current version, loaded and replaced with the atomic operations of shared_ptr
+        shared_ptr<MemTableVersion> version;
+
+        // Serialises the changes of the version
+        mutex version_mutex;
+
+        // Flush thread, woken up when a list is frozen
+        thread flush_thread;
+        mutex flush_mutex;
+        condition_variable flush_condition;
+        condition_variable flushed_condition;
+        bool flush_running;
+        unsigned long long next_run_id;
+
+        shared_ptr<MemTableVersion> current();
+        bool write(int key, const string &stored);
+        void freeze(const shared_ptr<MemTableList> &list, bool wait);
+        void flush_frozen();
+    public:
+        MemTable(MemTableOptions options);
+        ~MemTable();
+        bool add(int key, string value);
+        bool remove(int key);
+        string search(int key);
+        void flush();
+        size_t frozen_count();
+        size_t run_count();
+};
+
+#endif
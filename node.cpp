@@ -3,6 +3,10 @@
 */
 
 #include "node.h"
+#include "coarse_clock.h"
+
+// Failed attempts to take the lock of a node before the thread yields
+#define NODE_LOCK_SPINS 64
 
 
 /**
@@ -10,24 +14,29 @@
 */
 
 Node::Node(){
+    next = NULL;
+    span = NULL;
+    top_level = -1;
 }
 
 Node::Node(int key, int level){
     key_value_pair = KeyValuePair(key, "");
-    next.resize(level + 1);
-    for (size_t i = 0; i < next.size(); i++){
-        next[i] = NULL;
+    next = new atomic<Node*>[level + 1];
+    for (int i = 0; i <= level; i++){
+        next[i].store(NULL, memory_order_relaxed);
     }
     top_level = level;
+    span = NULL;
 }
 
 Node::Node(int key, string value, int level){
     key_value_pair = KeyValuePair(key, value);
-    next.resize(level + 1);
-    for (size_t i = 0; i < next.size(); i++){
-        next[i] = NULL;
+    next = new atomic<Node*>[level + 1];
+    for (int i = 0; i <= level; i++){
+        next[i].store(NULL, memory_order_relaxed);
     }
     top_level = level;
+    span = NULL;
 }
 
 /**
@@ -37,6 +46,14 @@ int Node::get_key(){
     return key_value_pair.get_key();
 }
 
+/**
+    Returns true if the node is ordered before the given key and sequence: by key, then by sequence
+*/
+bool Node::is_before(int key, uint64_t sequence){
+    int node_key = key_value_pair.get_key();
+    return node_key < key || (node_key == key && this->sequence < sequence);
+}
+
 /**
     Returns the value in the node
 */
@@ -45,18 +62,238 @@ string Node::get_value(){
 }
 
 /**
-    Locks the node
+    Returns the next node at the given level.
+    Acquire pairs with the release in set_next so the fields of the returned node are visible.
+*/
+Node* Node::get_next(int level){
+    return next[level].load(memory_order_acquire);
+}
+
+/**
+    Links the next node at the given level and publishes it to lock free readers
+*/
+void Node::set_next(int level, Node* node){
+    next[level].store(node, memory_order_release);
+}
+
+/**
+    Returns the previous node at level 0. Acquire pairs with the release in set_prev.
+*/
+Node* Node::get_prev(){
+    return prev.load(memory_order_acquire);
+}
+
+/**
+    Sets the previous node at level 0
+*/
+void Node::set_prev(Node* node){
+    prev.store(node, memory_order_release);
+}
+
+/**
+    Returns true if the node is being deleted
+*/
+bool Node::is_marked(){
+    return (state.load(memory_order_acquire) & NODE_MARKED) != 0;
+}
+
+/**
+    Marks the node as being deleted. Called with the lock of the node held.
+*/
+void Node::set_marked(){
+    state.fetch_or(NODE_MARKED, memory_order_release);
+}
+
+/**
+    Returns true if the node is linked at every level until its top level
+*/
+bool Node::is_fully_linked(){
+    return (state.load(memory_order_acquire) & NODE_FULLY_LINKED) != 0;
+}
+
+/**
+    Marks the node as linked at every level until its top level.
+    An atomic or, since another thread may hold the lock of the node by now.
+*/
+void Node::set_fully_linked(){
+    state.fetch_or(NODE_FULLY_LINKED, memory_order_release);
+}
+
+int Node::get_linked_level(){
+    return linked_level.load(memory_order_acquire);
+}
+
+void Node::set_linked_level(int level){
+    linked_level.store(level, memory_order_release);
+}
+
+/**
+    Returns true if the node has an expiry time and it has passed. Nodes without one never read the clock.
+*/
+bool Node::is_expired(){
+    return expiry_ms != 0 && expiry_ms <= coarse_now_ms();
+}
+
+/**
+    Sets the reference bit. Only writes if it is not set yet, so lookups of a hot node do not keep
+    invalidating its cache line in the other cores.
+*/
+void Node::set_referenced(){
+    if(!referenced.load(memory_order_relaxed)){
+        referenced.store(true, memory_order_relaxed);
+    }
+}
+
+/**
+    Clears the reference bit and returns whether it was set
+*/
+bool Node::clear_referenced(){
+    if(referenced.load(memory_order_relaxed)){
+        referenced.store(false, memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+/**
+    Allocates the span of every level of the node, used by indexable skip lists
+*/
+void Node::init_spans(){
+    span = new atomic<long long>[top_level + 1];
+    for (int i = 0; i <= top_level; i++){
+        span[i].store(0, memory_order_relaxed);
+    }
+}
+
+/**
+    Returns the number of level 0 nodes between this node and its next node at the given level
+*/
+long long Node::get_span(int level){
+    return span[level].load(memory_order_relaxed);
+}
+
+/**
+    Sets the span at the given level. Called with the lock of the node held or on a node not yet reachable.
+*/
+void Node::set_span(int level, long long width){
+    span[level].store(width, memory_order_relaxed);
+}
+
+/**
+    Adjusts the span at the given level for a node inserted or deleted below a link which is not locked
+*/
+void Node::add_span(int level, long long delta){
+    span[level].fetch_add(delta, memory_order_relaxed);
+}
+
+/**
+    Allocates the aggregate of every level of the node, used by skip lists with an aggregate.
+    The node starts stale, so its aggregates are computed the first time they are read.
+*/
+void Node::init_aggregates(double identity){
+    aggregate = new atomic<double>[top_level + 1];
+    for (int i = 0; i <= top_level; i++){
+        aggregate[i].store(identity, memory_order_relaxed);
+    }
+    aggregate_stale.store(1, memory_order_relaxed);
+}
+
+/**
+    Returns the aggregate of the nodes skipped by the link at the given level, the next node included
+*/
+double Node::get_aggregate(int level){
+    return aggregate[level].load(memory_order_relaxed);
+}
+
+/**
+    Sets the aggregate at the given level. Called by the repair of the aggregates only.
+*/
+void Node::set_aggregate(int level, double total){
+    aggregate[level].store(total, memory_order_relaxed);
+}
+
+/**
+    Flags the aggregates of the node for repair, after a writer changed the nodes below one of its links
+*/
+void Node::mark_aggregate_stale(){
+    aggregate_stale.fetch_add(1);
+}
+
+/**
+    Returns the number of bytes used by the node, its tower and its value
+*/
+size_t Node::memory_usage(){
+    size_t spans = span != NULL ? (top_level + 1) * sizeof(atomic<long long>) : 0;
+    size_t aggregates = aggregate != NULL ? (top_level + 1) * sizeof(atomic<double>) : 0;
+    return sizeof(Node) + (top_level + 1) * sizeof(atomic<Node*>) + spans + aggregates + key_value_pair.get_value().size();
+}
+
+/**
+    Returns the version of the node, to be read before the links it protects.
+    Acquire orders the loads of the links after it.
+*/
+uint64_t Node::get_version(){
+    return state.load(memory_order_acquire);
+}
+
+/**
+    Returns true if the node is not marked and still links to succ at the given level. Called with the lock of
+    the node held, by a writer which read version before the link.
+    An unchanged version is enough. The version covers every level of the node though, so if it changed the link
+    itself is compared. The fully linked flag is left out, it is set without the lock.
+*/
+bool Node::validate(uint64_t version, int level, Node *succ){
+    uint64_t ignored = NODE_LOCKED | NODE_FULLY_LINKED;
+    uint64_t current = state.load(memory_order_relaxed);
+    if((current & NODE_MARKED) != 0){
+        return false;
+    }
+    return (current & ~ignored) == (version & ~ignored) || get_next(level) == succ;
+}
+
+/**
+    Locks the node. Spins on the state word, and yields the CPU after a while so that a preempted holder can run.
 */
 void Node::lock(){
-    node_lock.lock();
+    int spins = 0;
+    while(true){
+        uint64_t current = state.load(memory_order_relaxed);
+        if((current & NODE_LOCKED) == 0 && state.compare_exchange_weak(current, current | NODE_LOCKED, memory_order_acquire, memory_order_relaxed)){
+            return;
+        }
+        if(++spins >= NODE_LOCK_SPINS){
+            spins = 0;
+            this_thread::yield();
+        }
+    }
 }
 
 /**
-    Unlocks the node
+    Locks the node if it is free. Returns false without waiting otherwise.
+*/
+bool Node::try_lock(){
+    uint64_t current = state.load(memory_order_relaxed);
+    return (current & NODE_LOCKED) == 0 && state.compare_exchange_strong(current, current | NODE_LOCKED, memory_order_acquire, memory_order_relaxed);
+}
+
+/**
+    Unlocks the node and moves it to a new version. The lock bit is set, so one addition clears it and
+    increments the version.
 */
 void Node::unlock(){
-    node_lock.unlock();
+    state.fetch_add(NODE_VERSION_UNIT - NODE_LOCKED, memory_order_release);
+}
+
+/**
+    Unlocks a node which was not changed while locked, keeping its version, so that writers which read the
+    version before do not have to try again
+*/
+void Node::unlock_unchanged(){
+    state.fetch_sub(NODE_LOCKED, memory_order_release);
 }
 
 Node::~Node(){
+    delete[] next;
+    delete[] span;
+    delete[] aggregate;
 }
\ No newline at end of file
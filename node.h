@@ -1,35 +1,115 @@
+#ifndef NODE_H
+#define NODE_H
+
 #include <vector>
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <stdint.h>
 #include "key_value_pair.h"
 
+// Bits of the state word of a node. The version is kept in the bits above them and grows by NODE_VERSION_UNIT
+// every time a writer unlocks a node it changed.
+#define NODE_LOCKED 1ULL
+#define NODE_MARKED 2ULL
+#define NODE_FULLY_LINKED 4ULL
+#define NODE_VERSION_UNIT 8ULL
+
 class Node{
     public:
         // Stores the key and value for the Node
         KeyValuePair key_value_pair;
 
-        // Stores the reference of the next node until the top level for the node
-        vector<Node*> next;
+        // Stores the reference of the next node until the top level for the node.
+        // Readers load with acquire and writers publish with release, so lock free traversals never race with linking.
+        atomic<Node*> *next;
 
-        // Lock to lock the node when modifing it
-        mutex node_lock;
+        // Previous node at level 0, for descending walks. Written by the writer which links or unlinks the node
+        // before it, under the lock of that node, so it may lag behind level 0 while a writer is at work.
+        atomic<Node*> prev = {NULL};
 
-        // Atomic variable to be marked if this Node is being deleted
-        atomic<bool> marked = {false};
+        // Lock of the node, the marked flag (set when the node is being deleted), the fully linked flag (set once
+        // the node is linked to its predecessors and successors) and the version of the node, in one word.
+        // The lock is taken with a single compare and swap. A writer which read the version before reading a link
+        // knows the link and the mark are unchanged if the version is the same once it holds the lock.
+        atomic<uint64_t> state = {0};
 
-        // Atomic variable to indicate the Node is completely linked to predecessors and successors
-        atomic<bool> fully_linked = {false};
+        // Handle of the value in the value log of the skip list, 0 if the value is stored in key_value_pair
+        atomic<uint64_t> value_handle = {0};
+
+        // Order of the node among the nodes of the same key in a multimap, 0 in a skip list of unique keys.
+        // Set before the node is linked.
+        uint64_t sequence = 0;
 
         // The Maximum level until which the node is available
         int top_level; 
 
+        // Highest level the node is linked at. Equal to top_level once fully linked, except with a lazy index where
+        // the index maintenance raises it level by level. Changed only while the node is locked.
+        atomic<int> linked_level = {-1};
+
+        // Next node waiting for the maintenance of a lazy index to link its upper levels, or to unlink it once marked
+        Node *index_next = NULL;
+
+        // Set while the node waits for the maintenance of a lazy index, so that it is pushed only once.
+        // Changed only while the node is locked, or before it is linked.
+        bool index_pending = false;
+
+        // Number of level 0 nodes skipped by the link at each level. Only allocated when the skip list is indexable.
+        atomic<long long> *span;
+
+        // Aggregate of the values of the nodes after this one up to and including its next node, at each level.
+        // Only allocated when the skip list has an aggregate, and only valid while aggregate_stale is 0.
+        atomic<double> *aggregate = NULL;
+
+        // Number of times writers changed the links below the aggregates of the node since they were computed
+        atomic<unsigned int> aggregate_stale = {0};
+
+        // Next node in the same bucket of the hash index, if the skip list has one
+        atomic<Node*> hash_next = {NULL};
+
+        // Time of the coarse clock at which the node expires, 0 if it never expires. Set before the node is linked.
+        long long expiry_ms = 0;
+
+        // Reference bit of the CLOCK eviction of a bounded skip list, set by lookups and cleared by the clock hand.
+        // Relaxed, since a lost update only makes the eviction a little less accurate.
+        atomic<bool> referenced = {false};
+
         Node();
         Node(int key, int level);
         Node(int key, string value, int level);
         ~Node();
         int get_key();
+        bool is_before(int key, uint64_t sequence);
         string get_value();
+        Node* get_next(int level);
+        void set_next(int level, Node* node);
+        Node* get_prev();
+        void set_prev(Node* node);
+        bool is_marked();
+        void set_marked();
+        bool is_fully_linked();
+        void set_fully_linked();
+        bool is_expired();
+        int get_linked_level();
+        void set_linked_level(int level);
+        void set_referenced();
+        bool clear_referenced();
+        void init_spans();
+        long long get_span(int level);
+        void set_span(int level, long long width);
+        void add_span(int level, long long delta);
+        void init_aggregates(double identity);
+        double get_aggregate(int level);
+        void set_aggregate(int level, double total);
+        void mark_aggregate_stale();
+        size_t memory_usage();
+        uint64_t get_version();
+        bool validate(uint64_t version, int level, Node *succ);
         void lock();
+        bool try_lock();
         void unlock();
-};
\ No newline at end of file
+        void unlock_unchanged();
+};
+
+#endif
@@ -0,0 +1,614 @@
+/**
+    Implements the Concurrent Skip list in a POSIX shared memory region, shared by several processes.
+
+    The region starts with a header and nodes are allocated after it by bumping an offset, so a node is never
+    freed and a process which reached it may always read it. Links are offsets from the start of the region.
+    add and remove are the lazy locking algorithm of SkipList: the predecessors are locked and validated, a new
+    node is linked from level 0 up and is visible once fully linked, a deleted node is marked and unlinked from
+    its top level down. search never locks.
+
+    Node locks are robust mutexes shared between processes. When a process dies holding one, the next process
+    locking it owns it and learns that the owner died. The operation of the dead process may have stopped
+    halfway: a node linked at its lower levels but not fully linked, or a marked node still linked. recover walks
+    level 0, finishes linking the first kind, and finishes unlinking the second. It only tries the locks it needs,
+    so it never waits on a process which is alive and may be called while holding a lock. What it could not
+    repair is left for its next run. A process is dead once it was reaped, its pid must not have been reused.
+*/
+
+#include <iostream>
+#include <math.h>
+#include <limits>
+#include <thread>
+#include <random>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shared_skip_list.h"
+
+#define INT_MINI numeric_limits<int>::min()
+#define INT_MAXI numeric_limits<int>::max()
+
+/**
+    Initializes a mutex which is robust and shared between the processes mapping it
+*/
+static void init_shared_mutex(pthread_mutex_t *mutex){
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+}
+
+/**
+    Returns true if the process does not exist any more
+*/
+static bool process_dead(pid_t pid){
+    return pid != 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+SharedSkipList::SharedSkipList(){
+    base = NULL;
+    header = NULL;
+}
+
+SharedSkipList::~SharedSkipList(){
+}
+
+/**
+    Returns the node at offset in the region of this process
+*/
+SharedNode* SharedSkipList::node(uint64_t offset){
+    return (SharedNode*) (base + offset);
+}
+
+uint64_t SharedSkipList::offset_of(SharedNode *node){
+    return (char*) node - base;
+}
+
+/**
+    Returns the bytes of the value of a node, after its links
+*/
+char* SharedSkipList::value_of(SharedNode *node){
+    return (char*) &node->next[node->top_level + 1];
+}
+
+/**
+    Allocates bytes in the region.
+    Returns their offset, or 0 if the region is full.
+*/
+uint64_t SharedSkipList::allocate(uint64_t bytes){
+    bytes = (bytes + 7) & ~(uint64_t) 7;
+    uint64_t offset = header->used.fetch_add(bytes);
+    if(offset + bytes > header->size){
+        return 0;
+    }
+    return offset;
+}
+
+/**
+    Locks a node. If the process holding the lock died, takes it over and asks for a recovery.
+*/
+void SharedSkipList::lock(SharedNode *node){
+    if(pthread_mutex_lock(&node->node_lock) == EOWNERDEAD){
+        pthread_mutex_consistent(&node->node_lock);
+        header->recovery_needed = true;
+    }
+}
+
+/**
+    Locks a node if it is free or its holder died
+*/
+bool SharedSkipList::try_lock(SharedNode *node){
+    int result = pthread_mutex_trylock(&node->node_lock);
+    if(result == EOWNERDEAD){
+        pthread_mutex_consistent(&node->node_lock);
+        return true;
+    }
+    return result == 0;
+}
+
+void SharedSkipList::unlock(SharedNode *node){
+    pthread_mutex_unlock(&node->node_lock);
+}
+
+/**
+    Maps size bytes of the shared memory object fd
+*/
+bool SharedSkipList::map_region(int fd, uint64_t size){
+    void *address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(address == MAP_FAILED){
+        return false;
+    }
+    base = (char*) address;
+    header = (SharedHeader*) address;
+    return true;
+}
+
+/**
+    Creates the shared memory region name of bytes bytes with an empty skip list, sized for max_elements.
+    Returns false if the region already exists or cannot be created.
+*/
+bool SharedSkipList::create(const string &name, uint64_t bytes, int max_elements, float probability){
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0){
+        return false;
+    }
+    if(ftruncate(fd, bytes) != 0 || !map_region(fd, bytes)){
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    header->size = bytes;
+    header->used = sizeof(SharedHeader);
+    header->max_level = (int) round(log(max_elements) / log(1/probability)) - 1;
+    header->probability = probability;
+    header->recovery_needed = false;
+    init_shared_mutex(&header->recovery_lock);
+
+    // The sentinels are at every level
+    uint64_t sentinels[2];
+    int keys[2] = {INT_MINI, INT_MAXI};
+    for (int i = 0; i < 2; i++){
+        sentinels[i] = allocate(sizeof(SharedNode) + header->max_level * sizeof(uint64_t));
+        SharedNode *sentinel = node(sentinels[i]);
+        sentinel->key = keys[i];
+        sentinel->top_level = header->max_level;
+        sentinel->value_length = 0;
+        sentinel->inserter = 0;
+        sentinel->remover = 0;
+        sentinel->marked = false;
+        sentinel->fully_linked = true;
+        init_shared_mutex(&sentinel->node_lock);
+    }
+    for (int level = 0; level <= header->max_level; level++){
+        node(sentinels[0])->next[level] = sentinels[1];
+        node(sentinels[1])->next[level] = 0;
+    }
+    header->head = sentinels[0];
+    header->tail = sentinels[1];
+
+    header->magic.store(SHARED_SKIP_LIST_MAGIC, memory_order_release);
+    return true;
+}
+
+/**
+    Maps the region name created by another process.
+    Returns false if it does not exist or does not hold a skip list.
+*/
+bool SharedSkipList::open(const string &name){
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if(fd < 0){
+        return false;
+    }
+    struct stat status;
+    if(fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(SharedHeader)){
+        ::close(fd);
+        return false;
+    }
+    if(!map_region(fd, status.st_size)){
+        return false;
+    }
+    if(header->magic.load(memory_order_acquire) != SHARED_SKIP_LIST_MAGIC || header->size != (uint64_t) status.st_size){
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+    Unmaps the region from this process. The skip list stays in it for the other processes.
+*/
+void SharedSkipList::close(){
+    if(base != NULL){
+        munmap(base, header->size);
+    }
+    base = NULL;
+    header = NULL;
+}
+
+/**
+    Removes the name of a region, which is freed once every process closed it
+*/
+bool SharedSkipList::remove_region(const string &name){
+    return shm_unlink(name.c_str()) == 0;
+}
+
+/**
+    Randomly generates a number and increments level if number less than or equal to the probability
+    of the skip list. Every thread of every process has its own generator.
+*/
+int SharedSkipList::get_random_level() {
+    static thread_local mt19937 generator(random_device{}() ^ getpid());
+    uniform_real_distribution<float> distribution(0, 1);
+    int l = 0;
+    while(distribution(generator) <= header->probability){
+        l++;
+    }
+    return l > header->max_level ? header->max_level : l;
+}
+
+/**
+    Finds the predecessors and successors of key at each level.
+    Returns the highest level at which key was found, or -1.
+*/
+int SharedSkipList::find(int key, vector<SharedNode*> &predecessors, vector<SharedNode*> &successors){
+    int found = -1;
+    SharedNode *prev = node(header->head);
+
+    for (int level = header->max_level; level >= 0; level--){
+        SharedNode *curr = node(prev->next[level].load(memory_order_acquire));
+        while (curr->key < key){
+            prev = curr;
+            curr = node(prev->next[level].load(memory_order_acquire));
+        }
+        if(found == -1 && curr->key == key){
+            found = level;
+        }
+        predecessors[level] = prev;
+        successors[level] = curr;
+    }
+    return found;
+}
+
+/**
+    Inserts into the Skip list.
+    Return if already exists, or if the region is full.
+*/
+bool SharedSkipList::add(int key, string value){
+    int top_level = get_random_level();
+    vector<SharedNode*> preds(header->max_level + 1);
+    vector<SharedNode*> succs(header->max_level + 1);
+
+    while(true){
+        if(header->recovery_needed){
+            recover();
+        }
+
+        int found = find(key, preds, succs);
+
+        // Wait for an insert of the key to finish, or for a delete to unlink it, repairing them if their
+        // process died
+        if(found != -1){
+            SharedNode *node_found = succs[found];
+            if(!node_found->marked){
+                while(!node_found->fully_linked){
+                    if(process_dead(node_found->inserter)){
+                        recover();
+                    }
+                    this_thread::yield();
+                }
+                return false;
+            }
+            if(process_dead(node_found->remover)){
+                recover();
+            }
+            this_thread::yield();
+            continue;
+        }
+
+        // Lock the predecessors, each node once, and check that they are unmarked and still before the successors
+        vector<SharedNode*> locked_nodes;
+        SharedNode *pred = NULL;
+        SharedNode *succ = NULL;
+        bool valid = true;
+        for (int level = 0; valid && level <= top_level; level++){
+            pred = preds[level];
+            succ = succs[level];
+            if(locked_nodes.empty() || locked_nodes.back() != pred){
+                lock(pred);
+                locked_nodes.push_back(pred);
+            }
+            valid = !pred->marked && !succ->marked && pred->next[level].load(memory_order_acquire) == offset_of(succ);
+        }
+
+        if(!valid){
+            for (size_t i = 0; i < locked_nodes.size(); i++){
+                unlock(locked_nodes[i]);
+            }
+
+            // A marked neighbour whose process died is never unlinked without a recovery
+            if((pred->marked && process_dead(pred->remover)) || (succ->marked && process_dead(succ->remover))){
+                recover();
+            }
+            this_thread::yield();
+            continue;
+        }
+
+        uint64_t offset = allocate(sizeof(SharedNode) + top_level * sizeof(uint64_t) + value.size());
+        if(offset == 0){
+            for (size_t i = 0; i < locked_nodes.size(); i++){
+                unlock(locked_nodes[i]);
+            }
+            return false;
+        }
+
+        SharedNode *new_node = node(offset);
+        new_node->key = key;
+        new_node->top_level = top_level;
+        new_node->value_length = value.size();
+        new_node->inserter = getpid();
+        new_node->remover = 0;
+        new_node->marked = false;
+        new_node->fully_linked = false;
+        init_shared_mutex(&new_node->node_lock);
+        memcpy(value_of(new_node), value.data(), value.size());
+        for (int level = 0; level <= top_level; level++){
+            new_node->next[level].store(offset_of(succs[level]), memory_order_relaxed);
+        }
+
+        // Linked from level 0 up, so a node linked at a level is linked at every level below
+        for (int level = 0; level <= top_level; level++){
+            preds[level]->next[level].store(offset, memory_order_release);
+        }
+        new_node->fully_linked = true;
+
+        for (size_t i = 0; i < locked_nodes.size(); i++){
+            unlock(locked_nodes[i]);
+        }
+        return true;
+    }
+}
+
+/**
+    Searches for the key without locking.
+    Returns the value, or empty if the key is not in the skip list.
+*/
+string SharedSkipList::search(int key){
+    vector<SharedNode*> preds(header->max_level + 1);
+    vector<SharedNode*> succs(header->max_level + 1);
+
+    int found = find(key, preds, succs);
+    if(found == -1){
+        return "";
+    }
+    SharedNode *curr = succs[found];
+    if(!curr->fully_linked || curr->marked){
+        return "";
+    }
+    return string(value_of(curr), curr->value_length);
+}
+
+/**
+    Deletes from the Skip list: locks and marks the node, then locks its predecessors and unlinks it.
+    Return false if the key is not in the skip list.
+*/
+bool SharedSkipList::remove(int key){
+    SharedNode *victim = NULL;
+    bool is_marked = false;
+    int top_level = -1;
+
+    vector<SharedNode*> preds(header->max_level + 1);
+    vector<SharedNode*> succs(header->max_level + 1);
+
+    while(true){
+        // Recovery only tries locks, so it is safe while the victim is locked
+        if(header->recovery_needed){
+            recover();
+        }
+
+        int found = find(key, preds, succs);
+        if(!is_marked){
+            if(found == -1){
+                return false;
+            }
+            victim = succs[found];
+            if(!victim->fully_linked && process_dead(victim->inserter)){
+                recover();
+                continue;
+            }
+            if(!victim->fully_linked || victim->top_level != found || victim->marked){
+                return false;
+            }
+
+            lock(victim);
+            if(victim->marked){
+                unlock(victim);
+                return false;
+            }
+            victim->remover = getpid();
+            victim->marked = true;
+            is_marked = true;
+            top_level = victim->top_level;
+        }
+
+        vector<SharedNode*> locked_nodes;
+        SharedNode *pred = NULL;
+        bool valid = true;
+        for (int level = 0; valid && level <= top_level; level++){
+            pred = preds[level];
+            if(locked_nodes.empty() || locked_nodes.back() != pred){
+                lock(pred);
+                locked_nodes.push_back(pred);
+            }
+            valid = !pred->marked && pred->next[level].load(memory_order_acquire) == offset_of(victim);
+        }
+
+        if(!valid){
+            for (size_t i = 0; i < locked_nodes.size(); i++){
+                unlock(locked_nodes[i]);
+            }
+
+            // A marked predecessor whose process died is never unlinked without a recovery
+            if(pred->marked && process_dead(pred->remover)){
+                recover();
+            }
+            this_thread::yield();
+            continue;
+        }
+
+        for (int level = top_level; level >= 0; level--){
+            preds[level]->next[level].store(victim->next[level].load(memory_order_relaxed), memory_order_release);
+        }
+
+        for (size_t i = 0; i < locked_nodes.size(); i++){
+            unlock(locked_nodes[i]);
+        }
+        unlock(victim);
+        return true;
+    }
+}
+
+/**
+    Returns the keys and values of the range, walking level 0 without locking
+*/
+map<int, string> SharedSkipList::range(int start_key, int end_key){
+    map<int, string> range_output;
+    if(start_key > end_key){
+        return range_output;
+    }
+
+    vector<SharedNode*> preds(header->max_level + 1);
+    vector<SharedNode*> succs(header->max_level + 1);
+    find(start_key, preds, succs);
+
+    SharedNode *curr = succs[0];
+    while(curr->key <= end_key && offset_of(curr) != header->tail){
+        if(curr->fully_linked && !curr->marked){
+            range_output[curr->key] = string(value_of(curr), curr->value_length);
+        }
+        curr = node(curr->next[0].load(memory_order_acquire));
+    }
+    return range_output;
+}
+
+/**
+    Returns the last node before key at the level
+*/
+SharedNode* SharedSkipList::level_predecessor(int key, int level){
+    SharedNode *prev = node(header->head);
+    for (int i = header->max_level; i >= level; i--){
+        SharedNode *curr = node(prev->next[i].load(memory_order_acquire));
+        while (curr->key < key){
+            prev = curr;
+            curr = node(prev->next[i].load(memory_order_acquire));
+        }
+    }
+    return prev;
+}
+
+/**
+    Links a node left halfway by a dead process at the level.
+    Returns false if its predecessor is locked by a live process or changed, to be tried again.
+*/
+bool SharedSkipList::relink(SharedNode *dead_node, int level){
+    SharedNode *pred = level_predecessor(dead_node->key, level);
+    uint64_t succ = pred->next[level].load(memory_order_acquire);
+    if(succ == offset_of(dead_node)){
+        return true;
+    }
+    if(!try_lock(pred)){
+        return false;
+    }
+    bool valid = !pred->marked && pred->next[level].load(memory_order_acquire) == succ;
+    if(valid){
+        dead_node->next[level].store(succ, memory_order_relaxed);
+        pred->next[level].store(offset_of(dead_node), memory_order_release);
+    }
+    unlock(pred);
+    return valid;
+}
+
+/**
+    Unlinks a node marked by a dead process at the level.
+    Returns false if its predecessor is locked by a live process or changed, to be tried again.
+*/
+bool SharedSkipList::unlink(SharedNode *dead_node, int level){
+    SharedNode *pred = level_predecessor(dead_node->key, level);
+    if(pred->next[level].load(memory_order_acquire) != offset_of(dead_node)){
+        return true;
+    }
+    if(!try_lock(pred)){
+        return false;
+    }
+    bool valid = !pred->marked && pred->next[level].load(memory_order_acquire) == offset_of(dead_node);
+    if(valid){
+        pred->next[level].store(dead_node->next[level].load(memory_order_relaxed), memory_order_release);
+    }
+    unlock(pred);
+    return valid;
+}
+
+/**
+    Finishes the inserts and deletes of the processes which died during them.
+    Returns the number of nodes repaired. Returns 0 at once if another recovery is running.
+*/
+long long SharedSkipList::recover(){
+    int result = pthread_mutex_trylock(&header->recovery_lock);
+    if(result == EOWNERDEAD){
+        pthread_mutex_consistent(&header->recovery_lock);
+    }else if(result != 0){
+        return 0;
+    }
+    header->recovery_needed = false;
+
+    long long repaired = 0;
+    bool pending = false;
+    SharedNode *curr = node(node(header->head)->next[0].load(memory_order_acquire));
+    while(offset_of(curr) != header->tail){
+        if(!curr->fully_linked && process_dead(curr->inserter)){
+            // Linked at level 0, so the insert happened
+            bool linked = true;
+            for (int level = 1; linked && level <= curr->top_level; level++){
+                linked = relink(curr, level);
+            }
+            if(linked){
+                curr->fully_linked = true;
+                repaired++;
+            }
+            pending |= !linked;
+        }else if(curr->marked && process_dead(curr->remover)){
+            bool unlinked = true;
+            for (int level = curr->top_level; unlinked && level >= 0; level--){
+                unlinked = unlink(curr, level);
+            }
+            repaired += unlinked;
+            pending |= !unlinked;
+        }
+        curr = node(curr->next[0].load(memory_order_acquire));
+    }
+
+    if(pending){
+        header->recovery_needed = true;
+    }
+    pthread_mutex_unlock(&header->recovery_lock);
+    return repaired;
+}
+
+/**
+    Returns the bytes of the region used by the header and the nodes
+*/
+long long SharedSkipList::memory_usage(){
+    uint64_t used = header->used.load();
+    return used > header->size ? header->size : used;
+}
+
+/**
+    Display the skip list in readable format
+*/
+void SharedSkipList::display(){
+    for (int i = 0; i <= header->max_level; i++) {
+        SharedNode *temp = node(header->head);
+        int count = 0;
+        if(node(temp->next[i].load())->key != INT_MAXI){
+            printf("Level %d  ", i);
+            while (true){
+                printf("%d -> ", temp->key);
+                count++;
+                if(offset_of(temp) == header->tail){
+                    break;
+                }
+                temp = node(temp->next[i].load());
+            }
+            cout<<endl;
+        }
+        if(count == 3) break;
+    }
+    printf("---------- Display done! ----------\n\n");
+}
@@ -0,0 +1,111 @@
+#ifndef SHARED_SKIP_LIST_H
+#define SHARED_SKIP_LIST_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// Identifies a region holding a shared skip list
+#define SHARED_SKIP_LIST_MAGIC 0x5348534b49504c53ULL
+
+/**
+    Node of a shared skip list, allocated in the shared memory region.
+    Links are offsets from the start of the region, since every process maps it at its own address.
+    The node is followed by its links at levels 1 to top_level and then by the bytes of its value.
+*/
+struct SharedNode{
+    int key;
+    int top_level;
+    uint32_t value_length;
+
+    // Process which inserted the node, and the one which marked it for deletion, to repair their operation
+    // if they die before it is done
+    pid_t inserter;
+    pid_t remover;
+
+    atomic<bool> marked;
+    atomic<bool> fully_linked;
+
+    // Robust and shared between processes, so a lock held by a process which died is handed to the next one
+    pthread_mutex_t node_lock;
+
+    // Offset of the next node at each level, 0 for none
+    atomic<uint64_t> next[1];
+};
+
+/**
+    Start of the shared memory region, followed by the nodes
+*/
+struct SharedHeader{
+    // Set last by create, so a process which opens the region sees the skip list initialized
+    atomic<uint64_t> magic;
+
+    // Bytes of the region, and bytes allocated to the header and the nodes so far
+    uint64_t size;
+    atomic<uint64_t> used;
+
+    int max_level;
+    float probability;
+
+    // Offsets of the head and tail sentinels
+    uint64_t head;
+    uint64_t tail;
+
+    // Set when a lock was taken over from a process which died, until recover has run
+    atomic<bool> recovery_needed;
+
+    // Serializes the recoveries
+    pthread_mutex_t recovery_lock;
+};
+
+/**
+    Skip list for integer keys living in a named POSIX shared memory region, so that several processes share one
+    list instead of a copy each. It runs the same lazy locking add and remove and lock free search as SkipList.
+    Nodes are allocated from the region and never freed, add fails once the region is full.
+*/
+class SharedSkipList{
+    private:
+        // Start of the mapping in this process, NULL if the skip list is not open
+        char *base;
+        SharedHeader *header;
+
+        SharedNode* node(uint64_t offset);
+        uint64_t offset_of(SharedNode *node);
+        uint64_t allocate(uint64_t bytes);
+        char* value_of(SharedNode *node);
+        void lock(SharedNode *node);
+        bool try_lock(SharedNode *node);
+        void unlock(SharedNode *node);
+        int find(int key, vector<SharedNode*> &predecessors, vector<SharedNode*> &successors);
+        SharedNode* level_predecessor(int key, int level);
+        bool relink(SharedNode *node, int level);
+        bool unlink(SharedNode *node, int level);
+        bool map_region(int fd, uint64_t size);
+    public:
+        SharedSkipList();
+        ~SharedSkipList();
+        int get_random_level();
+
+        // The region is created by one process and opened by the others, by name
+        bool create(const string &name, uint64_t bytes, int max_elements, float probability);
+        bool open(const string &name);
+        void close();
+        static bool remove_region(const string &name);
+
+        // Supported operations
+        bool add(int key, string value);
+        string search(int key);
+        bool remove(int key);
+        map<int, string> range(int start_key, int end_key);
+        long long recover();
+        long long memory_usage();
+        void display();
+};
+
+#endif
@@ -8,76 +8,333 @@
 #include <map> 
 #include <stdio.h> 
 #include <stdlib.h>
+#include <chrono>
+#include <algorithm>
 #include "skip_list.h"
+#include "coarse_clock.h"
 
 #define INT_MINI numeric_limits<int>::min() 
 #define INT_MAXI numeric_limits<int>::max()
 
-static int max_level;
+// Probability with which a new node is promoted to the next level
+static const float promotion_probability = 0.5;
+
+// Number of lookups multi_get keeps in flight at the same time
+#define MULTI_GET_GROUP 8
+
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
+/**
+    Default options: a plain skip list
+*/
+SkipListOptions::SkipListOptions(){
+    indexable = false;
+    filter_counters_per_key = 0;
+    hash_index = false;
+    cache_max_elements = 0;
+    cache_max_bytes = 0;
+    lazy_index = false;
+    multimap = false;
+    aggregate.measure = NULL;
+    aggregate.combine = NULL;
+    aggregate.identity = 0;
+    value_log = false;
+}
+
+/**
+    Marks a writer as updating spans for the duration of an insert or delete.
+    A writer which overlaps with another one flags the spans dirty.
+*/
+struct SpanWriter{
+    SpanState *spans;
+
+    SpanWriter(SpanState *s){
+        spans = s;
+        if(spans != NULL && spans->writers.fetch_add(1) > 0){
+            spans->dirty = true;
+        }
+    }
+
+    ~SpanWriter(){
+        if(spans != NULL){
+            spans->writers.fetch_sub(1);
+        }
+    }
+};
 
 /**
-    Constructor
+    Returns the reclaimer of the nodes. It is never freed, since background threads of skip lists which were
+    not destroyed may still run at exit.
 */
-SkipList::SkipList(int max_elements, float prob){
+EpochReclaimer* node_reclaimer(){
+    static EpochReclaimer *reclaimer = new EpochReclaimer();
+    return reclaimer;
+}
+
+/**
+    Frees a removed node and its kept value, called by the reclaimer
+*/
+static void free_node(void *node, void *context){
+    Node *removed = (Node*) node;
+    ValueLog::discard(removed->value_handle);
+    delete removed;
+}
+
+/**
+    Makes the record of a mutation durable once the mutation has released its locks, before it returns.
+    A commit fails only once the log failed, which stays failed, so the caller learns of it from log_failed.
+*/
+struct LogCommit{
+    WriteAheadLog *wal;
+    uint64_t lsn;
+
+    LogCommit(WriteAheadLog *w){
+        wal = w;
+        lsn = 0;
+    }
+
+    ~LogCommit(){
+        if(lsn != 0){
+            wal->commit(lsn);
+        }
+    }
+};
+
+/**
+    Constructors
+*/
+SkipList::SkipList(int max_elements, float prob) : SkipList(max_elements, prob, SkipListOptions()){
+}
+
+SkipList::SkipList(int max_elements, float prob, SkipListOptions options){
     max_level = (int) round(log(max_elements) / log(1/prob)) - 1;
     head = new Node(INT_MINI, max_level);
     tail = new Node(INT_MAXI, max_level);
+    statistics = new SkipListStatistics();
+    spans = NULL;
+    wal = NULL;
+    filter = NULL;
+    hash_index = NULL;
+    reaper = new ReaperState();
+    reaper->reaper_running = false;
+    cache = NULL;
+    index = NULL;
+    aggregates = NULL;
+    next_sequence = NULL;
+    value_log = NULL;
 
-    for (size_t i = 0; i < head->next.size(); i++) {
-        head->next[i] = tail;
+    for (int i = 0; i <= max_level; i++) {
+        head->set_next(i, tail);
+    }
+    tail->set_prev(head);
+
+    // The hash index maps a key to a single node
+    if(options.hash_index && !options.multimap){
+        hash_index = new HashIndex(max_elements);
+    }
+
+    if(options.multimap){
+        next_sequence = new atomic<uint64_t>(1);
+    }
+
+    if(options.value_log){
+        value_log = new ValueLog();
+    }
+
+    if(options.cache_max_elements > 0 || options.cache_max_bytes > 0){
+        cache = new CacheState();
+        cache->max_elements = options.cache_max_elements;
+        cache->max_bytes = options.cache_max_bytes;
+        cache->hand = INT_MINI;
+        cache->evicting = false;
+        cache->evictions = 0;
+    }
+
+    if(options.lazy_index){
+        index = new IndexState();
+        index->index_running = false;
+        for (int i = 0; i < INDEX_STRIPES; i++){
+            index->stripes[i].pending = NULL;
+            index->stripes[i].pushed = 0;
+        }
+    }
+
+    if(options.filter_counters_per_key > 0){
+        filter = new CountingBloomFilter(max_elements, options.filter_counters_per_key);
+    }
+
+    // With no elements every link of the head skips straight to the tail
+    if(options.indexable){
+        spans = new SpanState();
+        spans->writers = 0;
+        spans->dirty = false;
+        spans->repair_running = false;
+        head->init_spans();
+        for (int i = 0; i <= max_level; i++) {
+            head->set_span(i, 1);
+        }
+    }
+
+    if(options.aggregate.measure != NULL){
+        aggregates = new AggregateState();
+        aggregates->monoid = options.aggregate;
+        aggregates->dirty = 0;
+        head->init_aggregates(options.aggregate.identity);
     }
 }
 
 /**
     Finds the predecessors and successors at each level of where a given key exists or might exist.
     Updates the references in the vector using pass by reference. 
+    If ranks is given, also stores the position of the predecessor at each level (the head is at position 0).
+    If versions is given, also stores the version of the predecessor at each level, read before its link.
+    In a multimap, finds where the node of the key with the given sequence is or goes, or the first node of the
+    key if sequence is 0.
     Returns -1 if not the key does not exist.
 */
-int SkipList::find(int key, vector<Node*> &predecessors, vector<Node*> &successors) {
+int SkipList::find(int key, vector<Node*> &predecessors, vector<Node*> &successors, vector<long long> *ranks, vector<uint64_t> *versions, uint64_t sequence) {
     int found = -1;
     Node *prev = head; 
+    long long rank = 0;
+    uint64_t version = 0;
+
+    // Number of nodes visited, recorded in the statistics
+    long long path_length = 0;
 
     for (int level = max_level; level >= 0; level--){
-        Node *curr = prev->next[level];
+        if(versions != NULL){
+            version = prev->get_version();
+        }
+        Node *curr = prev->get_next(level);
+        path_length++;
 
-        while (key > curr->get_key()){
+        while (curr->is_before(key, sequence)){
+            if(ranks != NULL){
+                rank += prev->get_span(level);
+            }
             prev = curr;
-            curr = prev->next[level];
+            if(versions != NULL){
+                version = prev->get_version();
+            }
+            curr = prev->get_next(level);
+            path_length++;
         }
         
-        if(found == -1 && key == curr->get_key()){
+        if(found == -1 && key == curr->get_key() && (sequence == 0 || sequence == curr->sequence)){
             found = level;
         }
 
         predecessors[level] = prev;
         successors[level] = curr;
+        if(ranks != NULL){
+            (*ranks)[level] = rank;
+        }
+        if(versions != NULL){
+            (*versions)[level] = version;
+        }
     }
+
+    statistics->record_search(path_length);
     return found;
 }
 
 /**
-    Randomly generates a number and increments level if number less than or equal to 0.5
-    Once more than 0.5, returns the level or available max level.
+    Returns the first node at level 0 whose key is greater than or equal to key, without recording a search
+*/
+Node* SkipList::seek(int key){
+    Node *curr = head;
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next->get_key() < key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+    return curr->get_next(0);
+}
+
+/**
+    Adds a node to the filter and the hash index. Called before the node is linked, so a lookup through them
+    never misses a key which is in the skip list.
+*/
+void SkipList::attach_node(Node *node){
+    if(filter != NULL){
+        filter->add(node->get_key());
+    }
+    if(hash_index != NULL){
+        hash_index->insert(node);
+    }
+}
+
+/**
+    Removes a node from the statistics, the filter and the hash index once it is unlinked from every level
+*/
+void SkipList::detach_node(Node *node){
+    statistics->record_remove(node->top_level, node->memory_usage());
+    if(filter != NULL){
+        filter->remove(node->get_key());
+    }
+    if(hash_index != NULL){
+        hash_index->remove(node);
+    }
+
+    // Readers which reached the node before it was unlinked may still read its value
+    if(value_log != NULL){
+        value_log->keep(node->value_handle);
+    }
+}
+
+/**
+    Frees a node once no reader may still stand on it. Called once, by the writer which unlinked the node from
+    every level after detach_node removed it from the hash index.
+*/
+void SkipList::retire_node(Node *node){
+    node_reclaimer()->retire(node, free_node);
+}
+
+/**
+    Randomly generates a number and increments level if number less than or equal to promotion_probability
+    Once more than promotion_probability, returns the level or available max level.
     This decides until which level a new Node is available.
 */
 int SkipList::get_random_level() {
     int l = 0;
-    while(static_cast <float> (rand()) / static_cast <float> (RAND_MAX) <= 0.5){
+    while(static_cast <float> (rand()) / static_cast <float> (RAND_MAX) <= promotion_probability){
         l++;
     }
     return l > max_level ? max_level : l;
 }
 
 
+/**
+    Inserts into the Skip list. If ttl_ms is not 0, the key expires after ttl_ms milliseconds.
+*/
+bool SkipList::add(int key, string value, long long ttl_ms) {
+    return add_until(key, value, ttl_ms > 0 ? coarse_now_ms() + ttl_ms : 0);
+}
+
 /**
     Inserts into the Skip list at the appropriate place using locks.
-    Return if already exists.
+    The key expires at expiry_ms on the coarse clock, or never if it is 0.
+    Return if already exists. An expired node of the key is deleted and the key inserted again.
+    A multimap appends the value after the other values of the key instead.
 */
-bool SkipList::add(int key, string value) {
+bool SkipList::add_until(int key, string value, long long expiry_ms) {
+    EpochGuard epoch_guard(node_reclaimer());
 
     // Get the level until which the new node must be available
     int top_level = get_random_level();
 
+    // In a multimap, the new node goes after every node of the key with a smaller sequence, so never finds itself
+    uint64_t sequence = next_sequence != NULL ? next_sequence->fetch_add(1) : 0;
+
+    // With a lazy index, only level 0 is linked now and the maintenance links the others later
+    int link_level = index != NULL ? 0 : top_level;
+
     // Initialization of references of the predecessors and successors
     vector<Node*> preds(max_level + 1); 
     vector<Node*> succs(max_level + 1);
@@ -87,12 +344,20 @@ bool SkipList::add(int key, string value) {
         succs[i] = NULL;
     }
 
+    // Versions of the predecessors when their links were read
+    vector<uint64_t> versions(max_level + 1);
+
+    // Positions of the predecessors, used to split the spans in an indexable skip list
+    vector<long long> ranks(spans != NULL ? max_level + 1 : 0);
+    SpanWriter span_writer(spans);
+    LogCommit log_commit(wal);
+
     // Keep trying to insert the element into the list. In case predecessors and successors are changed,
     // this loop helps to try the insert again
     while(true){
         
         // Find the predecessors and successors of where the key must be inserted
-        int found = find(key, preds, succs);
+        int found = find(key, preds, succs, spans != NULL ? &ranks : NULL, &versions, sequence);
 
         // If found and marked, wait and continue insert
         // If found and unmarked, wait until it is fully_linked and return. No insert needed
@@ -100,11 +365,28 @@ bool SkipList::add(int key, string value) {
         if(found != -1){
             Node* node_found = succs[found];
             
-            if(!node_found->marked){
-                while(! node_found->fully_linked){
+            if(!node_found->is_marked()){
+                if(! node_found->is_fully_linked()){
+                    auto wait_start = chrono::steady_clock::now();
+                    while(! node_found->is_fully_linked()){
+                    }
+                    statistics->record_fully_linked_wait(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - wait_start).count());
+                }
+                if(node_found->is_expired()){
+                    remove_node(key, node_found);
+                    statistics->record_insert_retry();
+                    continue;
                 }
                 return false;
             }
+
+            // The delete of the marked node has to finish first. With a lazy index nobody else may be at it.
+            if(index != NULL){
+                unlink_node(node_found);
+            }else{
+                this_thread::yield();
+            }
+            statistics->record_insert_retry();
             continue;
         }
 
@@ -121,7 +403,7 @@ bool SkipList::add(int key, string value) {
             // Used to check if the predecessor and successors are same from when we tried to read them before
             bool valid = true;
 
-            for (int level = 0; valid && (level <= top_level); level++){
+            for (int level = 0; valid && (level <= link_level); level++){
                 pred = preds[level];
                 succ = succs[level];
 
@@ -131,37 +413,100 @@ bool SkipList::add(int key, string value) {
                     locked_nodes.insert(make_pair(pred, 1));
                 }
 
-                // If predecessor marked or if the predecessor and successors change, then abort and try again
-                valid = !(pred->marked.load(std::memory_order_seq_cst)) && !(succ->marked.load(std::memory_order_seq_cst)) && pred->next[level]==succ;                
+                // If predecessor marked or if the predecessor and successors change, then abort and try again.
+                // The lock of the predecessor orders these loads, no full fence is needed.
+                valid = can_link(pred, level, versions[level], succ);
             }
 
             // Conditons are not met, release locks, abort and try again.
             if(!valid){
                 for (auto const& x : locked_nodes){
-                    x.first->unlock();
+                    x.first->unlock_unchanged();
                 }
+
+                // Node locks spin instead of sleeping, so a delete waiting for these locks only gets them if
+                // the insert stands back until the marked node is unlinked
+                if(pred->is_marked() || succ->is_marked()){
+                    this_thread::yield();
+                }
+                statistics->record_insert_retry();
                 continue;
             }
 
+            // Logged while the predecessors are locked, so the log has the mutations of a key in order
+            if(wal != NULL){
+                log_commit.lsn = wal->append_add(key, value, expiry_ms);
+            }
+
             // All conditions satisfied, create the Node and insert it as we have all the required locks
-            Node* new_node = new Node(key, value, top_level);
+            Node* new_node = create_node(key, value, top_level);
+            new_node->expiry_ms = expiry_ms;
+            new_node->sequence = sequence;
+
+            // Update the predecessor and successors.
+            // The new node is not reachable yet, so its own links can be relaxed stores.
+            for (int level = 0; level <= link_level; level++){
+                new_node->next[level].store(succs[level], memory_order_relaxed);
+            }
+            new_node->prev.store(preds[0], memory_order_relaxed);
+            new_node->set_linked_level(link_level);
+            new_node->index_pending = link_level < top_level;
 
-            // Update the predecessor and successors
-            for (int level = 0; level <= top_level; level++){
-                new_node->next[level] = succs[level];
+            // The new node is at position ranks[0] + 1. It takes over the part of each predecessor's span after it.
+            if(aggregates != NULL){
+                new_node->init_aggregates(aggregates->monoid.identity);
             }
+            if(spans != NULL){
+                new_node->init_spans();
+                for (int level = 0; level <= link_level; level++){
+                    long long before = ranks[0] + 1 - ranks[level];
+                    new_node->set_span(level, preds[level]->get_span(level) - before + 1);
+                }
+            }
+
+            attach_node(new_node);
 
-            for (int level = 0; level <= top_level; level++){
-                preds[level]->next[level] = new_node;
+            // Publishing the node with a release store makes its key, value and links visible to readers
+            for (int level = 0; level <= link_level; level++){
+                preds[level]->set_next(level, new_node);
+            }
+
+            // The lock of preds[0] keeps every other writer from changing what precedes succs[0]
+            succs[0]->set_prev(new_node);
+
+            // Shorten the spans of the predecessors, and lengthen the links passing over the new node
+            if(spans != NULL){
+                for (int level = 0; level <= link_level; level++){
+                    long long before = ranks[0] + 1 - ranks[level];
+                    preds[level]->add_span(level, before - preds[level]->get_span(level));
+                }
+                for (int level = link_level + 1; level <= max_level; level++){
+                    preds[level]->add_span(level, 1);
+                }
             }
 
             // Mark the node as completely linked.
-            new_node->fully_linked = true;
+            new_node->set_fully_linked();
+            if(link_level < top_level){
+                push_pending(new_node);
+            }
+            statistics->record_add(top_level, new_node->memory_usage());
             
             // Release lock of all the nodes held once insert is complete
             for (auto const& x : locked_nodes){
                 x.first->unlock();
             }
+
+            if(aggregates != NULL){
+                new_node->mark_aggregate_stale();
+                touch_aggregates(key, sequence);
+            }
+            if(link_level < top_level){
+                help_index();
+            }
+            if(cache != NULL){
+                evict_if_needed();
+            }
             
             return true;
         }catch(const std::exception& e){
@@ -170,6 +515,7 @@ bool SkipList::add(int key, string value) {
             for (auto const& x : locked_nodes){
                     x.first->unlock();
             }
+            statistics->record_insert_retry();
         }
     }
 }
@@ -180,6 +526,28 @@ bool SkipList::add(int key, string value) {
 */
 string SkipList::search(int key){
 
+    // A key missing from the filter is not in the skip list
+    if(filter != NULL && !filter->may_contain(key)){
+        return "";
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    // With a hash index, one probe finds the node
+    if(hash_index != NULL){
+        Node *node = hash_index->find(key);
+        if(node == NULL || !node->is_fully_linked() || node->is_marked()){
+            return "";
+        }
+        if(node->is_expired()){
+            remove_node(key, node);
+            return "";
+        }
+        if(cache != NULL){
+            node->set_referenced();
+        }
+        return node_value(node);
+    }
+
     // Finds the predecessor and successors 
     vector<Node*> preds(max_level + 1); 
     vector<Node*> succs(max_level + 1);
@@ -199,29 +567,175 @@ string SkipList::search(int key){
     Node *curr = head; 
 
     for (int level = max_level; level >= 0; level--){
-        while (curr->next[level] != NULL && key > curr->next[level]->get_key()){
-            curr = curr->next[level];
+        Node *next = curr->get_next(level);
+        while (next != NULL && key > next->get_key()){
+            curr = next;
+            next = curr->get_next(level);
         }
     }
 
-    curr = curr->next[0];
+    curr = curr->get_next(0);
     
     // If found, unmarked and fully linked, then return value. Else return empty.
-    if ((curr != NULL) && (curr->get_key() == key) && succs[found]->fully_linked && !succs[found]->marked){
-        return curr->get_value();
+    if ((curr != NULL) && (curr->get_key() == key) && succs[found]->is_fully_linked() && !succs[found]->is_marked()){
+        // An expired node is deleted by the first lookup which finds it
+        if(curr->is_expired()){
+            remove_node(key, curr);
+            return "";
+        }
+        if(cache != NULL){
+            curr->set_referenced();
+        }
+        return node_value(curr);
     }else {
         return "";
     }
 }
 
+/**
+    State of one lookup of multi_get.
+    A lookup either needs to load the next link of pred at level, or to compare its key with the loaded candidate.
+*/
+struct MultiGetLookup{
+    int key;
+    size_t index;
+    Node *pred;
+    Node *candidate;
+    int level;
+    bool needs_link;
+    bool done;
+    long long path_length;
+};
+
+/**
+    Looks up a batch of keys and stores the value of keys[i] in values[i], empty if not found.
+    The keys are visited in sorted order so every group of lookups starts from the predecessors
+    of the previous group (finger) instead of the head. MULTI_GET_GROUP traversals are interleaved:
+    each step of a lookup prefetches the node it needs next and moves on to another lookup,
+    so the cache misses of the group overlap instead of being served one after another.
+*/
+void SkipList::multi_get(const vector<int> &keys, vector<string> &values){
+    values.assign(keys.size(), "");
+
+    // Probes of the hash index do not share any path, so they gain nothing from the finger
+    if(hash_index != NULL){
+        for (size_t i = 0; i < keys.size(); i++){
+            values[i] = search(keys[i]);
+        }
+        return;
+    }
+
+    // Keys missing from the filter are not looked up
+    vector<size_t> order;
+    order.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++){
+        if(filter == NULL || filter->may_contain(keys[i])){
+            order.push_back(i);
+        }
+    }
+    sort(order.begin(), order.end(), [&keys](size_t a, size_t b){ return keys[a] < keys[b]; });
+    EpochGuard epoch_guard(node_reclaimer());
+
+    // Predecessors at each level of the largest key looked up so far. Their keys are smaller than any key still to come.
+    vector<Node*> finger(max_level + 1, head);
+
+    MultiGetLookup lookups[MULTI_GET_GROUP];
+
+    for (size_t start = 0; start < order.size(); start += MULTI_GET_GROUP){
+        size_t count = min((size_t) MULTI_GET_GROUP, order.size() - start);
+
+        // Start every lookup from the lowest level of the finger which does not overshoot its key
+        for (size_t i = 0; i < count; i++){
+            MultiGetLookup &lookup = lookups[i];
+            lookup.index = order[start + i];
+            lookup.key = keys[lookup.index];
+
+            int level = 0;
+            while (level < max_level && finger[level]->get_next(level)->get_key() < lookup.key){
+                level++;
+            }
+            lookup.pred = finger[level];
+            lookup.level = level;
+            lookup.candidate = NULL;
+            lookup.needs_link = true;
+            lookup.done = false;
+            lookup.path_length = 0;
+            PREFETCH(&lookup.pred->next[level]);
+        }
+
+        size_t active = count;
+        while (active > 0){
+            for (size_t i = 0; i < count; i++){
+                MultiGetLookup &lookup = lookups[i];
+                if(lookup.done){
+                    continue;
+                }
+
+                // Load the link prefetched in the previous round and prefetch the node it points to
+                if(lookup.needs_link){
+                    lookup.candidate = lookup.pred->get_next(lookup.level);
+                    lookup.needs_link = false;
+                    lookup.path_length++;
+                    PREFETCH(lookup.candidate);
+                    continue;
+                }
+
+                // Compare with the candidate and prefetch the link needed in the next round
+                if(lookup.key > lookup.candidate->get_key()){
+                    lookup.pred = lookup.candidate;
+                    lookup.needs_link = true;
+                    PREFETCH(&lookup.pred->next[lookup.level]);
+                    continue;
+                }
+
+                // The last lookup of the group leaves its predecessors as the finger of the next group
+                if(i == count - 1){
+                    finger[lookup.level] = lookup.pred;
+                }
+
+                if(lookup.level > 0){
+                    lookup.level--;
+                    lookup.needs_link = true;
+                    PREFETCH(&lookup.pred->next[lookup.level]);
+                    continue;
+                }
+
+                // Reached level 0. Found if unmarked and fully linked.
+                Node *node = lookup.candidate;
+                if(node->get_key() == lookup.key && node->is_fully_linked() && !node->is_marked() && !node->is_expired()){
+                    values[lookup.index] = node_value(node);
+                    if(cache != NULL){
+                        node->set_referenced();
+                    }
+                }
+                statistics->record_search(lookup.path_length);
+                lookup.done = true;
+                active--;
+            }
+        }
+    }
+}
+
 /**
     Deletes from the Skip list at the appropriate place using locks.
     Return if key doesn’t exist in the list.
 */
 bool SkipList::remove(int key){
+    EpochGuard epoch_guard(node_reclaimer());
+    return remove_node(key, NULL);
+}
+
+/**
+    Deletes the node of key, only if it is expected when expected is not NULL.
+    With try_claim, gives up instead of waiting if the node is locked by another thread.
+    If claimed_value is not NULL, stores the value of the node once it is marked.
+    Returns false if there is no such node, or if the node had expired, since an expired key does not exist any more.
+*/
+bool SkipList::remove_node(int key, Node *expected, bool try_claim, string *claimed_value){
     // Initialization
     Node* victim = NULL;
     bool is_marked = false;
+    bool expired = false;
     int top_level = -1;
 
     // Initialization of references of the predecessors and successors
@@ -233,34 +747,77 @@ bool SkipList::remove(int key){
         succs[i] = NULL;
     }
 
+    // Versions of the predecessors when their links were read
+    vector<uint64_t> versions(max_level + 1);
+
+    SpanWriter span_writer(spans);
+    LogCommit log_commit(wal);
+
+    if(index != NULL){
+        return remove_lazily(key, expected, try_claim, claimed_value, log_commit.lsn);
+    }
+
     // Keep trying to delete the element from the list. In case predecessors and successors are changed,
     // this loop helps to try the delete again
     while(true){
         
-        // Find the predecessors and successors of where the key to be deleted
-        int found = find(key, preds, succs);
+        // Find the predecessors and successors of where the key to be deleted. In a multimap, of the node of the
+        // key which is marked or expected, or else of the oldest one.
+        uint64_t sequence = is_marked ? victim->sequence : (expected != NULL ? expected->sequence : 0);
+        int found = find(key, preds, succs, NULL, &versions, sequence);
+
+        // The node we marked is no longer linked at level 0, a concurrent remove_range unlinked it for us
+        if(is_marked && succs[0] != victim){
+            detach_node(victim);
+            victim->unlock();
+            if(aggregates != NULL){
+                touch_aggregates(key, victim->sequence);
+            }
+            retire_node(victim);
+            return !expired;
+        }
 
         // If found, select the node to delete. else return
-        if(found != -1){
+        if(!is_marked && found != -1){
             victim = succs[found];
+            if(expected != NULL && victim != expected){
+                return false;
+            }
         }
 
         // If node not found and the node to be deleted is fully linked and not marked return
         if(is_marked | 
                 (found != -1 &&
-                (victim->fully_linked && victim->top_level == found && !(victim->marked))
+                (victim->is_fully_linked() && victim->get_linked_level() == found && !(victim->is_marked()))
                 )
             ){
                 // If not marked, the we lock the node and mark the node to delete
                 if(!is_marked){
-                    top_level = victim->top_level;
-                    victim->lock();
-                    if(victim->marked){
-                        victim->unlock();
+                    if(!try_claim){
+                        victim->lock();
+                    }else if(!victim->try_lock()){
                         return false;
                     }
-                    victim->marked = true;
+                    if(victim->is_marked()){
+                        victim->unlock_unchanged();
+                        return false;
+                    }
+                    victim->set_marked();
                     is_marked = true;
+
+                    // The value is final once the node is marked, update only changes unmarked nodes
+                    if(claimed_value != NULL){
+                        *claimed_value = node_value(victim);
+                    }
+
+                    // The index maintenance raises only unmarked nodes it holds the lock of, so this is final
+                    top_level = victim->get_linked_level();
+                    expired = victim->is_expired();
+
+                    // Marking is the point where the key is deleted
+                    if(wal != NULL){
+                        log_commit.lsn = wal->append_remove(key);
+                    }
                 }
 
                 // Store all the Nodes which lock we acquire in a map
@@ -286,37 +843,60 @@ bool SkipList::remove(int key){
                         }
                         
                         // If predecessor marked or if the predecessor's next has changed, then abort and try again
-                        valid = !(pred->marked) && pred->next[level] == victim;
+                        valid = succs[level] == victim && pred->validate(versions[level], level, victim);
                     }
 
                     // Conditons are not met, release locks, abort and try again.
                     if(!valid){
                         for (auto const& x : locked_nodes){
-                            x.first->unlock();
+                            x.first->unlock_unchanged();
+                        }
+                        if(pred->is_marked()){
+                            this_thread::yield();
                         }
+                        statistics->record_remove_retry();
                         continue;
                     }
 
                     // All conditions satisfied, delete the Node and link them to the successors appropriately
                     for(int level = top_level; level >= 0; level--){
-                        preds[level]->next[level] = victim->next[level];
+                        preds[level]->set_next(level, victim->get_next(level));
                     }
+                    victim->get_next(0)->set_prev(preds[0]);
 
-                    victim->unlock();
+                    // The predecessors take over the spans of the victim, and the links passing over it get shorter
+                    if(spans != NULL){
+                        for(int level = 0; level <= top_level; level++){
+                            preds[level]->add_span(level, victim->get_span(level) - 1);
+                        }
+                        for(int level = top_level + 1; level <= max_level; level++){
+                            preds[level]->add_span(level, -1);
+                        }
+                    }
 
-                    // delete victim;
+                    detach_node(victim);
+
+                    victim->unlock();
 
                     // Delete is completed, release the locks held.
                     for (auto const& x : locked_nodes){
                         x.first->unlock();
                     }
 
-                    return true;
+                    if(aggregates != NULL){
+                        touch_aggregates(key, victim->sequence);
+                    }
+
+                    // Readers which reached the victim before it was unlinked may still stand on it
+                    retire_node(victim);
+
+                    return !expired;
                 }catch(const std::exception& e){
                     // If any exception occurs during the above delete, release locks of the held nodes and try again.
                     for (auto const& x : locked_nodes){
                         x.first->unlock();
                     }
+                    statistics->record_remove_retry();
                 }
 
             }else{
@@ -338,40 +918,315 @@ map<int, string> SkipList::range(int start_key, int end_key){
         return range_output;
     }
 
+    // Expired nodes passed over, deleted once the walk is done
+    vector<Node*> expired;
+    EpochGuard epoch_guard(node_reclaimer());
+
     Node *curr = head;
 
     for (int level = max_level; level >= 0; level--){
-        while (curr->next[level] != NULL && start_key > curr->next[level]->get_key()){
+        Node *next = curr->get_next(level);
+        while (next != NULL && start_key > next->get_key()){
             if(curr->get_key() >= start_key && curr->get_key() <= end_key){
-                range_output.insert(make_pair(curr->get_key(), curr->get_value()));
+                range_output.insert(make_pair(curr->get_key(), node_value(curr)));
             }
-            curr = curr->next[level];
+            curr = next;
+            next = curr->get_next(level);
         }
     }
 
     while(curr != NULL && end_key >= curr->get_key()){
         if(curr->get_key() >= start_key && curr->get_key() <= end_key){
-            range_output.insert(make_pair(curr->get_key(), curr->get_value()));
+            if(curr->is_expired()){
+                expired.push_back(curr);
+            }else{
+                range_output.insert(make_pair(curr->get_key(), node_value(curr)));
+            }
+        }
+        curr = curr->get_next(0);
+    }
+
+    for (size_t i = 0; i < expired.size(); i++){
+        remove_node(expired[i]->get_key(), expired[i]);
+    }
+
+    return range_output;
+
+}
+
+/**
+    Returns at most limit keys between start_key and end_key (inclusive) with their values, and sets cursor to
+    where the next page starts. The cursor is done once no key is left in the interval.
+    No lock is held between pages: the next page descends the towers again to the key after the last one
+    returned, so keys inserted or deleted in between are seen or not like in any other range.
+*/
+map<int, string> SkipList::range(int start_key, int end_key, size_t limit, RangeCursor &cursor){
+    map<int, string> range_output;
+    cursor.next_key = start_key;
+    cursor.end_key = end_key;
+    cursor.done = start_key > end_key;
+    if(cursor.done || limit == 0){
+        return range_output;
+    }
+
+    // Expired nodes passed over, deleted once the walk is done
+    vector<Node*> expired;
+    EpochGuard epoch_guard(node_reclaimer());
+
+    Node *curr = seek(start_key);
+    while(curr != tail && curr->get_key() <= end_key){
+        if(curr->is_fully_linked() && !curr->is_marked()){
+            if(curr->is_expired()){
+                expired.push_back(curr);
+            }else if(range_output.size() == limit){
+                // A key is left for the next page
+                break;
+            }else{
+                range_output.insert(make_pair(curr->get_key(), node_value(curr)));
+                cursor.next_key = curr->get_key() + 1;
+            }
         }
-        curr = curr->next[0];
+        curr = curr->get_next(0);
+    }
+    cursor.done = curr == tail || curr->get_key() > end_key;
+
+    for (size_t i = 0; i < expired.size(); i++){
+        remove_node(expired[i]->get_key(), expired[i]);
     }
 
     return range_output;
+}
 
+/**
+    Returns the next page of at most limit keys of a paginated range, and moves the cursor past it
+*/
+map<int, string> SkipList::range(RangeCursor &cursor, size_t limit){
+    if(cursor.done){
+        return map<int, string>();
+    }
+    return range(cursor.next_key, cursor.end_key, limit, cursor);
+}
+
+/**
+    Unlinks at the given level every marked node between start_key and end_key which follows pred.
+    Holds only one lock at a time: the lock of pred, then the lock of an unmarked node inserted into the interval
+    concurrently, after which splicing continues.
+    Returns false if pred is no longer the predecessor of start_key at this level, so the caller must find it again.
+*/
+bool SkipList::unlink_marked_run(Node* pred, int level, int start_key, int end_key){
+    pred->lock();
+
+    // An unmarked and locked predecessor stays linked, and no node can be inserted after it
+    if(pred->is_marked() || pred->get_next(level)->get_key() < start_key){
+        pred->unlock_unchanged();
+        return false;
+    }
+
+    while(true){
+        Node *next = pred->get_next(level);
+        Node *after = next;
+        while(after->get_key() <= end_key && after->is_marked()){
+            after = after->get_next(level);
+        }
+
+        // One splice removes the whole run of marked nodes
+        if(after != next){
+            pred->set_next(level, after);
+            if(level == 0){
+                after->set_prev(pred);
+            }
+        }
+
+        if(after->get_key() > end_key){
+            pred->unlock();
+            return true;
+        }
+
+        // An unmarked node was inserted into the interval after it was walked, continue after it
+        pred->unlock();
+        pred = after;
+        pred->lock();
+        if(pred->is_marked()){
+            pred->unlock_unchanged();
+            return false;
+        }
+    }
+}
+
+/**
+    Deletes every key between start_key and end_key (inclusive).
+    The nodes of the interval are marked in one walk of level 0, locking each node only for the time it takes to
+    mark it. Then every level is spliced from the top, with one pointer update per run of marked nodes while holding
+    the lock of the predecessor of start_key. Nodes inserted into the interval concurrently are not deleted.
+    With a lazy index the nodes are only marked, and the index maintenance unlinks them.
+    Returns the number of keys deleted.
+*/
+long long SkipList::remove_range(int start_key, int end_key){
+    // The keys of the head and the tail are not part of any range
+    if(start_key == INT_MINI){
+        start_key++;
+    }
+    if(end_key == INT_MAXI){
+        end_key--;
+    }
+    if(start_key > end_key){
+        return 0;
+    }
+
+    // Spans are left for repair_spans instead of being adjusted node by node
+    SpanWriter span_writer(spans);
+    if(spans != NULL){
+        spans->dirty = true;
+    }
+
+    vector<Node*> preds(max_level + 1);
+    vector<Node*> succs(max_level + 1);
+    vector<Node*> victims;
+    LogCommit log_commit(wal);
+    EpochGuard epoch_guard(node_reclaimer());
+
+    find(start_key, preds, succs);
+
+    // Mark every node of the interval. A node already marked is being deleted by someone else.
+    Node *curr = succs[0];
+    while(curr->get_key() <= end_key){
+        while(!curr->is_fully_linked()){
+        }
+
+        // try_lock, since a concurrent remove holds the lock of its node while it waits for nodes we marked to go away
+        while(!curr->is_marked()){
+            if(curr->try_lock()){
+                if(!curr->is_marked()){
+                    curr->set_marked();
+                    victims.push_back(curr);
+                    if(wal != NULL){
+                        log_commit.lsn = wal->append_remove(curr->get_key());
+                    }
+
+                    // With a lazy index, the maintenance unlinks the node like the ones remove marks
+                    if(index != NULL){
+                        detach_node(curr);
+                        if(!curr->index_pending){
+                            curr->index_pending = true;
+                            push_pending(curr);
+                        }
+                    }
+                }
+                curr->unlock();
+                break;
+            }
+        }
+        curr = curr->get_next(0);
+    }
+
+    if(victims.empty()){
+        return 0;
+    }
+    if(index != NULL){
+        if(aggregates != NULL){
+            aggregates->dirty++;
+        }
+        help_index();
+        return victims.size();
+    }
+
+    // Unlink from the top level down, so a node linked at a level is always linked at the levels below
+    for (int level = max_level; level >= 0; level--){
+        while(!unlink_marked_run(preds[level], level, start_key, end_key)){
+            find(start_key, preds, succs);
+        }
+    }
+
+    // The links over the interval changed at every level, the next aggregate recomputes them all
+    if(aggregates != NULL){
+        aggregates->dirty++;
+    }
+
+    for (size_t i = 0; i < victims.size(); i++){
+        detach_node(victims[i]);
+        retire_node(victims[i]);
+    }
+
+    return victims.size();
+}
+
+/**
+    Deletes every key of the skip list
+*/
+void SkipList::clear(){
+    remove_range(INT_MINI, INT_MAXI);
+}
+
+/**
+    Frees every node and the shared state of the skip list.
+    Only for a skip list which no thread, and no copy of it, uses any more.
+*/
+void SkipList::destroy(){
+    if(head == NULL){
+        return;
+    }
+    stop_span_repair();
+    stop_stats_dump();
+    stop_reaper();
+    stop_index_maintenance();
+    stop_value_compaction();
+    close_log();
+
+    // Marked nodes waiting for the lazy index are unlinked and retired, the others are freed below
+    build_index();
+
+    Node *curr = head;
+    while(curr != NULL){
+        Node *next = curr == tail ? NULL : curr->get_next(0);
+
+        // A node marked but still linked may hold a kept value
+        if(value_log != NULL){
+            ValueLog::discard(curr->value_handle);
+        }
+        delete curr;
+        curr = next;
+    }
+
+    delete statistics;
+    delete spans;
+    delete wal;
+    delete filter;
+    delete hash_index;
+    delete reaper;
+    delete cache;
+    delete index;
+    delete aggregates;
+    delete next_sequence;
+    delete value_log;
+    node_reclaimer()->reclaim();
+    head = NULL;
+    tail = NULL;
+    statistics = NULL;
+    spans = NULL;
+    wal = NULL;
+    filter = NULL;
+    hash_index = NULL;
+    reaper = NULL;
+    cache = NULL;
+    index = NULL;
+    aggregates = NULL;
+    next_sequence = NULL;
+    value_log = NULL;
 }
 
 /**
     Display the skip list in readable format
 */
 void SkipList::display(){
+    EpochGuard epoch_guard(node_reclaimer());
     for (int i = 0; i <= max_level; i++) {
         Node *temp = head;
         int count = 0;
-        if(!(temp->get_key() == INT_MINI && temp->next[i]->get_key() == INT_MAXI)){
+        if(!(temp->get_key() == INT_MINI && temp->get_next(i)->get_key() == INT_MAXI)){
             printf("Level %d  ", i);
             while (temp != NULL){
                 printf("%d -> ", temp->get_key());
-                temp = temp->next[i];
+                temp = temp->get_next(i);
                 count++;
             }
             cout<<endl;
@@ -381,8 +1236,56 @@ void SkipList::display(){
     printf("---------- Display done! ----------\n\n");
 }
 
-SkipList::SkipList(){   
+/**
+    Returns a snapshot of the runtime statistics
+*/
+SkipListStats SkipList::stats(){
+    if(statistics == NULL){
+        return SkipListStats();
+    }
+    return statistics->snapshot(max_level, promotion_probability);
+}
+
+/**
+    Prints the statistics to the given stream every interval_ms milliseconds until stopped
+*/
+void SkipList::start_stats_dump(int interval_ms, ostream &out){
+    if(statistics == NULL){
+        return;
+    }
+    statistics->start_dump(interval_ms, max_level, promotion_probability, out);
 }
 
+/**
+    Stops the periodic dump of the statistics
+*/
+void SkipList::stop_stats_dump(){
+    if(statistics == NULL){
+        return;
+    }
+    statistics->stop_dump();
+}
+
+SkipList::SkipList(){
+    head = NULL;
+    tail = NULL;
+    statistics = NULL;
+    spans = NULL;
+    wal = NULL;
+    filter = NULL;
+    hash_index = NULL;
+    reaper = NULL;
+    cache = NULL;
+    index = NULL;
+    aggregates = NULL;
+    next_sequence = NULL;
+    value_log = NULL;
+    max_level = 0;
+}
+
+/**
+    Destructor. Copies of a skip list share its nodes and its state, statistics included, so the destructor
+    frees nothing and destroy frees them once.
+*/
 SkipList::~SkipList(){
 }
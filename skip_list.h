@@ -1,22 +1,362 @@
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
 #include <map>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "node.h"
+#include "skip_list_stats.h"
+#include "write_ahead_log.h"
+#include "bloom_filter.h"
+#include "hash_index.h"
+#include "value_log.h"
+#include "epoch.h"
+
+/**
+    Reclaimer of the nodes removed from every skip list. The public operations enter it, and a node is freed once
+    it is unlinked from the towers and the hash index and no operation which entered before may still stand on it.
+*/
+EpochReclaimer* node_reclaimer();
+
+/**
+    Monoid over the keys and values of a skip list: measure maps a key and its value to a number, and combine,
+    which must be associative with identity as its neutral element, folds the numbers of an interval.
+    For example a sum of values, or a maximum with -infinity as identity.
+*/
+struct AggregateMonoid{
+    double (*measure)(int key, const string &value);
+    double (*combine)(double a, double b);
+    double identity;
+};
+
+/**
+    Construction time options of the skip list
+*/
+struct SkipListOptions{
+    // Every link stores the number of level 0 nodes it skips, which enables rank, select and count in O(log n)
+    bool indexable;
+
+    // Counters per expected element of a counting bloom filter which answers most lookups of missing keys
+    // without a traversal, 0 for no filter. 10 counters (10 bytes) per element give about 1% false positives.
+    int filter_counters_per_key;
+
+    // A hash table from key to node, so that search is one probe instead of a traversal.
+    // Costs one bucket per expected element, and range and iteration still use the towers.
+    bool hash_index;
+
+    // Bounded cache mode: once the skip list holds more than cache_max_elements elements or cache_max_bytes
+    // bytes of nodes, inserts evict the keys least recently looked up with the CLOCK policy. 0 for no limit.
+    long long cache_max_elements;
+    long long cache_max_bytes;
+
+    // Lazy index: inserts link new nodes at level 0 only and deletes only mark nodes, and start_index_maintenance
+    // raises and unlinks them in the background. Inserts then lock one predecessor instead of one per level, and
+    // deletes only the node.
+    bool lazy_index;
+
+    // Multimap mode: add appends a key which already exists after its other values instead of returning false.
+    // A multimap has no hash index, and cannot open a write-ahead log.
+    bool multimap;
+
+    // Every link stores the aggregate of the values it skips, so that aggregate folds an interval in O(log n).
+    // Off while aggregate.measure is NULL.
+    AggregateMonoid aggregate;
+
+    // Key-value separation: values are appended to a value log and nodes store their handle, so nodes do not
+    // own their values and update replaces a value by swapping the handle
+    bool value_log;
+
+    SkipListOptions();
+};
+
+/**
+    Shared state of an indexable skip list.
+    Spans are updated exactly by a writer running alone. When writers overlap, the ranks they computed before
+    taking their locks may be stale, so the spans are flagged dirty until repair_spans recomputes them.
+*/
+struct SpanState{
+    // Number of writers currently updating spans
+    atomic<int> writers;
+
+    // Set when writers overlapped since the last repair
+    atomic<bool> dirty;
+
+    // Periodic repair of the spans
+    thread repair_thread;
+    mutex repair_mutex;
+    condition_variable repair_condition;
+    bool repair_running;
+};
+
+/**
+    Background reaper which deletes expired keys
+*/
+struct ReaperState{
+    thread reaper_thread;
+    mutex reaper_mutex;
+    condition_variable reaper_condition;
+    bool reaper_running;
+};
+
+// Number of stacks of nodes waiting for the lazy index. Threads push to different stacks, so they do not
+// contend on a single atomic.
+#define INDEX_STRIPES 16
+
+/**
+    Stack of nodes waiting for the lazy index, padded to a cache line
+*/
+struct IndexStripe{
+    atomic<Node*> pending;
+
+    // Number of nodes the threads of the stripe pushed, so that they help the maintenance every so often
+    atomic<unsigned int> pushed;
+    char padding[64 - sizeof(atomic<Node*>) - sizeof(atomic<unsigned int>)];
+};
+
+/**
+    Background maintenance of a lazy index
+*/
+struct IndexState{
+    IndexStripe stripes[INDEX_STRIPES];
+
+    thread index_thread;
+    mutex index_mutex;
+    condition_variable index_condition;
+    bool index_running;
+};
+
+/**
+    Shared state of a skip list with an aggregate
+*/
+struct AggregateState{
+    AggregateMonoid monoid;
+
+    // Set by the writers which change many links at once, until repair_aggregates recomputes every aggregate
+    atomic<long long> dirty;
+
+    // Serializes the repairs, readers which find no stale node do not take it
+    mutex repair_mutex;
+};
+
+/**
+    Shared state of a bounded skip list
+*/
+struct CacheState{
+    long long max_elements;
+    long long max_bytes;
+
+    // Key at which the clock hand stopped, the next sweep starts from the first key greater than or equal to it
+    atomic<int> hand;
+
+    // Set while a thread evicts, the other inserts do not wait for it and go on
+    atomic<bool> evicting;
+
+    // Number of keys evicted
+    atomic<long long> evictions;
+};
+
+/**
+    Position of a paginated range: the keys still to return are from next_key to end_key, unless done
+*/
+struct RangeCursor{
+    int next_key;
+    int end_key;
+    bool done;
+};
+
+/**
+    Position in a descending walk of level 0, returned by SkipList::rbegin.
+    Nodes deleted or expired are passed over. A key inserted behind the position while it moves may be missed.
+    An iterator stays in a critical section of the node reclaimer until it is destroyed, so nodes removed
+    meanwhile are only freed after that.
+*/
+class ReverseIterator{
+    private:
+        Node *node;
+        Node *head;
+        ValueLog *value_log;
+        uint64_t ticket;
+        void skip_deleted();
+    public:
+        ReverseIterator(Node *node, Node *head, ValueLog *value_log);
+        ReverseIterator(const ReverseIterator &other);
+        ReverseIterator& operator=(const ReverseIterator &other);
+        ~ReverseIterator();
+        bool valid();
+        int key();
+        string value();
+        void next();
+};
 
 class SkipList{
     private:
         // Head and Tail of the Skiplist
         Node *head;
         Node *tail;
+
+        // The Maximum level of the skip list
+        int max_level;
+
+        // Striped runtime counters, shared by copies of the skip list, NULL once the skip list is destroyed
+        SkipListStatistics *statistics;
+
+        // State of the indexable mode, NULL if the skip list is not indexable
+        SpanState *spans;
+
+        // Write-ahead log of the mutations, NULL until open_log is called
+        WriteAheadLog *wal;
+
+        // Counting bloom filter of the keys, NULL if the skip list has none
+        CountingBloomFilter *filter;
+
+        // Hash index of the nodes, NULL if the skip list has none
+        HashIndex *hash_index;
+
+        // Background reaper of expired keys, shared by copies of the skip list
+        ReaperState *reaper;
+
+        // Budget and clock hand of the bounded cache mode, NULL if the skip list is not bounded
+        CacheState *cache;
+
+        // Maintenance of the lazy index, NULL if inserts link every level themselves
+        IndexState *index;
+
+        // Monoid and repair of the aggregates of the links, NULL if the skip list has no aggregate
+        AggregateState *aggregates;
+
+        // Sequence of the next value added to a multimap, NULL if the keys are unique
+        atomic<uint64_t> *next_sequence;
+
+        // Log of the values of the key-value separation, NULL if nodes store their values
+        ValueLog *value_log;
+
+        void attach_node(Node *node);
+        void detach_node(Node *node);
+        bool remove_node(int key, Node *expected, bool try_claim = false, string *claimed_value = NULL);
+        int reap_chunk(int start_key, int chunk_size, long long &reaped);
+        Node* seek(int key);
+        Node* seek_last(int key);
+        vector<int> scan_boundaries(int start_key, int end_key, int parts);
+        void scan_part(int part, int start_key, int end_key, const function<void(int, int, const string&)> &visit);
+        void evict_if_needed();
+        void evict();
+        bool claim_from(Node *curr, bool try_claim, int &key, string &value);
+        Node* spray(int threads);
+        SkipList empty_like();
+        bool background_running();
+        long long estimate_rank(int key);
+        bool can_link(Node *pred, int level, uint64_t version, Node *succ);
+        void push_pending(Node *node);
+        void help_index();
+        long long drain_index(int first_stripe, int last_stripe);
+        bool raise_node(Node *node, vector<Node*> &preds);
+        bool lower_node(Node *node, vector<Node*> &preds);
+        bool maintain_node(Node *node, long long &changed, bool *unlinked = NULL);
+        void unlink_node(Node *node);
+        void retire_node(Node *node);
+        bool remove_lazily(int key, Node *expected, bool try_claim, string *claimed_value, uint64_t &lsn);
+        bool unlink_marked_run(Node* pred, int level, int start_key, int end_key);
+        void touch_aggregates(int key, uint64_t sequence = 0);
+        void repair_node_aggregates(Node *node);
+        void repair_all_aggregates();
+        Node* create_node(int key, const string &value, int level);
+        string node_value(Node *node);
     public:
         SkipList();
         SkipList(int max_elements, float probability);
+        SkipList(int max_elements, float probability, SkipListOptions options);
         ~SkipList();
         int get_random_level();
 
-        // Supported operations
-        int find(int key, vector<Node*> &predecessors, vector<Node*> &successors);
-        bool add(int key, string value);
+        // Supported operations. The nodes found are only safe to use inside a critical section of node_reclaimer.
+        int find(int key, vector<Node*> &predecessors, vector<Node*> &successors, vector<long long> *ranks = NULL, vector<uint64_t> *versions = NULL, uint64_t sequence = 0);
+        bool add(int key, string value, long long ttl_ms = 0);
+        bool add_until(int key, string value, long long expiry_ms);
         string search(int key);
+        void multi_get(const vector<int> &keys, vector<string> &values);
         bool remove(int key);
         map<int, string> range(int start_key, int end_key);
+        map<int, string> range(int start_key, int end_key, size_t limit, RangeCursor &cursor);
+        map<int, string> range(RangeCursor &cursor, size_t limit);
+        long long remove_range(int start_key, int end_key);
+
+        // Multimap mode: every value of a key, oldest first
+        vector<string> equal_range(int key);
+        bool remove_one(int key, const string &value);
+        long long remove_all(int key);
+        long long add_all(int key, const vector<string> &values);
+
+        // Descending walks over the previous links of level 0
+        ReverseIterator rbegin();
+        ReverseIterator rbegin(int key);
+        vector<pair<int, string>> reverse_range(int end_key, int start_key);
+        vector<pair<int, string>> range_limit(int start_key, int end_key, size_t limit, bool descending = false);
+
+        // Scans of an interval cut into parts walked by several threads
+        int parallel_scan(int start_key, int end_key, int threads, const function<void(int, int, const string&)> &visit);
+        vector<pair<int, string>> parallel_range(int start_key, int end_key, int threads);
+        void clear();
+        void destroy();
         void display();
-};
\ No newline at end of file
+
+        // Expiry of keys added with a time to live
+        long long remove_expired();
+        void start_reaper(int interval_ms);
+        void stop_reaper();
+
+        // Priority queue: the smallest key, exactly or from near the head (SprayList)
+        bool peek_min(int &key, string &value);
+        bool pop_min(int &key, string &value);
+        bool peek_min_relaxed(int &key, string &value, int threads);
+        bool pop_min_relaxed(int &key, string &value, int threads);
+
+        // Index levels of a lazy index, linked in the background
+        long long build_index();
+        void start_index_maintenance(int interval_ms);
+        void stop_index_maintenance();
+
+        // Resharding, without concurrent writers
+        bool split_at(int key, SkipList &upper);
+        bool concat(SkipList &other);
+
+        // Bounded cache mode
+        long long evictions();
+
+        // Snapshot of the keys and values in a binary file
+        bool save(const string &path, int bloom_bits_per_key = 0);
+        bool load(const string &path);
+
+        // Durability through a write-ahead log, replayed when it is opened
+        bool open_log(const string &path, WalMode mode = WAL_SYNC, int sync_interval_ms = 10);
+        void close_log();
+        bool log_failed();
+
+        // Order statistics, available when the skip list is indexable
+        long long rank(int key);
+        bool select(long long k, int &key, string &value);
+        long long count(int start_key, int end_key);
+        void repair_spans();
+        void start_span_repair(int interval_ms);
+        void stop_span_repair();
+
+        // Range aggregation, available when the skip list has an aggregate
+        bool aggregate(int start_key, int end_key, double &result);
+        void repair_aggregates();
+
+        // Key-value separation, available when the skip list has a value log
+        bool update(int key, string value);
+        long long compact_values();
+        void start_value_compaction(int interval_ms);
+        void stop_value_compaction();
+        bool value_log_usage(long long &live_bytes, long long &segment_bytes);
+
+        // Runtime statistics
+        SkipListStats stats();
+        void start_stats_dump(int interval_ms, ostream &out = cout);
+        void stop_stats_dump();
+};
+
+#endif
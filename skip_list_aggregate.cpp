@@ -0,0 +1,174 @@
+/**
+    Range aggregation over a skip list whose links store the aggregate of the values they skip.
+
+    The aggregate of a node at a level folds the measures of the nodes after it up to and including its next node
+    at that level, so the aggregate of an interval is the fold of the aggregates of the links of a path from the
+    predecessor of start_key to the last key not greater than end_key. The path climbs the towers and comes down
+    again like a finger search, O(log n) links for any length of interval.
+
+    The aggregates are repaired lazily on read. A writer which linked or unlinked a node descends to its key once
+    more and flags the predecessor at every level stale, which covers the links passing over the node as well as
+    the ones it changed. A reader which meets a stale node recomputes its aggregates from the level below,
+    repairing the stale nodes there first, under a mutex so that two repairs do not overwrite each other.
+    Each repair only clears the flag if no writer flagged the node again meanwhile.
+    Writers which change many links at once, remove_range and load, flag the whole skip list instead, and the next
+    aggregate recomputes everything with one walk per level.
+
+    Nodes marked for deletion count as the identity, so a delete which only marks its node, with a lazy index,
+    flags the predecessors too. Nodes expired count until they are deleted, and the aggregate of an interval
+    written concurrently may or may not include those writes. Once the writers are done it is exact.
+*/
+
+#include <limits>
+#include "skip_list.h"
+
+/**
+    Flags the predecessors of key at every level stale, in a multimap of the node of key with the given sequence.
+    Called by a writer once it changed the links at key.
+*/
+void SkipList::touch_aggregates(int key, uint64_t sequence){
+    Node *curr = head;
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next->is_before(key, sequence)){
+            curr = next;
+            next = curr->get_next(level);
+        }
+        curr->mark_aggregate_stale();
+    }
+}
+
+/**
+    Recomputes the aggregates of node if it is stale, and first those of the stale nodes below its links.
+    Called with the repair mutex held.
+*/
+void SkipList::repair_node_aggregates(Node *node){
+    unsigned int stale = node->aggregate_stale.load(memory_order_acquire);
+    if(stale == 0){
+        return;
+    }
+
+    const AggregateMonoid &monoid = aggregates->monoid;
+    int levels = node == head ? max_level : node->get_linked_level();
+
+    Node *next = node->get_next(0);
+    node->set_aggregate(0, next == tail || next->is_marked() ? monoid.identity : monoid.measure(next->get_key(), node_value(next)));
+
+    // A link folds the links of the level below which it passes over
+    for (int level = 1; level <= levels; level++){
+        Node *end = node->get_next(level);
+        double total = node->get_aggregate(level - 1);
+        Node *curr = node->get_next(level - 1);
+        while(curr != end && curr != tail && curr->is_before(end->get_key(), end->sequence)){
+            repair_node_aggregates(curr);
+            total = monoid.combine(total, curr->get_aggregate(level - 1));
+            curr = curr->get_next(level - 1);
+        }
+        node->set_aggregate(level, total);
+    }
+
+    // Left stale if a writer flagged it again while it was repaired
+    node->aggregate_stale.compare_exchange_strong(stale, 0, memory_order_release, memory_order_relaxed);
+}
+
+/**
+    Recomputes every aggregate, one level at a time from level 0, with one walk per level.
+    Called with the repair mutex held.
+*/
+void SkipList::repair_all_aggregates(){
+    const AggregateMonoid &monoid = aggregates->monoid;
+
+    for (int level = 0; level <= max_level; level++){
+        Node *node = head;
+        while(node != tail){
+            Node *end = node->get_next(level);
+            if(level == 0){
+                node->aggregate_stale.exchange(0);
+                node->set_aggregate(0, end == tail || end->is_marked() ? monoid.identity : monoid.measure(end->get_key(), node_value(end)));
+            }else{
+                double total = node->get_aggregate(level - 1);
+                Node *curr = node->get_next(level - 1);
+                while(curr != end && curr != tail && curr->is_before(end->get_key(), end->sequence)){
+                    total = monoid.combine(total, curr->get_aggregate(level - 1));
+                    curr = curr->get_next(level - 1);
+                }
+                node->set_aggregate(level, total);
+            }
+            node = end;
+        }
+    }
+}
+
+/**
+    Recomputes every aggregate if a writer flagged the whole skip list since the last time
+*/
+void SkipList::repair_aggregates(){
+    if(aggregates == NULL){
+        return;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    lock_guard<mutex> guard(aggregates->repair_mutex);
+    long long dirty = aggregates->dirty.load();
+    if(dirty == 0){
+        return;
+    }
+    repair_all_aggregates();
+
+    // Left dirty if another writer flagged it while it was repaired
+    aggregates->dirty.compare_exchange_strong(dirty, 0);
+}
+
+/**
+    Folds the measures of the keys between start_key and end_key (inclusive) with the monoid of the skip list.
+    The result is the identity for an empty interval. Returns false if the skip list has no aggregate.
+*/
+bool SkipList::aggregate(int start_key, int end_key, double &result){
+    if(aggregates == NULL){
+        return false;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    const AggregateMonoid &monoid = aggregates->monoid;
+    result = monoid.identity;
+    if(start_key > end_key){
+        return true;
+    }
+    if(aggregates->dirty != 0){
+        repair_aggregates();
+    }
+
+    // The last node before start_key
+    Node *curr = head;
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next->get_key() < start_key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+
+    // Follows the longest link of each node which still ends inside the interval
+    int level = 0;
+    while(true){
+        int levels = curr == head ? max_level : curr->get_linked_level();
+        while(level < levels && curr->get_next(level + 1) != tail && curr->get_next(level + 1)->get_key() <= end_key){
+            level++;
+        }
+        while(level >= 0 && (curr->get_next(level) == tail || curr->get_next(level)->get_key() > end_key)){
+            level--;
+        }
+        if(level < 0){
+            break;
+        }
+
+        if(curr->aggregate_stale.load(memory_order_acquire) != 0){
+            lock_guard<mutex> guard(aggregates->repair_mutex);
+            repair_node_aggregates(curr);
+        }
+        Node *next = curr->get_next(level);
+        result = monoid.combine(result, curr->get_aggregate(level));
+        curr = next;
+    }
+    return true;
+}
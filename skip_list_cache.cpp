@@ -0,0 +1,94 @@
+/**
+    Bounded cache mode of the skip list, with CLOCK eviction over level 0.
+
+    Every node has a reference bit, set with a relaxed store by the lookups which find it. When an insert takes
+    the skip list over its budget, the clock hand sweeps level 0 from where it stopped last time: a node with its
+    bit set gets it cleared and is passed over, a node without it is a victim. Victims are collected until the
+    skip list is CACHE_EVICT_SLACK below its budget and then deleted one by one, so the nodes which the sweep
+    passes over are never locked and readers never wait for an eviction.
+    Only one thread evicts at a time. The others see the evicting flag and return at once instead of waiting.
+*/
+
+#include <limits>
+#include "skip_list.h"
+
+// An insert checks the budget once every CACHE_CHECK_INTERVAL inserts of its thread, since summing up the
+// striped element count on every insert would cost more than the insert. The skip list may go over its budget
+// by this many inserts per thread before the next eviction.
+#define CACHE_CHECK_INTERVAL 16
+
+// An eviction brings the skip list 1/CACHE_EVICT_SLACK below its budget, so evictions run in batches
+#define CACHE_EVICT_SLACK 64
+
+/**
+    Evicts if the skip list may be over its budget. Called by inserts once their locks are released.
+*/
+void SkipList::evict_if_needed(){
+    static thread_local unsigned int inserts = 0;
+    if(++inserts % CACHE_CHECK_INTERVAL == 0 && !cache->evicting.load(memory_order_relaxed)){
+        evict();
+    }
+}
+
+/**
+    Sweeps the clock hand over level 0 and deletes the keys without their reference bit until the skip list is
+    below its budget. Returns at once if another thread is evicting.
+*/
+void SkipList::evict(){
+    if(cache->evicting.exchange(true)){
+        return;
+    }
+
+    long long elements = statistics->element_count();
+    long long excess_elements = 0;
+    long long excess_bytes = 0;
+    if(cache->max_elements > 0 && elements > cache->max_elements){
+        excess_elements = elements - cache->max_elements + cache->max_elements / CACHE_EVICT_SLACK;
+    }
+    if(cache->max_bytes > 0){
+        long long bytes = statistics->node_bytes();
+        if(bytes > cache->max_bytes){
+            excess_bytes = bytes - cache->max_bytes + cache->max_bytes / CACHE_EVICT_SLACK;
+        }
+    }
+    if(excess_elements == 0 && excess_bytes == 0){
+        cache->evicting.store(false);
+        return;
+    }
+
+    // Two rounds of the clock are enough: the first one clears every reference bit it passes
+    long long sweep_limit = 2 * elements + 2;
+
+    vector<Node*> victims;
+    long long victim_bytes = 0;
+    Node *curr = seek(cache->hand.load());
+    for (long long i = 0; i < sweep_limit && ((long long) victims.size() < excess_elements || victim_bytes < excess_bytes); i++){
+        if(curr == tail){
+            curr = head->get_next(0);
+            continue;
+        }
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->clear_referenced()){
+            victims.push_back(curr);
+            victim_bytes += curr->memory_usage();
+        }
+        curr = curr->get_next(0);
+    }
+    cache->hand.store(curr == tail ? numeric_limits<int>::min() : curr->get_key());
+
+    // A victim looked up again since the sweep is evicted anyway, the policy is approximate
+    long long evicted = 0;
+    for (size_t i = 0; i < victims.size(); i++){
+        if(remove_node(victims[i]->get_key(), victims[i])){
+            evicted++;
+        }
+    }
+    cache->evictions.fetch_add(evicted);
+    cache->evicting.store(false);
+}
+
+/**
+    Returns the number of keys evicted from a bounded skip list
+*/
+long long SkipList::evictions(){
+    return cache != NULL ? cache->evictions.load() : 0;
+}
@@ -0,0 +1,330 @@
+/**
+    Lazy index of the skip list, in the style of the no hot spot and rotating skip lists.
+
+    With options.lazy_index, an insert links its node at level 0 only, locking a single predecessor, and pushes
+    the node onto one of INDEX_STRIPES lock free stacks. The node keeps the top level drawn for it. A delete only
+    marks its node, under the lock of the node alone, and pushes it too. The index maintenance takes the stacks and
+    finds the predecessors of each node. It raises an unmarked node to its top level one level at a time, and
+    lowers a marked one from the level it is linked at down to level 0, which unlinks it. Each step holds the lock
+    of the node and of its predecessor at that level.
+    A marked node stays linked until then, and an insert may link a node next to it, so a writer checks that its
+    predecessor is still linked at the level instead of unmarked. A link is only ever changed under the lock of
+    the node it belongs to, and a node unlinks from the top down, so readers never meet a node linked at a level
+    but not the ones below. A node missing from the upper levels, or a marked one left in them, only makes their
+    path a little longer.
+    The heights stay geometric, since they are drawn at insert as before and the maintenance unlinks whole towers.
+    A marked node is on exactly one stack, or in the hands of one maintenance, until it is unlinked from every
+    level. A writer which finds it in its way may unlink it first, but only the maintenance which takes it from
+    its stack retires it.
+*/
+
+#include <chrono>
+#include <algorithm>
+#include "skip_list.h"
+
+// A writer which pushed a node helps the maintenance with the stack of its thread once every INDEX_HELP_INTERVAL
+// pushes to it. Without it the writers outrun the maintenance thread whenever it gets less CPU than them, and
+// their searches walk ever longer runs of level 0 and of marked nodes. Helping often with a few nodes each time
+// keeps the latency of the writer which helps close to that of the others.
+#define INDEX_HELP_INTERVAL 2
+
+static atomic<unsigned int> next_index_stripe(0);
+
+/**
+    Returns the stack the calling thread pushes to
+*/
+static int thread_index_stripe(){
+    static thread_local int stripe = next_index_stripe.fetch_add(1, memory_order_relaxed) % INDEX_STRIPES;
+    return stripe;
+}
+
+/**
+    Returns true if succ still follows pred at level, whose lock the caller holds, so a node can be linked between
+    them. With a lazy index a marked node stays linked until the maintenance unlinks it, and nodes can be linked
+    next to it as long as it is. Otherwise, pred must be unmarked and unchanged since version was read.
+*/
+bool SkipList::can_link(Node *pred, int level, uint64_t version, Node *succ){
+    if(index != NULL){
+        return (pred == head || pred->get_linked_level() >= level) && pred->get_next(level) == succ;
+    }
+    return pred->validate(version, level, succ) && !succ->is_marked();
+}
+
+/**
+    Pushes a node waiting for the maintenance onto the stack of the calling thread
+*/
+void SkipList::push_pending(Node *node){
+    atomic<Node*> &pending = index->stripes[thread_index_stripe()].pending;
+
+    Node *top = pending.load(memory_order_relaxed);
+    do{
+        node->index_next = top;
+    }while(!pending.compare_exchange_weak(top, node, memory_order_release, memory_order_relaxed));
+}
+
+/**
+    Takes the stack of the calling thread if it was pushed to INDEX_HELP_INTERVAL times since the last time.
+    Called by writers once their locks are released. A single stack keeps the work of a writer short.
+*/
+void SkipList::help_index(){
+    int stripe = thread_index_stripe();
+    if((index->stripes[stripe].pushed.fetch_add(1, memory_order_relaxed) + 1) % INDEX_HELP_INTERVAL != 0){
+        return;
+    }
+    drain_index(stripe, stripe + 1);
+}
+
+/**
+    Links node, locked by the caller and unmarked, at the levels above the ones it is linked at, up to its top
+    level. preds are the predecessors of the node found before it was locked.
+    Stops at the first level where the predecessor changed since. Returns false if the node has to be tried again.
+*/
+bool SkipList::raise_node(Node *node, vector<Node*> &preds){
+    for (int level = node->get_linked_level() + 1; level <= node->top_level; level++){
+        Node *pred = preds[level];
+        pred->lock();
+        Node *succ = pred->get_next(level);
+        if(!can_link(pred, level, 0, succ) || succ->is_before(node->get_key(), node->sequence + 1)){
+            pred->unlock_unchanged();
+            return false;
+        }
+
+        // The node is not reachable at this level yet, its own link can be a relaxed store
+        node->next[level].store(succ, memory_order_relaxed);
+        pred->set_next(level, node);
+        node->set_linked_level(level);
+        pred->unlock();
+    }
+    return true;
+}
+
+/**
+    Unlinks node, locked by the caller and marked, from the level it is linked at down to level 0.
+    preds are the predecessors of the node found before it was locked.
+    Stops at the first level where the predecessor changed since. Returns false if the node has to be tried again.
+*/
+bool SkipList::lower_node(Node *node, vector<Node*> &preds){
+    for (int level = node->get_linked_level(); level >= 0; level--){
+        Node *pred = preds[level];
+        pred->lock();
+        if(!can_link(pred, level, 0, node)){
+            pred->unlock_unchanged();
+            return false;
+        }
+
+        // The links of the node only change under its lock, which is held
+        pred->set_next(level, node->get_next(level));
+        if(level == 0){
+            node->get_next(0)->set_prev(pred);
+        }
+        node->set_linked_level(level - 1);
+        pred->unlock();
+    }
+    return true;
+}
+
+/**
+    Raises node to its top level, or unlinks it if it is marked, and adds the number of levels linked or unlinked
+    to changed. Sets unlinked, if given, when the node was marked and is now unlinked from every level.
+    Returns false if the node has to be tried again.
+*/
+bool SkipList::maintain_node(Node *node, long long &changed, bool *unlinked){
+    vector<Node*> preds(max_level + 1);
+    vector<Node*> succs(max_level + 1);
+    find(node->get_key(), preds, succs, NULL, NULL, node->sequence);
+
+    node->lock();
+    int linked_before = node->get_linked_level();
+    bool marked = node->is_marked();
+    bool done = marked ? lower_node(node, preds) : raise_node(node, preds);
+    int linked = node->get_linked_level() - linked_before;
+    if(done){
+        node->index_pending = false;
+    }
+    if(unlinked != NULL){
+        *unlinked = done && marked;
+    }
+    node->unlock();
+
+    // The spans of the links are computed by the next repair
+    if(linked != 0 && spans != NULL){
+        spans->dirty = true;
+    }
+    if(linked != 0 && aggregates != NULL){
+        if(!marked){
+            node->mark_aggregate_stale();
+        }
+        touch_aggregates(node->get_key(), node->sequence);
+    }
+    changed += linked > 0 ? linked : -linked;
+    return done;
+}
+
+/**
+    Unlinks a marked node at once, for a writer which found it in its way
+*/
+void SkipList::unlink_node(Node *node){
+    long long changed = 0;
+    while(!maintain_node(node, changed)){
+        this_thread::yield();
+    }
+}
+
+/**
+    Deletes the node of key like remove_node, with a lazy index: the node is only marked, and left to the
+    maintenance to unlink. A marked node of a multimap in the way of the delete is unlinked first.
+    Stores the log sequence number of the delete in lsn if the skip list has a write-ahead log.
+*/
+bool SkipList::remove_lazily(int key, Node *expected, bool try_claim, string *claimed_value, uint64_t &lsn){
+    vector<Node*> preds(max_level + 1);
+    vector<Node*> succs(max_level + 1);
+
+    while(true){
+        int found = find(key, preds, succs, NULL, NULL, expected != NULL ? expected->sequence : 0);
+        if(found == -1){
+            return false;
+        }
+        Node *victim = succs[found];
+        if(expected != NULL && victim != expected){
+            return false;
+        }
+        if(victim->is_marked() && expected == NULL && next_sequence != NULL){
+            unlink_node(victim);
+            statistics->record_remove_retry();
+            continue;
+        }
+        if(!victim->is_fully_linked() || victim->is_marked()){
+            return false;
+        }
+
+        if(!try_claim){
+            victim->lock();
+        }else if(!victim->try_lock()){
+            return false;
+        }
+        if(victim->is_marked()){
+            victim->unlock_unchanged();
+            return false;
+        }
+        victim->set_marked();
+
+        // The value is final once the node is marked, update only changes unmarked nodes
+        if(claimed_value != NULL){
+            *claimed_value = node_value(victim);
+        }
+        bool expired = victim->is_expired();
+
+        // Marking is the point where the key is deleted
+        if(wal != NULL){
+            lsn = wal->append_remove(key);
+        }
+        detach_node(victim);
+
+        // A node still waiting to be raised is unlinked instead when the maintenance takes it
+        bool push = !victim->index_pending;
+        victim->index_pending = true;
+        if(push){
+            push_pending(victim);
+        }
+        victim->unlock();
+
+        if(aggregates != NULL){
+            touch_aggregates(key, victim->sequence);
+        }
+        if(push){
+            help_index();
+        }
+        return !expired;
+    }
+}
+
+/**
+    Takes the stacks from first_stripe up to but not including last_stripe, and raises or unlinks every node
+    on them. Returns the number of levels linked or unlinked.
+*/
+long long SkipList::drain_index(int first_stripe, int last_stripe){
+    vector<Node*> nodes;
+    for (int i = first_stripe; i < last_stripe; i++){
+        Node *node = index->stripes[i].pending.exchange(NULL, memory_order_acquire);
+        while(node != NULL){
+            nodes.push_back(node);
+            node = node->index_next;
+        }
+    }
+
+    // In key order, the search for each node finds the node raised before it in the index and walks only the
+    // level 0 nodes in between
+    sort(nodes.begin(), nodes.end(), [](Node *a, Node *b){ return a->is_before(b->get_key(), b->sequence); });
+
+    long long changed = 0;
+    vector<Node*> retry;
+    for (size_t i = 0; i < nodes.size(); i++){
+        bool unlinked = false;
+        if(!maintain_node(nodes[i], changed, &unlinked)){
+            retry.push_back(nodes[i]);
+        }else if(unlinked){
+            // Unlinked from every level, and on no stack any more
+            retire_node(nodes[i]);
+        }
+    }
+
+    for (size_t i = 0; i < retry.size(); i++){
+        push_pending(retry[i]);
+    }
+    return changed;
+}
+
+/**
+    Raises every node waiting for a lazy index to its top level, and unlinks the marked ones.
+    Returns the number of levels linked or unlinked, 0 if none was waiting or the skip list has no lazy index.
+*/
+long long SkipList::build_index(){
+    if(index == NULL){
+        return 0;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+    return drain_index(0, INDEX_STRIPES);
+}
+
+/**
+    Starts a thread which builds the index. It goes on at once while it finds nodes waiting,
+    and otherwise waits interval_ms milliseconds.
+*/
+void SkipList::start_index_maintenance(int interval_ms){
+    if(index == NULL){
+        return;
+    }
+    stop_index_maintenance();
+
+    SkipList list = *this;
+    IndexState *state = index;
+    state->index_running = true;
+    state->index_thread = thread([list, state, interval_ms]() mutable {
+        unique_lock<mutex> guard(state->index_mutex);
+        while(state->index_running){
+            guard.unlock();
+            long long changed = list.build_index();
+            guard.lock();
+            if(changed == 0 && state->index_running){
+                state->index_condition.wait_for(guard, chrono::milliseconds(interval_ms));
+            }
+        }
+    });
+}
+
+/**
+    Stops the index maintenance if it is running
+*/
+void SkipList::stop_index_maintenance(){
+    if(index == NULL){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(index->index_mutex);
+        index->index_running = false;
+    }
+    index->index_condition.notify_all();
+    if(index->index_thread.joinable()){
+        index->index_thread.join();
+    }
+}
@@ -0,0 +1,90 @@
+/**
+    Durability of the skip list through a write-ahead log.
+
+    Every add and remove appends a record to the log while it holds its locks, and returns once the record is
+    durable as required by the mode of the log (see write_ahead_log.h). Opening the log replays it into the
+    skip list first, so a skip list rebuilt after a crash gets back every mutation that was committed.
+    Once a write or fdatasync of the log fails, nothing is logged any more and log_failed returns true. The
+    mutations still change the skip list, so a caller which needs them durable checks it after each one.
+*/
+
+#include <unistd.h>
+#include <string.h>
+#include "skip_list.h"
+
+/**
+    Applies one record of the log to the skip list passed as context
+*/
+static void replay_record(void *context, uint8_t type, int key, const string &value){
+    SkipList *list = (SkipList*) context;
+    if(type == WAL_RECORD_ADD){
+        list->add(key, value);
+    }else if(type == WAL_RECORD_ADD_EXPIRING){
+        int64_t expiry = 0;
+        memcpy(&expiry, value.data(), min(value.size(), sizeof(expiry)));
+        list->add_until(key, value.size() > sizeof(expiry) ? value.substr(sizeof(expiry)) : "", expiry);
+    }else{
+        list->remove(key);
+    }
+}
+
+/**
+    Replays the log at path into the skip list, then logs every following mutation to it.
+    A torn record at the end of the log, left by a crash during a write, is cut off.
+    Must be called before the skip list is shared with other threads.
+    Returns false if the log cannot be read or opened, if the skip list is a multimap, whose deletes the log
+    could not tell apart since it records only their key, or if a background thread of the skip list runs.
+*/
+bool SkipList::open_log(const string &path, WalMode mode, int sync_interval_ms){
+    if(next_sequence != NULL){
+        return false;
+    }
+
+    // The background threads work on copies of the skip list made without the log, and would not log
+    if(background_running()){
+        return false;
+    }
+    if(wal == NULL){
+        wal = new WriteAheadLog();
+    }
+    if(wal->is_open()){
+        return false;
+    }
+
+    // The log is not open yet, so the replayed mutations are not logged again
+    long long valid_length = read_write_ahead_log(path, replay_record, this);
+    if(valid_length < 0){
+        return false;
+    }
+    if(access(path.c_str(), F_OK) == 0 && truncate(path.c_str(), valid_length) != 0){
+        return false;
+    }
+
+    return wal->open(path, mode, sync_interval_ms);
+}
+
+/**
+    Returns true if the log of the skip list failed, so the mutations since it did are not durable
+*/
+bool SkipList::log_failed(){
+    return wal != NULL && wal->has_failed();
+}
+
+/**
+    Returns true if the reaper, the stats dump, the span repair, the index maintenance or the value compaction
+    runs
+*/
+bool SkipList::background_running(){
+    return (reaper != NULL && reaper->reaper_thread.joinable()) || (statistics != NULL && statistics->dump_started())
+        || (spans != NULL && spans->repair_thread.joinable()) || (index != NULL && index->index_thread.joinable())
+        || (value_log != NULL && value_log->compaction_thread.joinable());
+}
+
+/**
+    Makes every logged mutation durable and closes the log. Following mutations are not logged.
+*/
+void SkipList::close_log(){
+    if(wal != NULL){
+        wal->close();
+    }
+}
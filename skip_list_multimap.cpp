@@ -0,0 +1,190 @@
+/**
+    Multimap mode of the skip list: a key may have many values, each in a node of its own.
+
+    Every node of a multimap gets a sequence number from a counter of the skip list when it is added, and the
+    nodes are ordered by key and then by sequence, so the values of a key follow each other in the order they were
+    added. Searches for a key still go by key alone and land on its oldest value, which search and range return.
+    Writers find the exact node of a key with its sequence, so inserts and deletes of the values of one key lock
+    only their own neighbours.
+    equal_range walks the values of a key after one descent, O(log n + d) for d values. remove_one walks them to
+    the value to delete, and remove_all deletes them all like remove_range, both in O(log n + d) too.
+    add_all links a batch of values of one key as one run of nodes, with one search and one round of locks.
+*/
+
+#include <algorithm>
+#include "skip_list.h"
+
+/**
+    Returns every value of key, oldest first. A skip list of unique keys returns at most one value.
+*/
+vector<string> SkipList::equal_range(int key){
+    EpochGuard epoch_guard(node_reclaimer());
+    vector<string> values;
+    Node *curr = seek(key);
+    while(curr != tail && curr->get_key() == key){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            values.push_back(node_value(curr));
+        }
+        curr = curr->get_next(0);
+    }
+    return values;
+}
+
+/**
+    Deletes the oldest node of key holding value.
+    Returns false if key has no such value.
+*/
+bool SkipList::remove_one(int key, const string &value){
+    EpochGuard epoch_guard(node_reclaimer());
+    Node *curr = seek(key);
+    while(curr != tail && curr->get_key() == key){
+        // A node deleted meanwhile by another thread still links to the next value
+        if(curr->is_fully_linked() && !curr->is_marked() && node_value(curr) == value && remove_node(key, curr)){
+            return true;
+        }
+        curr = curr->get_next(0);
+    }
+    return false;
+}
+
+/**
+    Deletes every value of key. Returns the number of values deleted.
+*/
+long long SkipList::remove_all(int key){
+    return remove_range(key, key);
+}
+
+/**
+    Appends values to key, in order and after its other values. The nodes are linked as one run with a single
+    search, holding the locks of the predecessors of the run at every level where one of them is linked.
+    A skip list of unique keys adds the first value only, if key is missing.
+    Returns the number of values added.
+*/
+long long SkipList::add_all(int key, const vector<string> &values){
+    if(values.empty()){
+        return 0;
+    }
+    if(next_sequence == NULL){
+        return add(key, values[0]) ? 1 : 0;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    // The run takes consecutive sequences, after every node of key added before
+    uint64_t first_sequence = next_sequence->fetch_add(values.size());
+
+    // Levels of the nodes, and the highest level where one of them is linked now
+    vector<int> top_levels(values.size());
+    int link_level = 0;
+    for (size_t i = 0; i < values.size(); i++){
+        top_levels[i] = get_random_level();
+        if(index == NULL){
+            link_level = max(link_level, top_levels[i]);
+        }
+    }
+
+    vector<Node*> preds(max_level + 1);
+    vector<Node*> succs(max_level + 1);
+    vector<uint64_t> versions(max_level + 1);
+
+    while(true){
+        find(key, preds, succs, NULL, &versions, first_sequence);
+
+        map<Node*, int> locked_nodes;
+        Node *pred = NULL;
+        Node *succ = NULL;
+        bool valid = true;
+        for (int level = 0; valid && level <= link_level; level++){
+            pred = preds[level];
+            succ = succs[level];
+            if(!locked_nodes.count(pred)){
+                pred->lock();
+                locked_nodes.insert(make_pair(pred, 1));
+            }
+            valid = can_link(pred, level, versions[level], succ);
+        }
+
+        if(!valid){
+            for (auto const& x : locked_nodes){
+                x.first->unlock_unchanged();
+            }
+            if(pred->is_marked() || succ->is_marked()){
+                this_thread::yield();
+            }
+            statistics->record_insert_retry();
+            continue;
+        }
+
+        // First and last node of the run at each level. The run is not reachable yet, so its own links can be
+        // relaxed stores.
+        vector<Node*> first(link_level + 1, NULL);
+        vector<Node*> last(link_level + 1, NULL);
+        vector<Node*> nodes(values.size());
+        for (size_t i = 0; i < values.size(); i++){
+            Node *node = create_node(key, values[i], top_levels[i]);
+            node->sequence = first_sequence + i;
+            node->prev.store(i == 0 ? preds[0] : nodes[i - 1], memory_order_relaxed);
+            int node_link_level = index != NULL ? 0 : top_levels[i];
+            node->set_linked_level(node_link_level);
+            node->index_pending = node_link_level < top_levels[i];
+            for (int level = 0; level <= node_link_level; level++){
+                if(first[level] == NULL){
+                    first[level] = node;
+                }else{
+                    last[level]->next[level].store(node, memory_order_relaxed);
+                }
+                last[level] = node;
+            }
+            if(spans != NULL){
+                node->init_spans();
+            }
+            if(aggregates != NULL){
+                node->init_aggregates(aggregates->monoid.identity);
+            }
+            attach_node(node);
+            nodes[i] = node;
+        }
+        for (int level = 0; level <= link_level; level++){
+            if(last[level] != NULL){
+                last[level]->next[level].store(succs[level], memory_order_relaxed);
+            }
+        }
+
+        // Publishing the first node of each level with a release store makes the whole run visible
+        for (int level = 0; level <= link_level; level++){
+            if(first[level] != NULL){
+                preds[level]->set_next(level, first[level]);
+            }
+        }
+        succs[0]->set_prev(last[0]);
+
+        // The spans of the run are left for repair_spans
+        if(spans != NULL){
+            spans->dirty = true;
+        }
+        for (size_t i = 0; i < nodes.size(); i++){
+            nodes[i]->set_fully_linked();
+            if(index != NULL && top_levels[i] > 0){
+                push_pending(nodes[i]);
+            }
+            statistics->record_add(top_levels[i], nodes[i]->memory_usage());
+        }
+
+        for (auto const& x : locked_nodes){
+            x.first->unlock();
+        }
+
+        if(aggregates != NULL){
+            for (size_t i = 0; i < nodes.size(); i++){
+                nodes[i]->mark_aggregate_stale();
+            }
+            touch_aggregates(key, first_sequence);
+        }
+        if(index != NULL){
+            help_index();
+        }
+        if(cache != NULL){
+            evict_if_needed();
+        }
+        return values.size();
+    }
+}
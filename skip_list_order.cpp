@@ -0,0 +1,169 @@
+/**
+    Order statistics of an indexable skip list: rank, select and count in O(log n).
+
+    Every link of an indexable skip list stores its span, the number of level 0 steps it skips. Summing the spans
+    along the search path gives the position of a key. Inserts and deletes keep the spans exact while they run alone.
+    Overlapping writers may use stale positions, in which case the spans are flagged dirty and repair_spans
+    recomputes them with one walk of level 0, either when called or from the periodic repair thread.
+*/
+
+#include <limits>
+#include <chrono>
+#include "skip_list.h"
+
+/**
+    Returns the number of keys smaller than key, or -1 if the skip list is not indexable
+*/
+long long SkipList::rank(int key){
+    if(spans == NULL){
+        return -1;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    Node *curr = head;
+    long long position = 0;
+
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next->get_key() < key){
+            position += curr->get_span(level);
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+    return position;
+}
+
+/**
+    Finds the k-th smallest key, counting from 0, and its value.
+    Returns false if k is out of range or the skip list is not indexable.
+*/
+bool SkipList::select(long long k, int &key, string &value){
+    if(spans == NULL || k < 0){
+        return false;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    // Position of the wanted node, the head is at position 0
+    long long target = k + 1;
+    Node *curr = head;
+    long long position = 0;
+
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next != tail && position + curr->get_span(level) <= target){
+            position += curr->get_span(level);
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+
+    if(curr == head || position != target){
+        return false;
+    }
+
+    key = curr->get_key();
+    value = node_value(curr);
+    return true;
+}
+
+/**
+    Returns the number of keys between start_key and end_key (inclusive), or -1 if the skip list is not indexable
+*/
+long long SkipList::count(int start_key, int end_key){
+    if(spans == NULL){
+        return -1;
+    }
+    if(start_key > end_key){
+        return 0;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    long long end_rank = end_key == numeric_limits<int>::max() ? rank(end_key) : rank(end_key + 1);
+    return end_rank - rank(start_key);
+}
+
+/**
+    Recomputes every span with one walk of level 0.
+    Counts as a writer, so a repair overlapping with writers leaves the spans flagged dirty for the next repair.
+*/
+void SkipList::repair_spans(){
+    if(spans == NULL){
+        return;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    if(spans->writers.fetch_add(1) > 0){
+        spans->dirty = true;
+    }else{
+        spans->dirty = false;
+    }
+
+    // Last node seen at each level and its position
+    vector<Node*> last(max_level + 1, head);
+    vector<long long> last_position(max_level + 1, 0);
+    long long position = 0;
+
+    Node *curr = head->get_next(0);
+    while (curr != tail){
+        position++;
+        for (int level = 0; level <= curr->top_level; level++){
+            // The node is not linked at this level yet
+            if(level > 0 && last[level]->get_next(level) != curr){
+                break;
+            }
+            last[level]->set_span(level, position - last_position[level]);
+            last[level] = curr;
+            last_position[level] = position;
+        }
+        curr = curr->get_next(0);
+    }
+
+    // The tail is one position after the last node
+    position++;
+    for (int level = 0; level <= max_level; level++){
+        last[level]->set_span(level, position - last_position[level]);
+    }
+
+    spans->writers.fetch_sub(1);
+}
+
+/**
+    Starts a thread which repairs the spans every interval_ms milliseconds if they are flagged dirty
+*/
+void SkipList::start_span_repair(int interval_ms){
+    if(spans == NULL){
+        return;
+    }
+    stop_span_repair();
+
+    SkipList list = *this;
+    SpanState *state = spans;
+    state->repair_running = true;
+    state->repair_thread = thread([list, state, interval_ms]() mutable {
+        unique_lock<mutex> guard(state->repair_mutex);
+        while(state->repair_running){
+            state->repair_condition.wait_for(guard, chrono::milliseconds(interval_ms));
+            if(state->repair_running && state->dirty){
+                list.repair_spans();
+            }
+        }
+    });
+}
+
+/**
+    Stops the periodic repair of the spans if it is running
+*/
+void SkipList::stop_span_repair(){
+    if(spans == NULL){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(spans->repair_mutex);
+        spans->repair_running = false;
+    }
+    spans->repair_condition.notify_all();
+    if(spans->repair_thread.joinable()){
+        spans->repair_thread.join();
+    }
+}
@@ -0,0 +1,122 @@
+/**
+    Parallel scans of the skip list.
+
+    A node of level L stands for about 2^L nodes of level 0, so the nodes of an upper level inside the interval
+    cut it into parts of about the same size. The cut descends the towers like a search and counts the nodes of
+    each level inside the interval, from the top down, until there are SCAN_SAMPLES_PER_PART nodes for every
+    part; it then takes every (count / parts)th of them as a boundary. This visits a few hundred nodes however
+    large the interval is. Each thread then seeks the start of its part in O(log n) and walks level 0 to its end.
+    The parts are scanned while writers run, with the same guarantees as range.
+*/
+
+#include "skip_list.h"
+
+// Nodes of the cut level per part. More samples make the parts more even, since the number of level 0 nodes
+// under one node of level L varies around 2^L.
+#define SCAN_SAMPLES_PER_PART 8
+
+/**
+    Returns the keys at which the parts of the interval start, after the first part which starts at start_key.
+    There are parts - 1 keys, or fewer if the interval is too short for as many parts.
+*/
+vector<int> SkipList::scan_boundaries(int start_key, int end_key, int parts){
+    vector<int> keys;
+    Node *pred = head;
+    for (int level = max_level; level >= 1; level--){
+        Node *next = pred->get_next(level);
+        while (next->get_key() < start_key){
+            pred = next;
+            next = pred->get_next(level);
+        }
+
+        keys.clear();
+        while (next != tail && next->get_key() <= end_key){
+            if(next->get_key() > start_key){
+                keys.push_back(next->get_key());
+            }
+            next = next->get_next(level);
+        }
+        if(keys.size() >= (size_t) parts * SCAN_SAMPLES_PER_PART){
+            break;
+        }
+    }
+
+    // keys holds the nodes of level 1 if no level had enough of them
+    parts = min((size_t) parts, keys.size() + 1);
+    vector<int> boundaries;
+    for (int i = 1; i < parts; i++){
+        boundaries.push_back(keys[i * keys.size() / parts]);
+    }
+    return boundaries;
+}
+
+/**
+    Calls visit for every key between start_key and end_key (inclusive), in order.
+    Expired keys are passed over and left to the operations which delete them.
+*/
+void SkipList::scan_part(int part, int start_key, int end_key, const function<void(int, int, const string&)> &visit){
+    Node *curr = seek(start_key);
+    while(curr != tail && curr->get_key() <= end_key){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            visit(part, curr->get_key(), node_value(curr));
+        }
+        curr = curr->get_next(0);
+    }
+}
+
+/**
+    Cuts the keys between start_key and end_key (inclusive) into at most threads parts of about the same size and
+    scans them in parallel, one thread per part. visit is called with the index of the part, the key and the
+    value, for the keys of a part in order; parts with a higher index hold greater keys. visit is called from
+    several threads at once, so a reduction keeps one accumulator per part and combines them afterwards.
+    Returns the number of parts.
+*/
+int SkipList::parallel_scan(int start_key, int end_key, int threads, const function<void(int, int, const string&)> &visit){
+    if(start_key > end_key){
+        return 0;
+    }
+
+    // The workers stand on nodes only while the calling thread waits for them in its critical section
+    EpochGuard epoch_guard(node_reclaimer());
+
+    vector<int> boundaries = scan_boundaries(start_key, end_key, max(threads, 1));
+    boundaries.insert(boundaries.begin(), start_key);
+    int parts = boundaries.size();
+
+    vector<thread> workers;
+    for (int i = 1; i < parts; i++){
+        int part_end = i + 1 < parts ? boundaries[i + 1] - 1 : end_key;
+        workers.push_back(thread([this, i, &boundaries, part_end, &visit](){
+            scan_part(i, boundaries[i], part_end, visit);
+        }));
+    }
+
+    // The calling thread scans the first part
+    scan_part(0, start_key, parts > 1 ? boundaries[1] - 1 : end_key, visit);
+    for (auto &worker : workers){
+        worker.join();
+    }
+    return parts;
+}
+
+/**
+    Returns the keys between start_key and end_key (inclusive) with their values in ascending order, scanned by up
+    to threads threads. Every thread fills the vector of its part, and the parts are appended in order.
+*/
+vector<pair<int, string>> SkipList::parallel_range(int start_key, int end_key, int threads){
+    vector<vector<pair<int, string>>> parts(max(threads, 1));
+    int used = parallel_scan(start_key, end_key, threads, [&parts](int part, int key, const string &value){
+        parts[part].push_back(make_pair(key, value));
+    });
+
+    size_t size = 0;
+    for (int i = 0; i < used; i++){
+        size += parts[i].size();
+    }
+    vector<pair<int, string>> range_output;
+    range_output.reserve(size);
+    for (int i = 0; i < used; i++){
+        range_output.insert(range_output.end(), make_move_iterator(parts[i].begin()), make_move_iterator(parts[i].end()));
+    }
+    return range_output;
+}
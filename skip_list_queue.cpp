@@ -0,0 +1,121 @@
+/**
+    Priority queue operations of the skip list.
+
+    pop_min deletes the first node of level 0 which it can lock and mark. Every thread popping goes for the same
+    few nodes right after the head, so they queue up on their locks.
+    pop_min_relaxed follows the SprayList: a random walk starts at a low level of the head, moves right a random
+    number of steps at each level and drops down, and lands on one of the first O(p log p) nodes for p threads.
+    The node is claimed with try_lock and the mark, and a thread which finds it taken moves on to the next one
+    instead of waiting. The key popped is close to the minimum, not exactly it.
+*/
+
+#include <random>
+#include <functional>
+#include <math.h>
+#include "skip_list.h"
+
+/**
+    Walks level 0 from curr and deletes the first node it can claim, storing its key and value.
+    With try_claim, nodes locked by another thread are passed over. Expired nodes met on the way are deleted.
+    Returns false if the walk reached the tail.
+*/
+bool SkipList::claim_from(Node *curr, bool try_claim, int &key, string &value){
+    while(curr != tail){
+        if(curr->is_fully_linked() && !curr->is_marked()){
+            int node_key = curr->get_key();
+            string claimed_value;
+            if(remove_node(node_key, curr, try_claim, &claimed_value)){
+                key = node_key;
+                value = claimed_value;
+                return true;
+            }
+        }
+        curr = curr->get_next(0);
+    }
+    return false;
+}
+
+/**
+    Random walk of the SprayList for the given number of threads. Starts at level log p + 1 of the head and at
+    each level moves right between 0 and log p + 1 nodes, so the walks of p threads spread over the first
+    O(p log p) nodes. Returns the node of level 0 where the walk ended.
+    The walk takes at least one step at level 0. Otherwise it would stop on tall nodes more often than on short
+    ones, and popping them would leave the front of the skip list without tall nodes, so that the next walks
+    jump far away from the head.
+*/
+Node* SkipList::spray(int threads){
+    static thread_local minstd_rand generator(hash<thread::id>()(this_thread::get_id()));
+
+    int log_threads = threads > 1 ? (int) ceil(log2(threads)) : 0;
+    int height = min(max_level, log_threads + 1);
+    int jump = log_threads + 1;
+
+    Node *curr = head;
+    for (int level = height; level >= 0; level--){
+        int steps = generator() % (jump + 1) + (level == 0 ? 1 : 0);
+        for (int i = 0; i < steps; i++){
+            Node *next = curr->get_next(level);
+            if(next == tail){
+                break;
+            }
+            curr = next;
+        }
+    }
+    return curr == head ? head->get_next(0) : curr;
+}
+
+/**
+    Stores the smallest key and its value. Returns false if the skip list is empty.
+*/
+bool SkipList::peek_min(int &key, string &value){
+    EpochGuard epoch_guard(node_reclaimer());
+    Node *curr = head->get_next(0);
+    while(curr != tail){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            key = curr->get_key();
+            value = node_value(curr);
+            return true;
+        }
+        curr = curr->get_next(0);
+    }
+    return false;
+}
+
+/**
+    Deletes the smallest key and stores it and its value. Returns false if the skip list is empty.
+*/
+bool SkipList::pop_min(int &key, string &value){
+    EpochGuard epoch_guard(node_reclaimer());
+    return claim_from(head->get_next(0), false, key, value);
+}
+
+/**
+    Stores a key near the smallest one and its value, as pop_min_relaxed would find it.
+    Returns false if the skip list is empty.
+*/
+bool SkipList::peek_min_relaxed(int &key, string &value, int threads){
+    EpochGuard epoch_guard(node_reclaimer());
+    Node *curr = spray(threads);
+    while(curr != tail){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            key = curr->get_key();
+            value = node_value(curr);
+            return true;
+        }
+        curr = curr->get_next(0);
+    }
+    return peek_min(key, value);
+}
+
+/**
+    Deletes a key among the first O(p log p) keys, where p is the number of threads popping, and stores it and
+    its value. Falls back to pop_min once the nodes after the walk are all taken.
+    Returns false if the skip list is empty.
+*/
+bool SkipList::pop_min_relaxed(int &key, string &value, int threads){
+    EpochGuard epoch_guard(node_reclaimer());
+    if(claim_from(spray(threads), true, key, value)){
+        return true;
+    }
+    return pop_min(key, value);
+}
@@ -0,0 +1,158 @@
+/**
+    Descending iteration and scans of the skip list.
+
+    Every node has a link to the previous node at level 0, written under the lock of that previous node by the
+    writer which links or unlinks the node before it. A descending scan finds the last node not greater than its
+    end key with one descent of the towers and then follows the previous links, in O(log n + k) for k keys.
+    The previous link of a node may still point to a node being deleted, or miss a node inserted just before
+    it. The walk passes over marked nodes, which keep their own previous link, so it always moves to smaller
+    keys and never returns a deleted key. A node the walk may still reach is not freed while the iterator lives.
+*/
+
+#include <limits>
+#include "skip_list.h"
+
+/**
+    Constructor, called while the caller is in a critical section of the node reclaimer, which the iterator
+    then enters for itself
+*/
+ReverseIterator::ReverseIterator(Node *node, Node *head, ValueLog *value_log){
+    this->node = node;
+    this->head = head;
+    this->value_log = value_log;
+    ticket = node_reclaimer()->enter();
+    skip_deleted();
+}
+
+/**
+    Copies an iterator, the copy enters the node reclaimer too
+*/
+ReverseIterator::ReverseIterator(const ReverseIterator &other){
+    node = other.node;
+    head = other.head;
+    value_log = other.value_log;
+    ticket = node_reclaimer()->enter();
+}
+
+ReverseIterator& ReverseIterator::operator=(const ReverseIterator &other){
+    node = other.node;
+    head = other.head;
+    value_log = other.value_log;
+    return *this;
+}
+
+ReverseIterator::~ReverseIterator(){
+    node_reclaimer()->exit(ticket);
+}
+
+/**
+    Moves back over the nodes which are deleted, expired or not fully linked yet
+*/
+void ReverseIterator::skip_deleted(){
+    while(node != head && (!node->is_fully_linked() || node->is_marked() || node->is_expired())){
+        node = node->get_prev();
+    }
+}
+
+/**
+    Returns false once the walk went past the smallest key
+*/
+bool ReverseIterator::valid(){
+    return node != head;
+}
+
+/**
+    Returns the key at the position
+*/
+int ReverseIterator::key(){
+    return node->get_key();
+}
+
+/**
+    Returns the value at the position
+*/
+string ReverseIterator::value(){
+    string value;
+    if(value_log != NULL && value_log->read(node->value_handle, value)){
+        return value;
+    }
+    return node->get_value();
+}
+
+/**
+    Moves to the next smaller key
+*/
+void ReverseIterator::next(){
+    node = node->get_prev();
+    skip_deleted();
+}
+
+/**
+    Returns the last node at level 0 whose key is less than or equal to key, or the head if there is none,
+    without recording a search
+*/
+Node* SkipList::seek_last(int key){
+    Node *curr = head;
+    for (int level = max_level; level >= 0; level--){
+        Node *next = curr->get_next(level);
+        while (next != tail && next->get_key() <= key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+    return curr;
+}
+
+/**
+    Returns an iterator at the largest key
+*/
+ReverseIterator SkipList::rbegin(){
+    EpochGuard epoch_guard(node_reclaimer());
+    return ReverseIterator(tail->get_prev(), head, value_log);
+}
+
+/**
+    Returns an iterator at the largest key less than or equal to key
+*/
+ReverseIterator SkipList::rbegin(int key){
+    EpochGuard epoch_guard(node_reclaimer());
+    return ReverseIterator(seek_last(key), head, value_log);
+}
+
+/**
+    Returns the keys between start_key and end_key (inclusive) with their values, from end_key down
+*/
+vector<pair<int, string>> SkipList::reverse_range(int end_key, int start_key){
+    return range_limit(start_key, end_key, numeric_limits<size_t>::max(), true);
+}
+
+/**
+    Returns at most limit keys between start_key and end_key (inclusive) with their values: the smallest ones in
+    ascending order, or the largest ones in descending order
+*/
+vector<pair<int, string>> SkipList::range_limit(int start_key, int end_key, size_t limit, bool descending){
+    vector<pair<int, string>> range_output;
+    if(start_key > end_key || limit == 0){
+        return range_output;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    if(descending){
+        for (ReverseIterator it = rbegin(end_key); it.valid() && it.key() >= start_key; it.next()){
+            range_output.push_back(make_pair(it.key(), it.value()));
+            if(range_output.size() == limit){
+                break;
+            }
+        }
+        return range_output;
+    }
+
+    Node *curr = seek(start_key);
+    while(curr != tail && curr->get_key() <= end_key && range_output.size() < limit){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            range_output.push_back(make_pair(curr->get_key(), node_value(curr)));
+        }
+        curr = curr->get_next(0);
+    }
+    return range_output;
+}
@@ -0,0 +1,131 @@
+/**
+    Saves the skip list to a binary snapshot file and restores it.
+
+    save writes the keys of level 0 in order while other threads keep using the skip list, so the snapshot is
+    not a point in time copy: a key inserted or deleted during the walk may or may not be part of it.
+    load maps the file into memory and, if the skip list is empty, builds the towers in one pass appending at
+    the end of each level, without any find or lock. This is much faster than replaying add for every key.
+*/
+
+#include <stdio.h>
+#include <limits>
+#include "skip_list.h"
+#include "snapshot.h"
+
+/**
+    Writes every key and value of the skip list to path.
+    Expired keys are left out, and the expiry time of the others is not stored.
+    The file is written next to path and renamed, so an existing snapshot is replaced only by a complete one.
+    If bloom_bits_per_key is not 0, the file gets a bloom filter of its keys.
+    Returns false if the file could not be written.
+*/
+bool SkipList::save(const string &path, int bloom_bits_per_key){
+    EpochGuard epoch_guard(node_reclaimer());
+    string temporary_path = path + ".tmp";
+    SnapshotWriter writer;
+    if(!writer.open(temporary_path)){
+        return false;
+    }
+    if(bloom_bits_per_key > 0){
+        writer.enable_bloom_filter(bloom_bits_per_key);
+    }
+
+    bool written = true;
+    Node *curr = head->get_next(0);
+    while(written && curr != tail){
+        if(curr->is_fully_linked() && !curr->is_marked() && !curr->is_expired()){
+            written = writer.append(curr->get_key(), node_value(curr));
+        }
+        curr = curr->get_next(0);
+    }
+
+    if(!writer.finish() || !written || rename(temporary_path.c_str(), path.c_str()) != 0){
+        ::remove(temporary_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+    Inserts every key and value of the snapshot at path into the skip list.
+    An empty skip list is built directly from the sorted records; readers may run meanwhile, writers may not.
+    A skip list which is not empty gets the records through add.
+    Returns false if the file is missing or corrupt, or if the write-ahead log failed to make the load durable.
+*/
+bool SkipList::load(const string &path){
+    EpochGuard epoch_guard(node_reclaimer());
+    SnapshotReader reader;
+    if(!reader.open(path)){
+        return false;
+    }
+
+    int key;
+    const char *value;
+    uint32_t length;
+
+    if(head->get_next(0) != tail){
+        while(reader.next(key, value, length)){
+            add(key, string(value, length));
+        }
+        return !log_failed();
+    }
+
+    // Last node linked at each level, new nodes are appended after it
+    vector<Node*> last(max_level + 1, head);
+
+    // Log sequence number of the last record, the whole load is committed at once
+    uint64_t lsn = 0;
+
+    while(reader.next(key, value, length)){
+        if(key == numeric_limits<int>::min() || key == numeric_limits<int>::max()){
+            continue;
+        }
+
+        // Records out of order can only come from a file not written by save. The values of a key in a multimap
+        // follow each other in order.
+        if(last[0] != head && (key < last[0]->get_key() || (key == last[0]->get_key() && next_sequence == NULL))){
+            add(key, string(value, length));
+            continue;
+        }
+
+        int top_level = get_random_level();
+        Node *new_node = create_node(key, string(value, length), top_level);
+        if(next_sequence != NULL){
+            new_node->sequence = next_sequence->fetch_add(1);
+        }
+        for (int level = 0; level <= top_level; level++){
+            new_node->next[level].store(tail, memory_order_relaxed);
+        }
+        if(spans != NULL){
+            new_node->init_spans();
+        }
+        if(aggregates != NULL){
+            new_node->init_aggregates(aggregates->monoid.identity);
+        }
+
+        attach_node(new_node);
+        new_node->prev.store(last[0], memory_order_relaxed);
+        for (int level = 0; level <= top_level; level++){
+            last[level]->set_next(level, new_node);
+            last[level] = new_node;
+        }
+        new_node->set_linked_level(top_level);
+        if(wal != NULL){
+            lsn = wal->append_add(key, string(value, length));
+        }
+        new_node->set_fully_linked();
+        statistics->record_add(top_level, new_node->memory_usage());
+    }
+    tail->set_prev(last[0]);
+    bool durable = lsn == 0 || wal->commit(lsn);
+
+    // The spans are computed once all the nodes are linked
+    repair_spans();
+    repair_aggregates();
+
+    // A bounded skip list evicts what does not fit
+    if(cache != NULL){
+        evict();
+    }
+    return durable;
+}
@@ -0,0 +1,259 @@
+/**
+    Split and concatenation of skip lists, to move a range of keys to another shard without copying it.
+
+    split_at cuts every level at the boundary key: the predecessors of the key are linked to the tail, and the
+    head of the new skip list to their old successors. The last node of every level of the upper part is found
+    with one descent and linked to the tail of the new skip list. concat does the reverse. Both relink about
+    2 (max_level + 1) pointers and walk no part of the skip list. split_at moves the statistics of the upper
+    part in proportion to its element count: exact from the rank of the key in an indexable skip list, and
+    otherwise estimated from an upper level with a few hundred nodes. The node bytes and tower heights moved are estimates.
+
+    No writer may run on either skip list meanwhile. Readers may: they see every key of the skip list, or the
+    keys of its part only.
+    The counting bloom filter, the hash index and the write-ahead log would all need every moved key, and the
+    value log every moved value, so skip lists with any of them are not split or concatenated.
+*/
+
+#include <limits>
+#include <math.h>
+#include "skip_list.h"
+
+// Number of nodes of the level sampled to estimate the element count of the upper part of a split
+#define RANK_SAMPLE_NODES 256
+
+/**
+    Returns an empty skip list with the same levels, indexable, bounded, lazily indexed, aggregated and multimap
+    like this one
+*/
+SkipList SkipList::empty_like(){
+    SkipList list;
+    list.max_level = max_level;
+    list.head = new Node(numeric_limits<int>::min(), max_level);
+    list.tail = new Node(numeric_limits<int>::max(), max_level);
+    list.statistics = new SkipListStatistics();
+    list.reaper = new ReaperState();
+    list.reaper->reaper_running = false;
+
+    for (int level = 0; level <= max_level; level++){
+        list.head->set_next(level, list.tail);
+    }
+    list.tail->set_prev(list.head);
+
+    if(spans != NULL){
+        list.spans = new SpanState();
+        list.spans->writers = 0;
+        list.spans->dirty = false;
+        list.spans->repair_running = false;
+        list.head->init_spans();
+        for (int level = 0; level <= max_level; level++){
+            list.head->set_span(level, 1);
+        }
+    }
+
+    if(index != NULL){
+        list.index = new IndexState();
+        list.index->index_running = false;
+        for (int i = 0; i < INDEX_STRIPES; i++){
+            list.index->stripes[i].pending = NULL;
+            list.index->stripes[i].pushed = 0;
+        }
+    }
+
+    if(aggregates != NULL){
+        list.aggregates = new AggregateState();
+        list.aggregates->monoid = aggregates->monoid;
+        list.aggregates->dirty = 0;
+        list.head->init_aggregates(aggregates->monoid.identity);
+    }
+
+    if(next_sequence != NULL){
+        list.next_sequence = new atomic<uint64_t>(next_sequence->load());
+    }
+
+    if(cache != NULL){
+        list.cache = new CacheState();
+        list.cache->max_elements = cache->max_elements;
+        list.cache->max_bytes = cache->max_bytes;
+        list.cache->hand = numeric_limits<int>::min();
+        list.cache->evicting = false;
+        list.cache->evictions = 0;
+    }
+    return list;
+}
+
+/**
+    Returns an estimate of the number of nodes before key: the share of the nodes before key at the lowest level
+    with fewer than 2 RANK_SAMPLE_NODES nodes, with a promotion probability of 1/2, times the element count.
+    Walks only that level, so the cost does not grow with the skip list.
+*/
+long long SkipList::estimate_rank(int key){
+    long long elements = statistics->element_count();
+    int level = 0;
+    while(level < max_level && (elements >> (level + 1)) >= RANK_SAMPLE_NODES){
+        level++;
+    }
+
+    long long before = 0;
+    long long total = 0;
+    for (Node *curr = head->get_next(level); curr != tail; curr = curr->get_next(level)){
+        total++;
+        if(curr->get_key() < key){
+            before++;
+        }
+    }
+    return total == 0 ? 0 : llround(double(elements) * before / total);
+}
+
+/**
+    Moves every key greater than or equal to key into upper, which must hold no skip list: default constructed,
+    or destroyed.
+    Returns false, and changes nothing, if upper holds a skip list, or if this one has a filter, a hash index,
+    a write-ahead log or a value log.
+*/
+bool SkipList::split_at(int key, SkipList &upper){
+    if(filter != NULL || hash_index != NULL || wal != NULL || value_log != NULL){
+        return false;
+    }
+
+    // Replacing a skip list would lose its nodes and leave its threads running
+    if(upper.head != NULL){
+        return false;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    // Nodes waiting for a lazy index are raised first, so none of them moves to the other skip list
+    build_index();
+    upper = empty_like();
+
+    vector<Node*> preds(max_level + 1);
+    vector<Node*> succs(max_level + 1);
+    vector<long long> ranks(spans != NULL ? max_level + 1 : 0);
+    find(key, preds, succs, spans != NULL ? &ranks : NULL);
+    long long lower_elements = spans != NULL ? ranks[0] : estimate_rank(key);
+
+    // The first node of the upper part at each level follows the new head. A node at position p is at
+    // position p - ranks[0] in the upper part.
+    for (int level = 0; level <= max_level; level++){
+        if(spans != NULL){
+            upper.head->set_span(level, ranks[level] + preds[level]->get_span(level) - ranks[0]);
+        }
+        upper.head->set_next(level, succs[level] == tail ? upper.tail : succs[level]);
+    }
+    upper.head->get_next(0)->set_prev(upper.head);
+
+    // The last node of the upper part at each level still links to the tail of this skip list
+    vector<Node*> last(max_level + 1);
+    vector<Node*> ends(max_level + 1);
+    upper.find(numeric_limits<int>::max(), last, ends);
+    for (int level = 0; level <= max_level; level++){
+        if(last[level] != upper.head){
+            last[level]->set_next(level, upper.tail);
+        }
+    }
+    upper.tail->set_prev(last[0]);
+
+    // The predecessors of key become the last nodes of this skip list
+    for (int level = 0; level <= max_level; level++){
+        if(spans != NULL){
+            preds[level]->set_span(level, ranks[0] + 1 - ranks[level]);
+        }
+        preds[level]->set_next(level, tail);
+    }
+    tail->set_prev(preds[0]);
+
+    // The links of the predecessors now end at the tail. The nodes of the upper part keep theirs, since their
+    // last links cover the same nodes as before.
+    if(aggregates != NULL){
+        touch_aggregates(key);
+    }
+
+    if(spans != NULL && spans->dirty){
+        upper.spans->dirty = true;
+    }
+
+    upper.statistics->move_elements(*statistics, statistics->element_count() - lower_elements);
+    return true;
+}
+
+/**
+    Appends every key of other, which must all be greater than the keys of this skip list, and leaves other
+    empty. Returns false, and changes nothing, if the keys overlap, if the skip lists have different levels or
+    aggregates or only one of them is indexable or a multimap, or if either has a filter, a hash index, a
+    write-ahead log or a value log.
+*/
+bool SkipList::concat(SkipList &other){
+    if(filter != NULL || hash_index != NULL || wal != NULL || value_log != NULL || other.filter != NULL || other.hash_index != NULL || other.wal != NULL || other.value_log != NULL){
+        return false;
+    }
+    if(other.head == head || other.max_level != max_level || (spans == NULL) != (other.spans == NULL)){
+        return false;
+    }
+    if((next_sequence == NULL) != (other.next_sequence == NULL)){
+        return false;
+    }
+    if((aggregates == NULL) != (other.aggregates == NULL) || (aggregates != NULL &&
+        (aggregates->monoid.measure != other.aggregates->monoid.measure || aggregates->monoid.combine != other.aggregates->monoid.combine))){
+        return false;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+
+    build_index();
+    other.build_index();
+
+    // The last node of each level of both skip lists, and their positions
+    vector<Node*> last(max_level + 1);
+    vector<Node*> ends(max_level + 1);
+    vector<long long> ranks(spans != NULL ? max_level + 1 : 0);
+    vector<Node*> other_last(max_level + 1);
+    vector<long long> other_ranks(spans != NULL ? max_level + 1 : 0);
+    find(numeric_limits<int>::max(), last, ends, spans != NULL ? &ranks : NULL);
+    other.find(numeric_limits<int>::max(), other_last, ends, spans != NULL ? &other_ranks : NULL);
+
+    Node *first = other.head->get_next(0);
+    if(first == other.tail){
+        return true;
+    }
+    if(last[0] != head && last[0]->get_key() >= first->get_key()){
+        return false;
+    }
+
+    // Every node of this skip list keeps its position, a node of other moves ranks[0] further
+    long long elements = spans != NULL ? ranks[0] + other_ranks[0] : 0;
+    for (int level = 0; level <= max_level; level++){
+        Node *next = other.head->get_next(level);
+        if(next != other.tail){
+            other_last[level]->set_next(level, tail);
+            if(spans != NULL){
+                last[level]->set_span(level, ranks[0] + other.head->get_span(level) - ranks[level]);
+            }
+            last[level]->set_next(level, next);
+        }else if(spans != NULL){
+            last[level]->set_span(level, elements + 1 - ranks[level]);
+        }
+
+        other.head->set_next(level, other.tail);
+        if(spans != NULL){
+            other.head->set_span(level, 1);
+        }
+    }
+    first->set_prev(last[0]);
+    tail->set_prev(other_last[0]);
+    other.tail->set_prev(other.head);
+
+    // The last links of this skip list now pass over the nodes of other
+    if(aggregates != NULL){
+        touch_aggregates(first->get_key(), first->sequence);
+        other.head->mark_aggregate_stale();
+    }
+
+    // Values added to a key from now on go after the moved ones
+    if(next_sequence != NULL && other.next_sequence->load() > next_sequence->load()){
+        next_sequence->store(other.next_sequence->load());
+    }
+
+    if(spans != NULL && other.spans->dirty){
+        spans->dirty = true;
+    }
+    statistics->move_elements(*other.statistics);
+    return true;
+}
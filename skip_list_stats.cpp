@@ -0,0 +1,275 @@
+/**
+    Runtime statistics of the skip list.
+    Counters are striped per thread so that the hot paths never contend on a single atomic.
+*/
+
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+#include <new>
+#include <stdlib.h>
+#include "skip_list_stats.h"
+
+static atomic<unsigned int> next_stripe(0);
+
+/**
+    Constructor
+*/
+SkipListStatistics::SkipListStatistics(){
+    for (int i = 0; i < STATS_STRIPES; i++){
+        StatsStripe &s = stripes[i];
+        s.element_count = 0;
+        s.node_bytes = 0;
+        s.searches = 0;
+        s.search_path_length = 0;
+        s.insert_retries = 0;
+        s.remove_retries = 0;
+        s.fully_linked_waits = 0;
+        s.fully_linked_wait_ns = 0;
+        for (int level = 0; level < STATS_MAX_LEVELS; level++){
+            s.level_count[level] = 0;
+        }
+    }
+    dump_running = false;
+}
+
+/**
+    Allocates the statistics at the alignment of their stripes
+*/
+void* SkipListStatistics::operator new(size_t bytes){
+    void *pointer = NULL;
+    if(posix_memalign(&pointer, alignof(StatsStripe), bytes) != 0){
+        throw bad_alloc();
+    }
+    return pointer;
+}
+
+void SkipListStatistics::operator delete(void *pointer){
+    free(pointer);
+}
+
+/**
+    Returns the stripe of the calling thread. Threads are assigned stripes round robin on first use.
+*/
+StatsStripe& SkipListStatistics::local_stripe(){
+    static thread_local unsigned int stripe = next_stripe.fetch_add(1, memory_order_relaxed) % STATS_STRIPES;
+    return stripes[stripe];
+}
+
+/**
+    Records a node linked into the skip list
+*/
+void SkipListStatistics::record_add(int level, long long bytes){
+    StatsStripe &s = local_stripe();
+    s.element_count.fetch_add(1, memory_order_relaxed);
+    s.node_bytes.fetch_add(bytes, memory_order_relaxed);
+    s.level_count[level < STATS_MAX_LEVELS ? level : STATS_MAX_LEVELS - 1].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+    Records a node unlinked from the skip list
+*/
+void SkipListStatistics::record_remove(int level, long long bytes){
+    StatsStripe &s = local_stripe();
+    s.element_count.fetch_sub(1, memory_order_relaxed);
+    s.node_bytes.fetch_sub(bytes, memory_order_relaxed);
+    s.level_count[level < STATS_MAX_LEVELS ? level : STATS_MAX_LEVELS - 1].fetch_sub(1, memory_order_relaxed);
+}
+
+/**
+    Records one traversal and the number of nodes it visited
+*/
+void SkipListStatistics::record_search(long long path_length){
+    StatsStripe &s = local_stripe();
+    s.searches.fetch_add(1, memory_order_relaxed);
+    s.search_path_length.fetch_add(path_length, memory_order_relaxed);
+}
+
+void SkipListStatistics::record_insert_retry(){
+    local_stripe().insert_retries.fetch_add(1, memory_order_relaxed);
+}
+
+void SkipListStatistics::record_remove_retry(){
+    local_stripe().remove_retries.fetch_add(1, memory_order_relaxed);
+}
+
+void SkipListStatistics::record_fully_linked_wait(long long wait_ns){
+    StatsStripe &s = local_stripe();
+    s.fully_linked_waits.fetch_add(1, memory_order_relaxed);
+    s.fully_linked_wait_ns.fetch_add(wait_ns, memory_order_relaxed);
+}
+
+/**
+    Takes over the element count, node bytes and tower heights of other, whose nodes were moved to this skip list
+*/
+void SkipListStatistics::move_elements(SkipListStatistics &other){
+    StatsStripe &s = local_stripe();
+    for (int i = 0; i < STATS_STRIPES; i++){
+        StatsStripe &o = other.stripes[i];
+        s.element_count.fetch_add(o.element_count.exchange(0, memory_order_relaxed), memory_order_relaxed);
+        s.node_bytes.fetch_add(o.node_bytes.exchange(0, memory_order_relaxed), memory_order_relaxed);
+        for (int level = 0; level < STATS_MAX_LEVELS; level++){
+            s.level_count[level].fetch_add(o.level_count[level].exchange(0, memory_order_relaxed), memory_order_relaxed);
+        }
+    }
+}
+
+/**
+    Takes over count of the elements of other, whose nodes were moved to this skip list, and the same share of
+    its node bytes and tower heights. The count is exact, the bytes and heights are exact only if the moved nodes
+    are like the others on average. Moves between single stripes, since only the sums of the stripes count.
+*/
+void SkipListStatistics::move_elements(SkipListStatistics &other, long long count){
+    long long total = other.element_count();
+    if(count <= 0 || total <= 0){
+        return;
+    }
+    count = min(count, total);
+    double share = double(count) / total;
+
+    StatsStripe &s = local_stripe();
+    StatsStripe &o = other.local_stripe();
+    long long bytes = llround(other.node_bytes() * share);
+    o.element_count.fetch_sub(count, memory_order_relaxed);
+    s.element_count.fetch_add(count, memory_order_relaxed);
+    o.node_bytes.fetch_sub(bytes, memory_order_relaxed);
+    s.node_bytes.fetch_add(bytes, memory_order_relaxed);
+    for (int level = 0; level < STATS_MAX_LEVELS; level++){
+        long long nodes = 0;
+        for (int i = 0; i < STATS_STRIPES; i++){
+            nodes += other.stripes[i].level_count[level].load(memory_order_relaxed);
+        }
+        long long moved = llround(nodes * share);
+        o.level_count[level].fetch_sub(moved, memory_order_relaxed);
+        s.level_count[level].fetch_add(moved, memory_order_relaxed);
+    }
+}
+
+/**
+    Returns the number of elements by summing up the stripes
+*/
+long long SkipListStatistics::element_count(){
+    long long count = 0;
+    for (int i = 0; i < STATS_STRIPES; i++){
+        count += stripes[i].element_count.load(memory_order_relaxed);
+    }
+    return count;
+}
+
+/**
+    Returns the bytes used by the nodes by summing up the stripes
+*/
+long long SkipListStatistics::node_bytes(){
+    long long bytes = 0;
+    for (int i = 0; i < STATS_STRIPES; i++){
+        bytes += stripes[i].node_bytes.load(memory_order_relaxed);
+    }
+    return bytes;
+}
+
+/**
+    Sums up all the stripes into a snapshot.
+    The snapshot is not atomic with respect to concurrent operations, every counter is individually exact.
+*/
+SkipListStats SkipListStatistics::snapshot(int max_level, float probability){
+    SkipListStats result;
+    int levels = max_level + 1 < STATS_MAX_LEVELS ? max_level + 1 : STATS_MAX_LEVELS;
+
+    result.element_count = 0;
+    result.node_bytes = 0;
+    result.searches = 0;
+    result.search_path_length = 0;
+    result.insert_retries = 0;
+    result.remove_retries = 0;
+    result.fully_linked_waits = 0;
+    result.fully_linked_wait_ns = 0;
+    result.level_histogram.assign(levels, 0);
+
+    for (int i = 0; i < STATS_STRIPES; i++){
+        StatsStripe &s = stripes[i];
+        result.element_count += s.element_count.load(memory_order_relaxed);
+        result.node_bytes += s.node_bytes.load(memory_order_relaxed);
+        result.searches += s.searches.load(memory_order_relaxed);
+        result.search_path_length += s.search_path_length.load(memory_order_relaxed);
+        result.insert_retries += s.insert_retries.load(memory_order_relaxed);
+        result.remove_retries += s.remove_retries.load(memory_order_relaxed);
+        result.fully_linked_waits += s.fully_linked_waits.load(memory_order_relaxed);
+        result.fully_linked_wait_ns += s.fully_linked_wait_ns.load(memory_order_relaxed);
+        for (int level = 0; level < levels; level++){
+            result.level_histogram[level] += s.level_count[level].load(memory_order_relaxed);
+        }
+    }
+
+    result.average_search_path_length = result.searches == 0 ? 0 : (double) result.search_path_length / result.searches;
+
+    // A node reaches level l with probability p^l and stops there with probability (1 - p).
+    // The top level collects every node which would have gone higher.
+    result.expected_level_histogram.assign(levels, 0);
+    for (int level = 0; level < levels; level++){
+        double reach = pow(probability, level);
+        double stop = (level == levels - 1) ? 1 : (1 - probability);
+        result.expected_level_histogram[level] = result.element_count * reach * stop;
+    }
+
+    return result;
+}
+
+/**
+    Starts a thread which prints a snapshot to the given stream every interval_ms milliseconds
+*/
+void SkipListStatistics::start_dump(int interval_ms, int max_level, float probability, ostream &out){
+    stop_dump();
+
+    dump_running = true;
+    dump_thread = thread([this, interval_ms, max_level, probability, &out](){
+        unique_lock<mutex> guard(dump_mutex);
+        while(dump_running){
+            dump_condition.wait_for(guard, chrono::milliseconds(interval_ms));
+            if(!dump_running){
+                break;
+            }
+            print_stats(snapshot(max_level, probability), out);
+        }
+    });
+}
+
+/**
+    Stops the periodic dump if it is running
+*/
+void SkipListStatistics::stop_dump(){
+    {
+        lock_guard<mutex> guard(dump_mutex);
+        dump_running = false;
+    }
+    dump_condition.notify_all();
+    if(dump_thread.joinable()){
+        dump_thread.join();
+    }
+}
+
+/**
+    Returns true if the periodic dump was started and not stopped
+*/
+bool SkipListStatistics::dump_started(){
+    return dump_thread.joinable();
+}
+
+SkipListStatistics::~SkipListStatistics(){
+    stop_dump();
+}
+
+/**
+    Prints a snapshot in readable format
+*/
+void print_stats(const SkipListStats &stats, ostream &out){
+    out << "---------- Skip list statistics ----------" << endl;
+    out << "Elements: " << stats.element_count << endl;
+    out << "Node bytes: " << stats.node_bytes << endl;
+    out << "Searches: " << stats.searches << " Average path length: " << stats.average_search_path_length << endl;
+    out << "Insert retries: " << stats.insert_retries << " Remove retries: " << stats.remove_retries << endl;
+    out << "Fully linked waits: " << stats.fully_linked_waits << " Wait (ns): " << stats.fully_linked_wait_ns << endl;
+    out << "Level histogram (actual / expected):" << endl;
+    for (size_t level = 0; level < stats.level_histogram.size(); level++){
+        out << "  Level " << level << ": " << stats.level_histogram[level] << " / " << stats.expected_level_histogram[level] << endl;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef SKIP_LIST_STATS_H
+#define SKIP_LIST_STATS_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ostream>
+#include <cstddef>
+
+using namespace std;
+
+// Number of counter stripes. Threads are spread over the stripes so that updates do not contend on one cache line
+#define STATS_STRIPES 64
+
+// Maximum number of levels tracked by the tower height histogram
+#define STATS_MAX_LEVELS 32
+
+/**
+    Snapshot of the runtime statistics of a skip list, returned by SkipList::stats()
+*/
+struct SkipListStats{
+    // Number of elements currently linked in the skip list
+    long long element_count;
+
+    // Bytes used by the linked nodes (node, tower and value)
+    long long node_bytes;
+
+    // Number of linked nodes per top level, and the count expected from the geometric distribution
+    vector<long long> level_histogram;
+    vector<double> expected_level_histogram;
+
+    // Number of traversals through find and the total number of nodes they visited
+    long long searches;
+    long long search_path_length;
+    double average_search_path_length;
+
+    // Number of times the insert and delete loops had to try again
+    long long insert_retries;
+    long long remove_retries;
+
+    // Number of times an insert waited for a node to become fully linked, and the total time spent waiting
+    long long fully_linked_waits;
+    long long fully_linked_wait_ns;
+};
+
+/**
+    One stripe of counters, aligned to a cache line so that two stripes never share one
+*/
+struct alignas(64) StatsStripe{
+    atomic<long long> element_count;
+    atomic<long long> node_bytes;
+    atomic<long long> searches;
+    atomic<long long> search_path_length;
+    atomic<long long> insert_retries;
+    atomic<long long> remove_retries;
+    atomic<long long> fully_linked_waits;
+    atomic<long long> fully_linked_wait_ns;
+    atomic<long long> level_count[STATS_MAX_LEVELS];
+};
+
+/**
+    Always-on counters of a skip list. Every thread updates its own stripe with relaxed atomics
+    and a snapshot sums up all the stripes.
+*/
+class SkipListStatistics{
+    private:
+        StatsStripe stripes[STATS_STRIPES];
+
+        // Periodic dump of the statistics
+        thread dump_thread;
+        mutex dump_mutex;
+        condition_variable dump_condition;
+        bool dump_running;
+
+        StatsStripe& local_stripe();
+    public:
+        SkipListStatistics();
+        ~SkipListStatistics();
+
+        // Before C++17 new does not honor the alignment of the stripes
+        static void* operator new(size_t bytes);
+        static void operator delete(void *pointer);
+
+        void record_add(int level, long long bytes);
+        void record_remove(int level, long long bytes);
+        void record_search(long long path_length);
+        void record_insert_retry();
+        void record_remove_retry();
+        void record_fully_linked_wait(long long wait_ns);
+        void move_elements(SkipListStatistics &other);
+        void move_elements(SkipListStatistics &other, long long count);
+
+        long long element_count();
+        long long node_bytes();
+        SkipListStats snapshot(int max_level, float probability);
+
+        void start_dump(int interval_ms, int max_level, float probability, ostream &out);
+        void stop_dump();
+        bool dump_started();
+};
+
+void print_stats(const SkipListStats &stats, ostream &out);
+
+#endif
@@ -0,0 +1,95 @@
+/**
+    Expiry of keys added with a time to live.
+
+    A node stores the time at which it expires, checked against a coarse cached clock (coarse_clock.h), so the
+    hot paths make no system call, and nodes without a time to live never read the clock at all. An expired key
+    is invisible to search, multi_get and range at once. Its node is deleted by the first search, range or add
+    which comes across it, and otherwise by the reaper, which walks level 0 in chunks of REAPER_CHUNK nodes.
+*/
+
+#include <limits>
+#include <chrono>
+#include "skip_list.h"
+
+// Number of nodes the reaper walks before deleting the expired ones among them and finding its place again
+#define REAPER_CHUNK 1024
+
+/**
+    Walks chunk_size nodes of level 0 from the first key greater than or equal to start_key and deletes the
+    expired ones. Adds the number of expired nodes found to reaped.
+    Returns the key to start the next chunk from, the key of the tail once the walk reached the end.
+*/
+int SkipList::reap_chunk(int start_key, int chunk_size, long long &reaped){
+    // One critical section per chunk, so a sweep of the whole skip list does not hold back the freeing
+    EpochGuard epoch_guard(node_reclaimer());
+    Node *curr = seek(start_key);
+
+    // The nodes are deleted after the walk, so the walk never waits for a lock
+    vector<Node*> expired;
+    for (int i = 0; i < chunk_size && curr != tail; i++){
+        if(curr->is_fully_linked() && !curr->is_marked() && curr->is_expired()){
+            expired.push_back(curr);
+        }
+        curr = curr->get_next(0);
+    }
+    int next_key = curr->get_key();
+
+    for (size_t i = 0; i < expired.size(); i++){
+        remove_node(expired[i]->get_key(), expired[i]);
+    }
+    reaped += expired.size();
+    return next_key;
+}
+
+/**
+    Deletes every expired key with one walk of level 0, chunk by chunk.
+    Returns the number of expired keys found.
+*/
+long long SkipList::remove_expired(){
+    long long reaped = 0;
+    int key = numeric_limits<int>::min();
+    while(key != numeric_limits<int>::max()){
+        key = reap_chunk(key, REAPER_CHUNK, reaped);
+        this_thread::yield();
+    }
+    return reaped;
+}
+
+/**
+    Starts a thread which deletes the expired keys every interval_ms milliseconds
+*/
+void SkipList::start_reaper(int interval_ms){
+    stop_reaper();
+
+    SkipList list = *this;
+    ReaperState *state = reaper;
+    state->reaper_running = true;
+    state->reaper_thread = thread([list, state, interval_ms]() mutable {
+        unique_lock<mutex> guard(state->reaper_mutex);
+        while(state->reaper_running){
+            state->reaper_condition.wait_for(guard, chrono::milliseconds(interval_ms));
+            if(state->reaper_running){
+                guard.unlock();
+                list.remove_expired();
+                guard.lock();
+            }
+        }
+    });
+}
+
+/**
+    Stops the reaper if it is running
+*/
+void SkipList::stop_reaper(){
+    if(reaper == NULL){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(reaper->reaper_mutex);
+        reaper->reaper_running = false;
+    }
+    reaper->reaper_condition.notify_all();
+    if(reaper->reaper_thread.joinable()){
+        reaper->reaper_thread.join();
+    }
+}
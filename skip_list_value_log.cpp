@@ -0,0 +1,194 @@
+/**
+    Key-value separation: the values of the skip list live in a value log (value_log.h) and each node stores the
+    8 byte handle of its value. Nodes no longer own a heap allocation of their value, so they are smaller and a
+    traversal only brings keys and links into the cache.
+
+    update appends the new value and swaps the handle of the node while holding its lock, the same lock remove
+    takes to mark the node, so an update never changes a deleted node. The value it replaced counts as dead in
+    its segment. When a node is unlinked, its value moves out of the log into a string of its own, since
+    readers may still reach the node. compact_values moves the live values of the sealed segments which are
+    mostly dead to the end of the log, swapping each handle with a compare and swap that loses to a concurrent
+    update, and frees the segments left with no live value.
+*/
+
+#include <chrono>
+#include "skip_list.h"
+
+/**
+    Creates a node for key, with its value in the value log if the skip list has one.
+    The value stays in the node if the value log is full.
+*/
+Node* SkipList::create_node(int key, const string &value, int level){
+    if(value_log != NULL){
+        uint64_t handle = value_log->append(key, value);
+        if(handle != 0){
+            Node *node = new Node(key, level);
+            node->value_handle.store(handle, memory_order_relaxed);
+            return node;
+        }
+    }
+    return new Node(key, value, level);
+}
+
+/**
+    Returns the value of a node, from the value log if it is there
+*/
+string SkipList::node_value(Node *node){
+    string value;
+    if(value_log != NULL && value_log->read(node->value_handle, value)){
+        return value;
+    }
+    return node->get_value();
+}
+
+/**
+    Replaces the value of key by appending value to the value log. In a multimap, replaces the oldest value.
+    Returns false if the key is missing, if the skip list has no value log or it is full, or if the value was
+    replaced but the write-ahead log failed to make the update durable.
+*/
+bool SkipList::update(int key, string value){
+    if(value_log == NULL){
+        return false;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+    Node *curr = seek(key);
+    while(curr != tail && curr->get_key() == key){
+        if(!curr->is_fully_linked() || curr->is_marked() || curr->is_expired()){
+            curr = curr->get_next(0);
+            continue;
+        }
+
+        // Holding the lock keeps remove from marking the node until the handle is swapped
+        curr->lock();
+        if(curr->is_marked()){
+            curr->unlock_unchanged();
+            continue;
+        }
+        uint64_t handle = value_log->append(key, value);
+        if(handle == 0){
+            curr->unlock_unchanged();
+            return false;
+        }
+        uint64_t replaced = curr->value_handle.exchange(handle);
+
+        // Replayed as a delete and an add of the key
+        uint64_t lsn = 0;
+        if(wal != NULL){
+            wal->append_remove(key);
+            lsn = wal->append_add(key, value, curr->expiry_ms);
+        }
+        curr->unlock_unchanged();
+        bool durable = lsn == 0 || wal->commit(lsn);
+
+        if(replaced != 0){
+            value_log->release(replaced);
+        }
+        if(aggregates != NULL){
+            touch_aggregates(key, curr->sequence);
+        }
+        return durable;
+    }
+    return false;
+}
+
+/**
+    Moves the live values out of the sealed segments which are mostly dead and frees the segments.
+    Values whose node is not linked yet or is being unlinked keep their segment until a later compaction.
+    Returns the number of bytes freed.
+*/
+long long SkipList::compact_values(){
+    if(value_log == NULL){
+        return 0;
+    }
+    EpochGuard epoch_guard(node_reclaimer());
+    lock_guard<mutex> guard(value_log->compaction_mutex);
+
+    long long freed = 0;
+    vector<pair<int, uint64_t>> records;
+    vector<int> slots = value_log->compactable_segments();
+    for (size_t i = 0; i < slots.size(); i++){
+        records.clear();
+        value_log->records(slots[i], records);
+
+        for (size_t j = 0; j < records.size(); j++){
+            int key = records[j].first;
+            uint64_t handle = records[j].second;
+
+            // The node of the record, if it still holds the handle, is among the nodes of its key
+            Node *curr = seek(key);
+            while(curr != tail && curr->get_key() == key && curr->value_handle.load() != handle){
+                curr = curr->get_next(0);
+            }
+            if(curr == tail || curr->get_key() != key){
+                continue;
+            }
+
+            uint64_t moved = value_log->append(key, value_log->read_record(handle));
+            if(moved == 0){
+                continue;
+            }
+            if(curr->value_handle.compare_exchange_strong(handle, moved)){
+                value_log->release(records[j].second);
+            }else{
+                value_log->release(moved);
+            }
+        }
+        freed += value_log->free_segment(slots[i]);
+    }
+    return freed;
+}
+
+/**
+    Starts a thread which compacts the value log every interval_ms milliseconds
+*/
+void SkipList::start_value_compaction(int interval_ms){
+    if(value_log == NULL){
+        return;
+    }
+    stop_value_compaction();
+
+    SkipList list = *this;
+    ValueLog *log = value_log;
+    log->compaction_running = true;
+    log->compaction_thread = thread([list, log, interval_ms]() mutable {
+        unique_lock<mutex> guard(log->compaction_thread_mutex);
+        while(log->compaction_running){
+            log->compaction_condition.wait_for(guard, chrono::milliseconds(interval_ms));
+            if(log->compaction_running){
+                guard.unlock();
+                list.compact_values();
+                guard.lock();
+            }
+        }
+    });
+}
+
+/**
+    Stops the background compaction if it is running
+*/
+void SkipList::stop_value_compaction(){
+    if(value_log == NULL){
+        return;
+    }
+    {
+        lock_guard<mutex> guard(value_log->compaction_thread_mutex);
+        value_log->compaction_running = false;
+    }
+    value_log->compaction_condition.notify_all();
+    if(value_log->compaction_thread.joinable()){
+        value_log->compaction_thread.join();
+    }
+}
+
+/**
+    Stores the bytes of the live values and the bytes allocated to the segments of the value log.
+    Returns false if the skip list has no value log.
+*/
+bool SkipList::value_log_usage(long long &live_bytes, long long &segment_bytes){
+    if(value_log == NULL){
+        return false;
+    }
+    live_bytes = value_log->live_bytes();
+    segment_bytes = value_log->segment_bytes();
+    return true;
+}
@@ -0,0 +1,346 @@
+/**
+    Writes and reads the binary snapshot format of the skip list
+*/
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "bloom_filter.h"
+
+// FNV-1a 64 bit parameters
+#define CHECKSUM_OFFSET_BASIS 14695981039346656037ULL
+#define CHECKSUM_PRIME 1099511628211ULL
+
+/**
+    Extends a FNV-1a checksum with the given bytes
+*/
+uint64_t snapshot_checksum(const char *data, size_t length, uint64_t checksum){
+    for (size_t i = 0; i < length; i++){
+        checksum ^= (unsigned char) data[i];
+        checksum *= CHECKSUM_PRIME;
+    }
+    return checksum;
+}
+
+/**
+    Constructor
+*/
+SnapshotWriter::SnapshotWriter(){
+    file = NULL;
+    offset = 0;
+    record_count = 0;
+    checksum = CHECKSUM_OFFSET_BASIS;
+    bloom_bits_per_key = 0;
+}
+
+/**
+    Creates the file and reserves the space of the header, which is written by finish
+*/
+bool SnapshotWriter::open(const string &path){
+    file = fopen(path.c_str(), "wb");
+    if(file == NULL){
+        return false;
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    if(fwrite(&header, sizeof(header), 1, file) != 1){
+        return false;
+    }
+    offset = sizeof(header);
+    return true;
+}
+
+/**
+    Adds a bloom filter with the given number of bits per key to the file. Must be called before the first append.
+*/
+void SnapshotWriter::enable_bloom_filter(int bits_per_key){
+    bloom_bits_per_key = bits_per_key;
+}
+
+/**
+    Writes bytes covered by the checksum
+*/
+bool SnapshotWriter::write(const void *data, size_t length){
+    if(length > 0 && fwrite(data, length, 1, file) != 1){
+        return false;
+    }
+    checksum = snapshot_checksum((const char*) data, length, checksum);
+    offset += length;
+    return true;
+}
+
+/**
+    Appends one record. Records must be appended in key order.
+*/
+bool SnapshotWriter::append(int key, const string &value){
+    if(record_count % SNAPSHOT_INDEX_INTERVAL == 0){
+        SnapshotIndexEntry entry;
+        entry.key = key;
+        entry.reserved = 0;
+        entry.offset = offset;
+        index.push_back(entry);
+    }
+    record_count++;
+    if(bloom_bits_per_key > 0){
+        bloom_keys.push_back(key);
+    }
+
+    int32_t record_key = key;
+    uint32_t length = value.size();
+    return write(&record_key, sizeof(record_key)) && write(&length, sizeof(length)) && write(value.data(), length);
+}
+
+/**
+    Writes the sparse index, the footer and the header, and flushes the file to disk
+*/
+bool SnapshotWriter::finish(){
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.flags = bloom_bits_per_key > 0 ? SNAPSHOT_FLAG_BLOOM : 0;
+    header.record_count = record_count;
+    header.index_offset = offset;
+
+    uint64_t entries = index.size();
+    bool written = write(&entries, sizeof(entries)) && write(index.data(), index.size() * sizeof(SnapshotIndexEntry));
+
+    if(bloom_bits_per_key > 0){
+        SnapshotBloomHeader bloom_header;
+        bloom_header.bit_count = ((bloom_keys.size() * bloom_bits_per_key + 63) / 64) * 64;
+        bloom_header.hash_count = bloom_hash_count(bloom_bits_per_key);
+        bloom_header.reserved = 0;
+        vector<unsigned char> bits(bloom_header.bit_count / 8, 0);
+        for (size_t i = 0; i < bloom_keys.size(); i++){
+            bloom_set(bits.data(), bloom_header.bit_count, bloom_header.hash_count, bloom_keys[i]);
+        }
+        written = written && write(&bloom_header, sizeof(bloom_header)) && write(bits.data(), bits.size());
+    }
+    written = written && fwrite(&checksum, sizeof(checksum), 1, file) == 1;
+    written = written && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+
+    bool closed = fclose(file) == 0;
+    file = NULL;
+    return written && closed;
+}
+
+SnapshotWriter::~SnapshotWriter(){
+    if(file != NULL){
+        fclose(file);
+    }
+}
+
+/**
+    Constructor
+*/
+SnapshotReader::SnapshotReader(){
+    fd = -1;
+    data = NULL;
+    size = 0;
+    header = NULL;
+    index = NULL;
+    index_entries = 0;
+    bloom = NULL;
+    bloom_bits = 0;
+    bloom_hashes = 0;
+    cursor = 0;
+}
+
+/**
+    Maps the file and validates its header, bounds and checksum
+*/
+bool SnapshotReader::open(const string &path){
+    fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || (size_t) file_stat.st_size < sizeof(SnapshotHeader) + 2 * sizeof(uint64_t)){
+        close();
+        return false;
+    }
+    size = file_stat.st_size;
+
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapped == MAP_FAILED){
+        close();
+        return false;
+    }
+    data = (const char*) mapped;
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    header = (const SnapshotHeader*) data;
+    size_t body_end = size - sizeof(uint64_t);
+    if(memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 || header->version != SNAPSHOT_VERSION ||
+            header->index_offset < sizeof(SnapshotHeader) || header->index_offset + sizeof(uint64_t) > body_end){
+        close();
+        return false;
+    }
+
+    uint64_t expected;
+    memcpy(&expected, data + body_end, sizeof(expected));
+    if(snapshot_checksum(data + sizeof(SnapshotHeader), body_end - sizeof(SnapshotHeader), CHECKSUM_OFFSET_BASIS) != expected){
+        close();
+        return false;
+    }
+
+    // The sparse index and the bloom filter must fit before the footer
+    memcpy(&index_entries, data + header->index_offset, sizeof(index_entries));
+    uint64_t index_end = header->index_offset + sizeof(index_entries);
+    if(index_entries > (body_end - index_end) / sizeof(SnapshotIndexEntry)){
+        close();
+        return false;
+    }
+    index = data + index_end;
+    index_end += index_entries * sizeof(SnapshotIndexEntry);
+
+    if(header->flags & SNAPSHOT_FLAG_BLOOM){
+        SnapshotBloomHeader bloom_header;
+        if(index_end + sizeof(bloom_header) > body_end){
+            close();
+            return false;
+        }
+        memcpy(&bloom_header, data + index_end, sizeof(bloom_header));
+        if(bloom_header.bit_count == 0 || bloom_header.bit_count / 8 > body_end - index_end - sizeof(bloom_header)){
+            close();
+            return false;
+        }
+        bloom = (const unsigned char*) data + index_end + sizeof(bloom_header);
+        bloom_bits = bloom_header.bit_count;
+        bloom_hashes = bloom_header.hash_count;
+    }
+
+    cursor = sizeof(SnapshotHeader);
+    return true;
+}
+
+/**
+    Unmaps and closes the file
+*/
+void SnapshotReader::close(){
+    if(data != NULL){
+        munmap((void*) data, size);
+        data = NULL;
+    }
+    if(fd >= 0){
+        ::close(fd);
+        fd = -1;
+    }
+    header = NULL;
+    index = NULL;
+    index_entries = 0;
+    bloom = NULL;
+}
+
+uint64_t SnapshotReader::record_count(){
+    return header != NULL ? header->record_count : 0;
+}
+
+/**
+    Reads the record at offset and moves offset to the next record. Returns false at the end of the records.
+*/
+bool SnapshotReader::read_record(uint64_t &offset, int &key, const char* &value, uint32_t &length) const{
+    if(header == NULL || offset + sizeof(int32_t) + sizeof(uint32_t) > header->index_offset){
+        return false;
+    }
+
+    int32_t record_key;
+    memcpy(&record_key, data + offset, sizeof(record_key));
+    memcpy(&length, data + offset + sizeof(record_key), sizeof(length));
+    uint64_t value_offset = offset + sizeof(record_key) + sizeof(length);
+    if(value_offset + length > header->index_offset){
+        return false;
+    }
+
+    key = record_key;
+    value = data + value_offset;
+    offset = value_offset + length;
+    return true;
+}
+
+/**
+    Returns the offset of the indexed record closest before the first record with a key greater than or equal
+    to key, using the sparse index. At most SNAPSHOT_INDEX_INTERVAL records have to be read from there.
+*/
+uint64_t SnapshotReader::seek_offset(int key) const{
+    // Last entry with a key smaller than key
+    uint64_t low = 0;
+    uint64_t high = index_entries;
+    while(low < high){
+        uint64_t middle = (low + high) / 2;
+        SnapshotIndexEntry entry;
+        memcpy(&entry, index + middle * sizeof(entry), sizeof(entry));
+        if(entry.key < key){
+            low = middle + 1;
+        }else{
+            high = middle;
+        }
+    }
+
+    if(low == 0){
+        return sizeof(SnapshotHeader);
+    }
+    SnapshotIndexEntry entry;
+    memcpy(&entry, index + (low - 1) * sizeof(entry), sizeof(entry));
+    return entry.offset;
+}
+
+/**
+    Returns the next record. The value points into the mapped file and is valid until close.
+    Returns false after the last record.
+*/
+bool SnapshotReader::next(int &key, const char* &value, uint32_t &length){
+    return read_record(cursor, key, value, length);
+}
+
+/**
+    Moves the cursor close before the first record with a key greater than or equal to key
+*/
+bool SnapshotReader::seek(int key){
+    if(header == NULL){
+        return false;
+    }
+    cursor = seek_offset(key);
+    return true;
+}
+
+/**
+    Returns false if the key is certainly not in the file, using the bloom filter if the file has one
+*/
+bool SnapshotReader::may_contain(int key) const{
+    if(bloom == NULL){
+        return header != NULL;
+    }
+    return bloom_test(bloom, bloom_bits, bloom_hashes, key);
+}
+
+/**
+    Looks up the value of key with the bloom filter and the sparse index. Returns false if the key is not in the file.
+*/
+bool SnapshotReader::get(int key, string &value) const{
+    if(!may_contain(key)){
+        return false;
+    }
+
+    uint64_t offset = seek_offset(key);
+    int record_key;
+    const char *record_value;
+    uint32_t length;
+    while(read_record(offset, record_key, record_value, length) && record_key <= key){
+        if(record_key == key){
+            value.assign(record_value, length);
+            return true;
+        }
+    }
+    return false;
+}
+
+SnapshotReader::~SnapshotReader(){
+    close();
+}
@@ -0,0 +1,113 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+    Binary snapshot format of a skip list.
+
+    Header | records | sparse index | footer
+    - Header: magic, format version, flags, number of records, offset of the sparse index.
+    - Records, sorted by key: key (int32), value length (uint32), value bytes.
+    - Sparse index: number of entries (uint64), then the key and file offset of every SNAPSHOT_INDEX_INTERVAL-th record.
+    - Bloom filter, if the SNAPSHOT_FLAG_BLOOM flag is set: number of bits (uint64), number of hashes (uint32),
+      reserved (uint32), the bits.
+    - Footer: checksum (uint64) of everything between the header and the footer.
+    Integers are stored in the byte order of the machine.
+*/
+
+#define SNAPSHOT_MAGIC "SKIPLST1"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_INDEX_INTERVAL 64
+
+// The file has a bloom filter of its keys after the sparse index
+#define SNAPSHOT_FLAG_BLOOM 1
+
+struct SnapshotHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t record_count;
+    uint64_t index_offset;
+};
+
+struct SnapshotIndexEntry{
+    int32_t key;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+struct SnapshotBloomHeader{
+    uint64_t bit_count;
+    uint32_t hash_count;
+    uint32_t reserved;
+};
+
+uint64_t snapshot_checksum(const char *data, size_t length, uint64_t checksum);
+
+/**
+    Streams sorted records into a snapshot file
+*/
+class SnapshotWriter{
+    private:
+        FILE *file;
+        uint64_t offset;
+        uint64_t record_count;
+        uint64_t checksum;
+        vector<SnapshotIndexEntry> index;
+
+        // Keys of the bloom filter, written by finish. No filter if bloom_bits_per_key is 0.
+        int bloom_bits_per_key;
+        vector<int> bloom_keys;
+
+        bool write(const void *data, size_t length);
+    public:
+        SnapshotWriter();
+        ~SnapshotWriter();
+        bool open(const string &path);
+        void enable_bloom_filter(int bits_per_key);
+        bool append(int key, const string &value);
+        bool finish();
+};
+
+/**
+    Maps a snapshot file into memory, validates it and reads its records.
+    next and seek move a cursor and are used by one thread; may_contain and get can be called from many threads.
+*/
+class SnapshotReader{
+    private:
+        int fd;
+        const char *data;
+        size_t size;
+        const SnapshotHeader *header;
+
+        // Sparse index and bloom filter inside the mapped file
+        const char *index;
+        uint64_t index_entries;
+        const unsigned char *bloom;
+        uint64_t bloom_bits;
+        uint32_t bloom_hashes;
+
+        // Offset of the next record returned by next
+        uint64_t cursor;
+
+        bool read_record(uint64_t &offset, int &key, const char* &value, uint32_t &length) const;
+        uint64_t seek_offset(int key) const;
+    public:
+        SnapshotReader();
+        ~SnapshotReader();
+        bool open(const string &path);
+        void close();
+        uint64_t record_count();
+        bool next(int &key, const char* &value, uint32_t &length);
+        bool seek(int key);
+        bool may_contain(int key) const;
+        bool get(int key, string &value) const;
+};
+
+#endif
@@ -0,0 +1,369 @@
+/**
+    One block of front coded string keys in the string skip list and its properties
+*/
+
+#include <string.h>
+#include "string_block.h"
+
+/**
+    Decodes the keys of a block in order.
+    Readers decode blocks which a writer may be changing, so every length is checked against the block, and a
+    decoder which runs off it stops. The reader then finds the version of the block changed and reads it again.
+*/
+struct KeyDecoder{
+    StringBlock *block;
+
+    // Position of the next key to decode, and its offset
+    int position;
+    int offset;
+
+    // The key last decoded
+    string key;
+
+    // Bytes of the block copied so far, each word of the block is loaded once
+    char bytes[STRING_BLOCK_BYTES];
+    int copied;
+
+    KeyDecoder(StringBlock *b){
+        block = b;
+        position = 0;
+        offset = 0;
+        copied = 0;
+    }
+
+    /**
+        Copies the bytes of the block up to end, which must lie within the block, and returns them
+    */
+    const char* fetch(int end){
+        while(copied < end){
+            uint64_t word = block->bytes[copied / 8].load(memory_order_acquire);
+            memcpy(bytes + copied, &word, 8);
+            copied += 8;
+        }
+        return bytes;
+    }
+
+    /**
+        Decodes the keys up to the one at target, which is then in key.
+        Returns false if the bytes of the block are inconsistent.
+    */
+    bool seek(int target){
+        while(position <= target){
+            if(offset + 4 > STRING_BLOCK_BYTES){
+                return false;
+            }
+            uint16_t shared, rest;
+            fetch(offset + 4);
+            memcpy(&shared, bytes + offset, 2);
+            memcpy(&rest, bytes + offset + 2, 2);
+            if(shared == STRING_KEY_OUT_OF_LINE){
+                const string *long_key = block->long_key(position);
+                if(long_key == NULL){
+                    return false;
+                }
+                key = *long_key;
+                offset += 4;
+                position++;
+                continue;
+            }
+            if(shared > key.size() || offset + 4 + rest > STRING_BLOCK_BYTES){
+                return false;
+            }
+            fetch(offset + 4 + rest);
+            key.resize(shared);
+            key.append(bytes + offset + 4, rest);
+            offset += 4 + rest;
+            position++;
+        }
+        return true;
+    }
+};
+
+/**
+    Packs the 8 bytes of key from start into an integer, big endian and padded with zeros, and stores the number
+    of bytes of the key it holds in length
+*/
+static uint64_t abbreviate(const string &key, size_t start, uint8_t &length){
+    uint64_t abbreviation = 0;
+    for (size_t i = start; i < start + 8; i++){
+        abbreviation = (abbreviation << 8) | (i < key.size() ? (unsigned char) key[i] : 0);
+    }
+    length = key.size() > start ? min(key.size() - start, (size_t) 8) : 0;
+    return abbreviation;
+}
+
+/**
+    Returns the number of bytes shared at the start of a and b
+*/
+static size_t shared_length(const string &a, const string &b){
+    size_t length = 0;
+    while(length < a.size() && length < b.size() && a[length] == b[length]){
+        length++;
+    }
+    return length;
+}
+
+/**
+    Constructor
+*/
+StringBlock::StringBlock(const string &l, int level) : low(l){
+    prefix_length = 0;
+    used_bytes = 0;
+    for (int i = 0; i < STRING_BLOCK_CAPACITY; i++){
+        abbreviations[i].store(0, memory_order_relaxed);
+        abbreviated_lengths[i].store(0, memory_order_relaxed);
+        values[i].store(NULL, memory_order_relaxed);
+    }
+    for (int i = 0; i < STRING_BLOCK_BYTES / 8; i++){
+        bytes[i].store(0, memory_order_relaxed);
+    }
+    prefix_length.store(0, memory_order_relaxed);
+    long_keys.store(NULL, memory_order_relaxed);
+    count.store(0, memory_order_relaxed);
+    removed.store(false, memory_order_relaxed);
+    version.store(0, memory_order_relaxed);
+    next = new atomic<StringBlock*>[level + 1];
+    for (int i = 0; i <= level; i++){
+        next[i].store(NULL, memory_order_relaxed);
+    }
+    top_level = level;
+}
+
+/**
+    Returns the number of bytes the keys from start to end (exclusive) take once front coded
+*/
+int StringBlock::encoded_size(const vector<string> &keys, int start, int end){
+    int size = 0;
+    for (int i = start; i < end; i++){
+        if(keys[i].size() > STRING_KEY_MAX){
+            size += 4;
+            continue;
+        }
+        size_t shared = i > start ? shared_length(keys[i - 1], keys[i]) : 0;
+        size += 4 + (int) (keys[i].size() - shared);
+    }
+    return size;
+}
+
+/**
+    Returns the keys of the block in order. A reader gets fewer keys if the block changes meanwhile.
+*/
+vector<string> StringBlock::keys(){
+    vector<string> block_keys;
+    KeyDecoder decoder(this);
+    int n = min(max(count.load(memory_order_acquire), 0), STRING_BLOCK_CAPACITY);
+    for (int i = 0; i < n && decoder.seek(i); i++){
+        block_keys.push_back(decoder.key);
+    }
+    return block_keys;
+}
+
+/**
+    Returns the key at position if it is stored out of line, else NULL
+*/
+string* StringBlock::long_key(int position){
+    atomic<string*> *keys = long_keys.load(memory_order_acquire);
+    return keys != NULL ? keys[position].load(memory_order_acquire) : NULL;
+}
+
+
+/**
+    Replaces the contents of the block with the keys and values from start to end (exclusive), which must fit.
+    long_keys holds the strings of the keys longer than STRING_KEY_MAX and NULL for the others.
+    Called by a writer holding the lock of the block, between begin_write and end_write if it is reachable.
+    The keys are encoded apart, then stored a word at a time.
+*/
+void StringBlock::assign(const vector<string> &keys, string * const *stored_values, string * const *stored_long_keys,
+        int start, int end){
+    atomic<string*> *block_long_keys = long_keys.load(memory_order_relaxed);
+    for (int i = start; i < end && block_long_keys == NULL; i++){
+        if(stored_long_keys[i] != NULL){
+            block_long_keys = new atomic<string*>[STRING_BLOCK_CAPACITY];
+            for (int j = 0; j < STRING_BLOCK_CAPACITY; j++){
+                block_long_keys[j].store(NULL, memory_order_relaxed);
+            }
+            long_keys.store(block_long_keys, memory_order_release);
+        }
+    }
+
+    int n = end - start;
+    int prefix = n > 0 ? (int) shared_length(keys[start], keys[end - 1]) : 0;
+    count.store(n, memory_order_release);
+    prefix_length.store(prefix, memory_order_release);
+
+    char encoded[STRING_BLOCK_BYTES] = {0};
+    int offset = 0;
+    for (int i = start; i < end; i++){
+        const string &key = keys[i];
+        if(block_long_keys != NULL){
+            block_long_keys[i - start].store(stored_long_keys[i], memory_order_release);
+        }
+        uint16_t shared = i > start ? shared_length(keys[i - 1], key) : 0;
+        uint16_t rest = key.size() - shared;
+        if(key.size() > STRING_KEY_MAX){
+            shared = STRING_KEY_OUT_OF_LINE;
+            rest = 0;
+        }
+        memcpy(encoded + offset, &shared, 2);
+        memcpy(encoded + offset + 2, &rest, 2);
+        memcpy(encoded + offset + 4, key.data() + shared, rest);
+        offset += 4 + rest;
+
+        uint8_t length;
+        abbreviations[i - start].store(abbreviate(key, prefix, length), memory_order_release);
+        abbreviated_lengths[i - start].store(length, memory_order_release);
+        values[i - start].store(stored_values[i], memory_order_release);
+    }
+    used_bytes = offset;
+    for (int word = 0; word * 8 < offset; word++){
+        uint64_t value;
+        memcpy(&value, encoded + word * 8, 8);
+        bytes[word].store(value, memory_order_release);
+    }
+    for (int i = n; i < STRING_BLOCK_CAPACITY; i++){
+        values[i].store(NULL, memory_order_release);
+        if(block_long_keys != NULL){
+            block_long_keys[i].store(NULL, memory_order_release);
+        }
+    }
+}
+
+/**
+    Returns the number of keys in the block smaller than key, which is the position of key if present, and sets
+    found if it is. A key outside the prefix of the block is placed with one compare. Otherwise the abbreviations
+    are compared as integers, and keys are decoded only when an abbreviation ties with the one of key.
+    Without abbreviated, every key is decoded and compared in full.
+*/
+int StringBlock::lower_bound(const string &key, bool abbreviated, bool &found){
+    found = false;
+    int n = min(max(count.load(memory_order_acquire), 0), STRING_BLOCK_CAPACITY);
+    if(n == 0){
+        return 0;
+    }
+    KeyDecoder decoder(this);
+
+    if(!abbreviated){
+        for (int i = 0; i < n; i++){
+            if(!decoder.seek(i)){
+                return i;
+            }
+            int compared = decoder.key.compare(key);
+            if(compared >= 0){
+                found = compared == 0;
+                return i;
+            }
+        }
+        return n;
+    }
+
+    // The prefix is the start of the first key, which is stored whole in the bytes or out of line
+    uint16_t first_shared, first_length;
+    const char *first = decoder.fetch(4);
+    memcpy(&first_shared, first, 2);
+    memcpy(&first_length, first + 2, 2);
+    first += 4;
+    size_t first_size = min((int) first_length, STRING_BLOCK_BYTES - 4);
+    if(first_shared == STRING_KEY_OUT_OF_LINE){
+        const string *first_key = long_key(0);
+        if(first_key == NULL){
+            return 0;
+        }
+        first = first_key->data();
+        first_size = first_key->size();
+    }
+    size_t prefix = min((size_t) max(prefix_length.load(memory_order_acquire), 0), first_size);
+    if(first_shared != STRING_KEY_OUT_OF_LINE){
+        decoder.fetch(4 + min(key.size(), prefix));
+    }
+    int compared = memcmp(key.data(), first, min(key.size(), prefix));
+    if(compared < 0 || (compared == 0 && key.size() < prefix)){
+        return 0;
+    }
+    if(compared > 0){
+        return n;
+    }
+
+    uint8_t length;
+    uint64_t abbreviation = abbreviate(key, prefix, length);
+    for (int i = 0; i < n; i++){
+        uint64_t stored = abbreviations[i].load(memory_order_acquire);
+        if(stored != abbreviation){
+            if(stored > abbreviation){
+                return i;
+            }
+            continue;
+        }
+
+        // A key which ends within its abbreviation is smaller than the keys it is the start of
+        uint8_t stored_length = abbreviated_lengths[i].load(memory_order_acquire);
+        if(stored_length != length){
+            if(stored_length > length){
+                return i;
+            }
+            continue;
+        }
+        if(length < 8){
+            found = true;
+            return i;
+        }
+
+        // Both keys go on after their abbreviations, only the whole keys tell them apart
+        if(!decoder.seek(i)){
+            return i;
+        }
+        compared = decoder.key.compare(key);
+        if(compared >= 0){
+            found = compared == 0;
+            return i;
+        }
+    }
+    return n;
+}
+
+/**
+    Returns the next block at the given level
+*/
+StringBlock* StringBlock::get_next(int level){
+    return next[level].load(memory_order_acquire);
+}
+
+/**
+    Links the next block at the given level and publishes it to lock free readers
+*/
+void StringBlock::set_next(int level, StringBlock* block){
+    next[level].store(block, memory_order_release);
+}
+
+/**
+    Locks the block
+*/
+void StringBlock::lock(){
+    block_lock.lock();
+}
+
+/**
+    Unlocks the block
+*/
+void StringBlock::unlock(){
+    block_lock.unlock();
+}
+
+/**
+    Makes the version odd before modifying the block. Called with the lock of the block held.
+    The stores which follow are releases, so a reader which loads one of them loads this version or a later one.
+*/
+void StringBlock::begin_write(){
+    version.store(version.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/**
+    Makes the version even again once the block is modified
+*/
+void StringBlock::end_write(){
+    version.store(version.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+StringBlock::~StringBlock(){
+    delete[] next;
+    delete[] long_keys.load(memory_order_relaxed);
+}
@@ -0,0 +1,95 @@
+#ifndef STRING_BLOCK_H
+#define STRING_BLOCK_H
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+// Number of keys stored in one block
+#define STRING_BLOCK_CAPACITY 32
+
+// Bytes of front coded keys stored in one block
+#define STRING_BLOCK_BYTES 768
+
+// Longest key stored in the bytes of a block. A full block splits into halves which still have room for a key of
+// this length. Longer keys are stored out of line.
+#define STRING_KEY_MAX 128
+
+// Shared length marking a key stored out of line, whose rest is empty
+#define STRING_KEY_OUT_OF_LINE 0xFFFF
+
+/**
+    One block of the string skip list.
+    Level 0 of the string skip list is a linked list of blocks holding sorted string keys, the upper levels index
+    blocks by their low key. The keys are front coded: each one is stored as the number of bytes it shares with the
+    key before it and the bytes after them. A key longer than STRING_KEY_MAX only takes its lengths in the bytes,
+    and is kept whole in a string of its own. Each key also has its 8 bytes following the prefix common to the whole
+    block packed into an integer, so a lookup compares integers and decodes keys only when they tie.
+    Readers load the fields a writer changes while the writer stores them, so they are atomics, stored with release
+    and loaded with acquire like in the blocks of the unrolled skip list. The bytes are stored in words, which a
+    reader copies one at a time.
+*/
+class StringBlock{
+    public:
+        // Every key stored in the block is greater than or equal to low. Fixed when the block is created.
+        const string low;
+
+        // Number of leading bytes shared by every key of the block
+        atomic<int> prefix_length;
+
+        // The 8 bytes of each key after the prefix, big endian and padded with zeros, so that integer order is key order
+        atomic<uint64_t> abbreviations[STRING_BLOCK_CAPACITY];
+
+        // Number of bytes of the key in each abbreviation, less than 8 if the key ends within it
+        atomic<uint8_t> abbreviated_lengths[STRING_BLOCK_CAPACITY];
+
+        // Front coded keys: the shared length and the length of the rest in 2 bytes each, then the rest.
+        // Readers load them a word at a time. used_bytes is only used by writers.
+        atomic<uint64_t> bytes[STRING_BLOCK_BYTES / 8];
+        int used_bytes;
+
+        // Values are stored out of line, like in the unrolled skip list
+        atomic<string*> values[STRING_BLOCK_CAPACITY];
+
+        // Keys longer than STRING_KEY_MAX, NULL for the keys stored in the bytes. The array is allocated with the
+        // first such key, so blocks of short keys do not pay for it.
+        atomic<atomic<string*>*> long_keys;
+
+        // Number of keys used in the block
+        atomic<int> count;
+
+        // Set once the block is empty and being unlinked, like in the unrolled skip list
+        atomic<bool> removed;
+
+        // Even while the block is stable, odd while a writer modifies it or the next block at level 0
+        atomic<unsigned long long> version;
+
+        // Lock to lock the block when modifying it
+        mutex block_lock;
+
+        // Stores the reference of the next block until the top level of the block
+        atomic<StringBlock*> *next;
+
+        // The Maximum level until which the block is available
+        int top_level;
+
+        StringBlock(const string &low, int level);
+        ~StringBlock();
+        static int encoded_size(const vector<string> &keys, int start, int end);
+        vector<string> keys();
+        string* long_key(int position);
+        void assign(const vector<string> &keys, string * const *values, string * const *long_keys, int start, int end);
+        int lower_bound(const string &key, bool abbreviated, bool &found);
+        StringBlock* get_next(int level);
+        void set_next(int level, StringBlock* block);
+        void lock();
+        void unlock();
+        void begin_write();
+        void end_write();
+};
+
+#endif
@@ -0,0 +1,490 @@
+/**
+    Implements the Concurrent Skip list for string keys with insert, delete, search and range operations.
+
+    The layout and the concurrency are the ones of the unrolled skip list: level 0 is a linked list of blocks, a
+    block owns every key from its low key up to the low key of the next block, writers lock the block owning the
+    key and bump its version, and readers never lock but read a block again if its version changed.
+    Keys are stored front coded, so keys sharing long prefixes like URLs or paths take only the bytes after the
+    prefix they share with the key before them. A search does not decode keys one by one: it compares the key with
+    the prefix shared by the whole block once, then the next 8 bytes of every key as one integer compare, and only
+    decodes keys whose 8 bytes tie with the ones of the key. Keys longer than STRING_KEY_MAX are kept in strings of
+    their own, and the block only stores their lengths and their abbreviations.
+    A writer decodes the whole block, changes the keys and encodes them all again, so every add and remove costs the
+    size of the block and not of the key. A block splits when it runs out of keys or bytes, where the two halves take
+    the closest number of bytes. A block left empty is unlinked, and blocks, values and keys stored out of line are
+    freed through an epoch reclaimer, as in the unrolled skip list.
+*/
+
+#include <iostream>
+#include <math.h>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include "string_skip_list.h"
+
+/**
+    Reclaimer of the blocks, values and keys stored out of line removed from every string skip list. Never freed,
+    so that it outlives the skip lists.
+*/
+static EpochReclaimer* block_reclaimer(){
+    static EpochReclaimer *reclaimer = new EpochReclaimer();
+    return reclaimer;
+}
+
+/**
+    Frees a block retired once unlinked
+*/
+static void free_block(void *block, void *context){
+    delete (StringBlock*) block;
+}
+
+/**
+    Frees a value or a key stored out of line retired once removed
+*/
+static void free_string(void *value, void *context){
+    delete (string*) value;
+}
+
+/**
+    Constructor
+*/
+StringSkipList::StringSkipList(int max_elements, float prob, bool abbreviated_keys){
+    // The index holds blocks, which are at least half full
+    int max_blocks = max_elements / (STRING_BLOCK_CAPACITY / 2) + 1;
+    max_level = max_blocks > 1 ? (int) round(log(max_blocks) / log(1/prob)) : 0;
+    head = new StringBlock("", max_level);
+    abbreviated = abbreviated_keys;
+}
+
+/**
+    Randomly generates a number and increments level if number less than or equal to 0.5
+    Once more than 0.5, returns the level or available max level.
+    This decides until which level a new StringBlock is available.
+*/
+int StringSkipList::get_random_level() {
+    int l = 0;
+    while(static_cast <float> (rand()) / static_cast <float> (RAND_MAX) <= 0.5){
+        l++;
+    }
+    return l > max_level ? max_level : l;
+}
+
+/**
+    Descends the index and returns the last block at level 0 whose low key is not greater than key.
+    The block may have split since, the callers move right at level 0 if needed.
+*/
+StringBlock* StringSkipList::find_block(const string &key){
+    StringBlock *curr = head;
+
+    for (int level = max_level; level >= 0; level--){
+        StringBlock *next = curr->get_next(level);
+        while (next != NULL && next->low <= key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+    return curr;
+}
+
+/**
+    Finds the last block with a low key smaller than key at each level of the index
+*/
+void StringSkipList::find_index_predecessors(const string &key, vector<StringBlock*> &predecessors){
+    StringBlock *curr = head;
+
+    for (int level = max_level; level >= 0; level--){
+        StringBlock *next = curr->get_next(level);
+        while (next != NULL && next->low < key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+        predecessors[level] = curr;
+    }
+}
+
+/**
+    Links a block already published at level 0 into the index levels until its top level.
+    A predecessor stays valid as long as no other block was linked after it and it is not removed. Stops once the
+    block is removed, checked under its lock, which unlink_block also takes at each level.
+*/
+void StringSkipList::link_index(StringBlock* block){
+    vector<StringBlock*> preds(max_level + 1);
+
+    for (int level = 1; level <= block->top_level; level++){
+        while(true){
+            find_index_predecessors(block->low, preds);
+            StringBlock *pred = preds[level];
+
+            pred->lock();
+            StringBlock *succ = pred->get_next(level);
+
+            // Another block was linked after the predecessor, or the predecessor is being unlinked, try again
+            if(pred->removed.load(memory_order_relaxed) || (succ != NULL && succ->low < block->low)){
+                pred->unlock();
+                this_thread::yield();
+                continue;
+            }
+
+            block->lock();
+            bool removed = block->removed.load(memory_order_relaxed);
+            if(!removed){
+                block->next[level].store(succ, memory_order_relaxed);
+                pred->set_next(level, block);
+            }
+            block->unlock();
+            pred->unlock();
+            if(removed){
+                return;
+            }
+            break;
+        }
+    }
+}
+
+/**
+    Unlinks a block left empty by a remove, unless a key was added to it meanwhile, and retires it.
+    Level by level from the top, locks the predecessor and then the block, and unlinks the block if the predecessor
+    links it. Levels the block was never linked at are passed over, link_index does not link a removed block.
+*/
+void StringSkipList::unlink_block(StringBlock* block){
+    block->lock();
+    if(block->removed.load(memory_order_relaxed) || block->count.load(memory_order_relaxed) != 0){
+        block->unlock();
+        return;
+    }
+    block->begin_write();
+    block->removed.store(true, memory_order_release);
+    block->end_write();
+    block->unlock();
+
+    vector<StringBlock*> preds(max_level + 1);
+    for (int level = block->top_level; level >= 0; level--){
+        while(true){
+            find_index_predecessors(block->low, preds);
+            StringBlock *pred = preds[level];
+
+            pred->lock();
+            StringBlock *succ = pred->get_next(level);
+            if(pred->removed.load(memory_order_relaxed) || (succ != NULL && succ != block && succ->low < block->low)){
+                pred->unlock();
+                this_thread::yield();
+                continue;
+            }
+
+            if(succ == block){
+                block->lock();
+
+                // The predecessor now owns the keys of the block, readers of it must see the change
+                if(level == 0){
+                    pred->begin_write();
+                }
+                pred->set_next(level, block->get_next(level));
+                if(level == 0){
+                    pred->end_write();
+                }
+                block->unlock();
+            }
+            pred->unlock();
+            break;
+        }
+    }
+    block_reclaimer()->retire(block, free_block);
+}
+
+/**
+    Returns where to split keys which do not fit in one block: the position leaving at most STRING_BLOCK_CAPACITY
+    keys on both sides whose halves take the closest number of bytes. Keys take at most STRING_KEY_MAX bytes in
+    a block, so both halves fit.
+*/
+static int split_position(const vector<string> &keys){
+    int n = keys.size();
+    int best = -1;
+    int best_size = 0;
+    for (int i = max(1, n - STRING_BLOCK_CAPACITY); i <= min(n - 1, STRING_BLOCK_CAPACITY); i++){
+        int size = max(StringBlock::encoded_size(keys, 0, i), StringBlock::encoded_size(keys, i, n));
+        if(best == -1 || size < best_size){
+            best = i;
+            best_size = size;
+        }
+    }
+    return best;
+}
+
+/**
+    Inserts into the block owning the key using its lock. Splits the block if the key does not fit.
+    Return if already exists.
+*/
+bool StringSkipList::add(const string &key, string value) {
+    EpochGuard guard(block_reclaimer());
+    StringBlock *block = find_block(key);
+
+    while(true){
+        block->lock();
+
+        // The block is being unlinked, find the block owning the key again once it is
+        if(block->removed.load(memory_order_relaxed)){
+            block->unlock();
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        // The block split after it was found, move right
+        StringBlock *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block->unlock();
+            block = next;
+            continue;
+        }
+
+        bool found;
+        int position = block->lower_bound(key, abbreviated, found);
+        if(found){
+            block->unlock();
+            return false;
+        }
+
+        vector<string> keys = block->keys();
+        vector<string*> values;
+        vector<string*> long_keys;
+        for (int i = 0; i < block->count.load(memory_order_relaxed); i++){
+            values.push_back(block->values[i].load(memory_order_relaxed));
+            long_keys.push_back(block->long_key(i));
+        }
+        keys.insert(keys.begin() + position, key);
+        values.insert(values.begin() + position, new string(value));
+        long_keys.insert(long_keys.begin() + position, key.size() > STRING_KEY_MAX ? new string(key) : NULL);
+        int count = keys.size();
+
+        StringBlock *split = NULL;
+
+        block->begin_write();
+
+        if(count <= STRING_BLOCK_CAPACITY && StringBlock::encoded_size(keys, 0, count) <= STRING_BLOCK_BYTES){
+            block->assign(keys, values.data(), long_keys.data(), 0, count);
+        }else{
+            // Move the upper part into a new block and publish it at level 0
+            int half = split_position(keys);
+            split = new StringBlock(keys[half], get_random_level());
+            split->assign(keys, values.data(), long_keys.data(), half, count);
+            split->next[0].store(next, memory_order_relaxed);
+            block->set_next(0, split);
+            block->assign(keys, values.data(), long_keys.data(), 0, half);
+        }
+
+        block->end_write();
+        block->unlock();
+
+        if(split != NULL && split->top_level > 0){
+            link_index(split);
+        }
+        return true;
+    }
+}
+
+/**
+    Performs search to find if a key exists without taking any lock.
+    Return value if the key found, else return empty
+*/
+string StringSkipList::search(const string &key){
+    EpochGuard guard(block_reclaimer());
+    StringBlock *block = find_block(key);
+
+    while(true){
+        unsigned long long version = block->version.load(memory_order_acquire);
+
+        // A writer is modifying the block
+        if(version & 1){
+            this_thread::yield();
+            continue;
+        }
+
+        // The block is being unlinked, its predecessor is about to own the key
+        if(block->removed.load(memory_order_acquire)){
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        StringBlock *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block = next;
+            continue;
+        }
+
+        bool found;
+        int position = block->lower_bound(key, abbreviated, found);
+        string *value = found ? block->values[position].load(memory_order_acquire) : NULL;
+
+        // The block changed while it was read, read it again. The loads above are acquires, so this one is not
+        // moved before them.
+        if(block->version.load(memory_order_relaxed) != version){
+            continue;
+        }
+
+        // Values are only freed once no operation which may have loaded them, this one included, is running
+        return value != NULL ? *value : "";
+    }
+}
+
+/**
+    Deletes the key from the block owning it using its lock.
+    Return if key doesn't exist in the list. A block other than the head is unlinked once it becomes empty.
+*/
+bool StringSkipList::remove(const string &key){
+    EpochGuard guard(block_reclaimer());
+    StringBlock *block = find_block(key);
+
+    while(true){
+        block->lock();
+
+        if(block->removed.load(memory_order_relaxed)){
+            block->unlock();
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        StringBlock *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block->unlock();
+            block = next;
+            continue;
+        }
+
+        bool found;
+        int position = block->lower_bound(key, abbreviated, found);
+        if(!found){
+            block->unlock();
+            return false;
+        }
+
+        vector<string> keys = block->keys();
+        vector<string*> values;
+        vector<string*> long_keys;
+        for (int i = 0; i < block->count.load(memory_order_relaxed); i++){
+            values.push_back(block->values[i].load(memory_order_relaxed));
+            long_keys.push_back(block->long_key(i));
+        }
+        string *value = values[position];
+        string *long_key = long_keys[position];
+        keys.erase(keys.begin() + position);
+        values.erase(values.begin() + position);
+        long_keys.erase(long_keys.begin() + position);
+
+        block->begin_write();
+        block->assign(keys, values.data(), long_keys.data(), 0, keys.size());
+        block->end_write();
+        bool empty = block != head && keys.empty();
+        block->unlock();
+
+        // A concurrent search may still be reading the value and a key stored out of line
+        block_reclaimer()->retire(value, free_string);
+        if(long_key != NULL){
+            block_reclaimer()->retire(long_key, free_string);
+        }
+        if(empty){
+            unlink_block(block);
+        }
+        return true;
+    }
+}
+
+/**
+    Finds the block owning start_key and walks level 0 until a block starts after end_key.
+    Every block is decoded under its version and read again if it changed. A removed block is empty, the walk moves
+    on to the block after it.
+    Updates and returns the key value pairs in a map.
+*/
+map<string, string> StringSkipList::range(const string &start_key, const string &end_key){
+    map<string, string> range_output;
+
+    if(start_key > end_key){
+        return range_output;
+    }
+
+    EpochGuard guard(block_reclaimer());
+    StringBlock *block = find_block(start_key);
+    string *values[STRING_BLOCK_CAPACITY];
+
+    while(block != NULL && block->low <= end_key){
+        unsigned long long version = block->version.load(memory_order_acquire);
+        if(version & 1){
+            this_thread::yield();
+            continue;
+        }
+
+        vector<string> keys = block->keys();
+        for (size_t i = 0; i < keys.size(); i++){
+            values[i] = block->values[i].load(memory_order_acquire);
+        }
+        StringBlock *next = block->get_next(0);
+
+        if(block->version.load(memory_order_relaxed) != version){
+            continue;
+        }
+
+        for (size_t i = 0; i < keys.size(); i++){
+            if(keys[i] >= start_key && keys[i] <= end_key){
+                range_output.insert(make_pair(keys[i], *values[i]));
+            }
+        }
+        block = next;
+    }
+
+    return range_output;
+}
+
+/**
+    Returns the bytes taken by the blocks and their keys, keys stored out of line included and values left out.
+    Called while no writer runs.
+*/
+long long StringSkipList::memory_usage(){
+    long long bytes = 0;
+    StringBlock *block = head;
+    while (block != NULL){
+        bytes += sizeof(StringBlock) + (block->top_level + 1) * sizeof(atomic<StringBlock*>);
+
+        // Low keys longer than the inline buffer of the string are allocated apart
+        if(block->low.capacity() > 15){
+            bytes += block->low.capacity() + 1;
+        }
+        if(block->long_keys.load() != NULL){
+            bytes += STRING_BLOCK_CAPACITY * sizeof(atomic<string*>);
+        }
+        for (int i = 0; i < block->count.load(); i++){
+            if(block->long_key(i) != NULL){
+                bytes += sizeof(string) + block->long_key(i)->capacity() + 1;
+            }
+        }
+        block = block->get_next(0);
+    }
+    return bytes;
+}
+
+/**
+    Display the blocks at level 0 in readable format
+*/
+void StringSkipList::display(){
+    StringBlock *block = head;
+    while (block != NULL){
+        vector<string> keys = block->keys();
+        printf("[");
+        for (size_t i = 0; i < keys.size(); i++){
+            printf(i == 0 ? "%s" : " %s", keys[i].c_str());
+        }
+        printf("] -> ");
+        block = block->get_next(0);
+    }
+    cout << endl;
+    printf("---------- Display done! ----------\n\n");
+}
+
+StringSkipList::StringSkipList(){
+    head = NULL;
+    max_level = 0;
+    abbreviated = true;
+}
+
+StringSkipList::~StringSkipList(){
+}
@@ -0,0 +1,44 @@
+#ifndef STRING_SKIP_LIST_H
+#define STRING_SKIP_LIST_H
+
+#include <map>
+#include <vector>
+#include "string_block.h"
+#include "epoch.h"
+
+/**
+    Skip list for string keys whose level 0 is made of blocks of front coded keys with abbreviated prefixes.
+    Laid out like the unrolled skip list: a level 0 hop skips a whole block, and the keys of a block are searched
+    by comparing their abbreviations as integers.
+*/
+class StringSkipList{
+    private:
+        // First block of the skip list, its low key is the empty string and it is available at every level
+        StringBlock *head;
+
+        // The Maximum level of the index
+        int max_level;
+
+        // Whether blocks are searched with the abbreviated keys, or by comparing whole keys
+        bool abbreviated;
+
+        StringBlock* find_block(const string &key);
+        void find_index_predecessors(const string &key, vector<StringBlock*> &predecessors);
+        void link_index(StringBlock* block);
+        void unlink_block(StringBlock* block);
+    public:
+        StringSkipList();
+        StringSkipList(int max_elements, float probability, bool abbreviated = true);
+        ~StringSkipList();
+        int get_random_level();
+
+        // Supported operations
+        bool add(const string &key, string value);
+        string search(const string &key);
+        bool remove(const string &key);
+        map<string, string> range(const string &start_key, const string &end_key);
+        long long memory_usage();
+        void display();
+};
+
+#endif
@@ -0,0 +1,135 @@
+/**
+	Unit test 10 for the counting bloom filter of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+vector<int> numbers_delete;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+
+    // generating delete data
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if( rand() % 3 == 0 ){
+            numbers_delete.push_back(numbers_insert[i]);
+        }
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_delete.size()) end = numbers_delete.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.remove(numbers_delete[i]);
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Performs the insert and delete opetations on a skiplist with a filter and checks that no key is missed
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 10 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-20000) are inserted into a skip list with a counting bloom" << endl;
+    cout << "filter parallelly and a few numbers at random are removed parallelly. Every number is then looked up," << endl;
+    cout << "and lookups of missing numbers are checked to skip the traversal." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 20000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.filter_counters_per_key = 10;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+
+    run_chunks(skiplist_add, numbers_insert.size());
+    run_chunks(skiplist_remove, numbers_delete.size());
+
+    // no false negatives, with search and multi_get
+    map<int, string> range_output = skiplist.range(1, max_number);
+    vector<int> keys;
+    for(int key = 1; key <= max_number; key++){
+        keys.push_back(key);
+    }
+    vector<string> values;
+    skiplist.multi_get(keys, values);
+
+    bool valid = true;
+    for(int key = 1; key <= max_number; key++){
+        string expected = range_output.count(key) ? to_string(key) : "";
+        if(skiplist.search(key) != expected || values[key - 1] != expected){
+            valid = false;
+        }
+    }
+    if(valid){
+        cout << "Unit Test 1: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Search: FAIL" << endl;
+    }
+
+    // lookups of keys never inserted rarely traverse the skip list
+    long long searches = skiplist.stats().searches;
+    for(int key = max_number + 1; key <= 2 * max_number; key++){
+        skiplist.search(key);
+    }
+    long long traversals = skiplist.stats().searches - searches;
+    if(traversals < max_number / 20){
+        cout << "Unit Test 2: Filter: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Filter: FAIL" << endl;
+    }
+
+    // removed keys leave the filter, and can be inserted again
+    skiplist.remove_range(1, 1000);
+    skiplist.add(500, "500");
+    if(skiplist.search(500) == "500" && skiplist.search(501) == "" && skiplist.count(1, 1000) == -1){
+        cout << "Unit Test 3: Remove range: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Remove range: FAIL" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+	Unit test 11 for the hash index of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// Set by a search which returned the value of another key
+atomic<bool> wrong_value(false);
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+vector<int> numbers_delete;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+
+    // generating delete data
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if( rand() % 3 == 0 ){
+            numbers_delete.push_back(numbers_insert[i]);
+        }
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_delete.size()) end = numbers_delete.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.remove(numbers_delete[i]);
+    }
+}
+
+void skiplist_search(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        string value = skiplist.search(numbers_insert[i]);
+        if(value != "" && value != to_string(numbers_insert[i])){
+            wrong_value = true;
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size, vector<thread> &threads){
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+}
+
+/**
+    Performs the insert, delete and search opetations on a skiplist with a hash index
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 11 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-20000) are inserted into a skip list with a hash index" << endl;
+    cout << "parallelly, then a few numbers at random are removed parallelly while other threads search." << endl;
+    cout << "Search through the hash index is checked against range, which uses the towers." << endl;
+    cout << "Removed nodes must be freed, but not while an iterator may still reach them." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 20000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.hash_index = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+
+    vector<thread> threads;
+    run_chunks(skiplist_add, numbers_insert.size(), threads);
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    run_chunks(skiplist_remove, numbers_delete.size(), threads);
+    run_chunks(skiplist_search, numbers_insert.size(), threads);
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    if(!wrong_value){
+        cout << "Unit Test 1: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Search: FAIL" << endl;
+    }
+
+    // the hash index agrees with the towers, without traversing them
+    long long searches = skiplist.stats().searches;
+    map<int, string> range_output = skiplist.range(1, max_number);
+    vector<int> keys;
+    for(int key = 1; key <= max_number; key++){
+        keys.push_back(key);
+    }
+    vector<string> values;
+    skiplist.multi_get(keys, values);
+
+    bool valid = skiplist.stats().searches == searches;
+    for(int key = 1; key <= max_number; key++){
+        string expected = range_output.count(key) ? to_string(key) : "";
+        if(skiplist.search(key) != expected || values[key - 1] != expected){
+            valid = false;
+        }
+    }
+    if(valid){
+        cout << "Unit Test 2: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Search: FAIL" << endl;
+    }
+
+    // keys removed by a range delete leave the hash index and can be inserted again
+    skiplist.remove_range(1, 1000);
+    skiplist.add(500, "500");
+    if(skiplist.search(500) == "500" && skiplist.search(501) == "" && skiplist.search(1001) == range_output[1001]){
+        cout << "Unit Test 3: Remove range: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Remove range: FAIL" << endl;
+    }
+
+    // Removed nodes are freed, except while an iterator may still reach them
+    EpochReclaimer *reclaimer = node_reclaimer();
+    reclaimer->reclaim();
+    reclaimer->reclaim();
+    bool freed = reclaimer->retired_count() == 0;
+    bool held = false;
+    {
+        ReverseIterator it = skiplist.rbegin();
+        long long removed = skiplist.remove_range(2001, 3000);
+        reclaimer->reclaim();
+        reclaimer->reclaim();
+        held = removed > 0 && reclaimer->retired_count() >= removed && it.valid();
+    }
+    reclaimer->reclaim();
+    reclaimer->reclaim();
+    if(freed && held && reclaimer->retired_count() == 0 && skiplist.search(2500) == "" && skiplist.search(3001) == range_output[3001]){
+        cout << "Unit Test 4: Reclamation: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Reclamation: FAIL" << endl;
+    }
+
+    return 0;
+}
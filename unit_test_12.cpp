@@ -0,0 +1,133 @@
+/**
+	Unit test 12 for the keys with a time to live of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// Time to live of the odd numbers
+#define TTL_MS 200
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+/**
+    Inserts the odd numbers with a time to live and the even numbers without one
+*/
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        int key = numbers_insert[i];
+        skiplist.add(key, to_string(key), key % 2 == 1 ? TTL_MS : 0);
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Inserts keys with and without a time to live and checks that they expire
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 12 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted into the skip list parallelly, the odd" << endl;
+    cout << "numbers with a time to live of 200 ms. The odd numbers are checked to disappear once it has passed," << endl;
+    cout << "and the reaper is checked to delete expired numbers in the background." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    if(skiplist.search(1) == "1" && skiplist.search(2) == "2" && (int) skiplist.range(1, max_number).size() == max_number){
+        cout << "Unit Test 1: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Search: FAIL" << endl;
+    }
+
+    this_thread::sleep_for(chrono::milliseconds(TTL_MS + 50));
+
+    // expired keys are invisible at once, without any delete
+    map<int, string> range_output = skiplist.range(1, max_number);
+    bool valid = (int) range_output.size() == max_number / 2;
+    for (auto const& x : range_output){
+        if(x.first % 2 == 1){
+            valid = false;
+        }
+    }
+    if(valid && skiplist.search(3) == "" && skiplist.search(4) == "4" && !skiplist.remove(5)){
+        cout << "Unit Test 2: Expiry: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Expiry: FAIL" << endl;
+    }
+
+    // the range walk above deleted the expired nodes it passed over
+    skiplist.remove_expired();
+    if(skiplist.stats().element_count == max_number / 2){
+        cout << "Unit Test 3: Remove expired: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Remove expired: FAIL" << endl;
+    }
+
+    // an expired key can be inserted again, and a key inserted without a time to live stays
+    skiplist.add(7, "7", 20);
+    this_thread::sleep_for(chrono::milliseconds(50));
+    if(skiplist.add(7, "seven") && skiplist.search(7) == "seven"){
+        cout << "Unit Test 4: Insert: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Insert: FAIL" << endl;
+    }
+
+    // the reaper deletes expired keys nobody looks at
+    skiplist.start_reaper(10);
+    for(int key = max_number + 1; key <= 2 * max_number; key++){
+        skiplist.add(key, to_string(key), 20);
+    }
+    this_thread::sleep_for(chrono::milliseconds(200));
+    skiplist.stop_reaper();
+    if(skiplist.stats().element_count == max_number / 2 + 1){
+        cout << "Unit Test 5: Reaper: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Reaper: FAIL" << endl;
+    }
+
+    return 0;
+}
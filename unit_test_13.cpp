@@ -0,0 +1,124 @@
+/**
+	Unit test 13 for the bounded cache mode of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// Capacity of the bounded skip lists
+#define CAPACITY 1000
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], string(100, 'v'));
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Inserts more keys than a bounded skip list can hold and checks the evictions
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 13 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into skip lists bounded" << endl;
+    cout << "to 1000 elements and to a number of bytes, which must stay close to their budget. Keys which are looked" << endl;
+    cout << "up must survive the eviction of keys which are not." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.cache_max_elements = CAPACITY;
+    skiplist = SkipList(CAPACITY, 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    // Each thread checks the budget once every 16 of its inserts
+    long long count = skiplist.stats().element_count;
+    if(count <= CAPACITY + 16 * (long long) num_threads && count + skiplist.evictions() == max_number){
+        cout << "Unit Test 1: Capacity: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Capacity: FAIL" << endl;
+    }
+
+    options = SkipListOptions();
+    options.cache_max_bytes = 200 * CAPACITY;
+    skiplist = SkipList(CAPACITY, 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    long long node_bytes = skiplist.stats().node_bytes;
+    if(node_bytes <= 200 * CAPACITY + 16 * (long long) num_threads * 400 && skiplist.evictions() > 0){
+        cout << "Unit Test 2: Byte budget: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Byte budget: FAIL" << endl;
+    }
+
+    // The keys 1 to 100 are looked up, then 500 new keys take the place of keys which were not
+    options = SkipListOptions();
+    options.cache_max_elements = CAPACITY;
+    skiplist = SkipList(CAPACITY, 0.5, options);
+    for(int key = 1; key <= CAPACITY; key++){
+        skiplist.add(key, to_string(key));
+    }
+    for(int key = 1; key <= 100; key++){
+        skiplist.search(key);
+    }
+    for(int key = CAPACITY + 1; key <= CAPACITY + 500; key++){
+        skiplist.add(key, to_string(key));
+    }
+
+    bool valid = skiplist.evictions() >= 500;
+    for(int key = 1; key <= 100; key++){
+        if(skiplist.search(key) != to_string(key)){
+            valid = false;
+        }
+    }
+    if(valid){
+        cout << "Unit Test 3: Eviction: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Eviction: FAIL" << endl;
+    }
+
+    return 0;
+}
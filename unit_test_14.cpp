@@ -0,0 +1,145 @@
+/**
+	Unit test 14 for the priority queue operations of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+// Keys popped by each thread, in the order they were popped
+vector<vector<int>> popped;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Pops until the skip list is empty, exactly or relaxed
+*/
+void skiplist_pop(size_t thread_index, bool relaxed){
+    int key;
+    string value;
+    while(relaxed ? skiplist.pop_min_relaxed(key, value, num_threads) : skiplist.pop_min(key, value)){
+        if(value == to_string(key)){
+            popped[thread_index].push_back(key);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Pops every key with all the threads. Returns true if every key was popped exactly once.
+*/
+bool pop_all(bool relaxed){
+    popped.assign(num_threads, vector<int>());
+    vector<thread> threads;
+    for(size_t i = 0; i < num_threads; i++){
+        threads.push_back(thread(skiplist_pop, i, relaxed));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    vector<int> all;
+    for(size_t i = 0; i < num_threads; i++){
+        all.insert(all.end(), popped[i].begin(), popped[i].end());
+    }
+    sort(all.begin(), all.end());
+    return all == numbers_insert;
+}
+
+/**
+    Pops every key exactly and relaxed, and checks that each key comes out once
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 14 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted into the skip list parallelly, and" << endl;
+    cout << "popped parallelly with pop_min and with pop_min_relaxed. Every number must be popped once, in increasing" << endl;
+    cout << "order by each thread for pop_min, and near the smallest number for pop_min_relaxed." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    int key;
+    string value;
+    if(skiplist.peek_min(key, value) && key == 1 && value == "1" && skiplist.peek_min_relaxed(key, value, num_threads) && key < max_number / 10){
+        cout << "Unit Test 1: Peek: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Peek: FAIL" << endl;
+    }
+
+    bool valid = pop_all(false);
+    for(size_t i = 0; i < num_threads; i++){
+        if(!is_sorted(popped[i].begin(), popped[i].end())){
+            valid = false;
+        }
+    }
+    if(valid && !skiplist.pop_min(key, value) && !skiplist.peek_min(key, value)){
+        cout << "Unit Test 2: Pop: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Pop: FAIL" << endl;
+    }
+
+    // A relaxed pop takes one of the first keys, far from the largest ones
+    run_chunks(skiplist_add, numbers_insert.size());
+    valid = true;
+    for(int i = 0; i < 100; i++){
+        if(!skiplist.pop_min_relaxed(key, value, num_threads) || key > max_number / 10){
+            valid = false;
+        }
+        skiplist.add(key, value);
+    }
+    if(valid && pop_all(true) && !skiplist.pop_min_relaxed(key, value, num_threads)){
+        cout << "Unit Test 3: Relaxed pop: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Relaxed pop: FAIL" << endl;
+    }
+
+    return 0;
+}
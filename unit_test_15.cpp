@@ -0,0 +1,151 @@
+/**
+	Unit test 15 for the split and concatenation of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Returns true if list holds exactly the keys from first to last, with their values, ranks and count
+*/
+bool holds(SkipList &list, int first, int last){
+    map<int, string> range_output = list.range(numeric_limits<int>::min() + 1, numeric_limits<int>::max() - 1);
+    if((int) range_output.size() != last - first + 1 || list.stats().element_count != last - first + 1){
+        return false;
+    }
+    int expected = first;
+    for (auto const& x : range_output){
+        if(x.first != expected || x.second != to_string(expected)){
+            return false;
+        }
+        expected++;
+    }
+
+    int key;
+    string value;
+    if(list.count(first, last) != last - first + 1 || !list.select(last - first, key, value) || key != last){
+        return false;
+    }
+    return list.rank(first + (last - first) / 2) == (last - first) / 2;
+}
+
+/**
+    Splits a skip list in two, checks both parts and concatenates them again
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 15 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into an indexable skip list," << endl;
+    cout << "which is split at 5001 and concatenated again. Both parts must hold their keys with the right ranks." << endl;
+    cout << "Then a skip list which is not indexable is split, with estimated statistics." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.indexable = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+    skiplist.repair_spans();
+
+    SkipList upper;
+    if(skiplist.split_at(5001, upper) && holds(skiplist, 1, 5000) && holds(upper, 5001, max_number) && skiplist.search(5001) == "" && upper.search(5000) == ""){
+        cout << "Unit Test 1: Split: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Split: FAIL" << endl;
+    }
+
+    // Both parts keep working on their own
+    SkipList lower = skiplist;
+    skiplist = upper;
+    numbers_insert.clear();
+    generate_input(max_number + 100);
+    numbers_insert.erase(numbers_insert.begin(), numbers_insert.begin() + max_number);
+    run_chunks(skiplist_add, numbers_insert.size());
+    skiplist.repair_spans();
+    if(lower.remove(5000) && lower.add(5000, "5000") && holds(upper, 5001, max_number + 100) && holds(lower, 1, 5000)){
+        cout << "Unit Test 2: Insert after split: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Insert after split: FAIL" << endl;
+    }
+
+    if(!upper.concat(lower) && lower.concat(upper) && holds(lower, 1, max_number + 100) && upper.range(1, max_number + 100).empty() && upper.stats().element_count == 0 && upper.add(1, "1") && holds(upper, 1, 1)){
+        cout << "Unit Test 3: Concat: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Concat: FAIL" << endl;
+    }
+
+    options = SkipListOptions();
+    options.hash_index = true;
+    SkipList hashed(100, 0.5, options);
+    if(!hashed.split_at(50, upper) && !lower.split_at(50, upper)){
+        cout << "Unit Test 4: Unsupported: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Unsupported: FAIL" << endl;
+    }
+
+    // Without spans, the statistics of the upper part are estimated, and nothing is lost
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    numbers_insert.clear();
+    generate_input(max_number);
+    run_chunks(skiplist_add, numbers_insert.size());
+    SkipList estimated;
+    long long upper_count = skiplist.split_at(5001, estimated) ? estimated.stats().element_count : -1;
+    bool split = estimated.range(1, max_number).size() == 5000 && skiplist.range(1, max_number).size() == 5000;
+    if(split && upper_count > 2500 && upper_count < 7500
+        && upper_count + skiplist.stats().element_count == max_number){
+        cout << "Unit Test 5: Split statistics: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Split statistics: FAIL" << endl;
+    }
+
+    return 0;
+}
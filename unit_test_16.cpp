@@ -0,0 +1,202 @@
+/**
+	Unit test 16 for the lazy index of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the even numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 0){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Returns true if every key from first to last is found with its value, and range returns exactly them
+*/
+bool holds(int first, int last){
+    for (int key = first; key <= last; key++){
+        if(skiplist.search(key) != to_string(key)){
+            return false;
+        }
+    }
+    map<int, string> range_output = skiplist.range(first, last);
+    return (int) range_output.size() == last - first + 1 && range_output.begin()->first == first;
+}
+
+/**
+    Returns the average number of nodes visited by a search of every key
+*/
+double average_path_length(SkipList &list, int max_number){
+    SkipListStats before = list.stats();
+    for (int key = 1; key <= max_number; key++){
+        list.search(key);
+    }
+    SkipListStats after = list.stats();
+    return double(after.search_path_length - before.search_path_length) / (after.searches - before.searches);
+}
+
+/**
+    Inserts the keys from 1 to max_number in one thread, then deletes the odd ones if remove_odd, with the levels
+    drawn from the given seed, so that two skip lists built alike have the same towers
+*/
+void build_sequentially(SkipList &list, int max_number, unsigned int seed, bool remove_odd){
+    srand(seed);
+    for (int key = 1; key <= max_number; key++){
+        list.add(key, to_string(key));
+    }
+    for (int key = 1; remove_odd && key <= max_number; key += 2){
+        list.remove(key);
+    }
+}
+
+/**
+    Returns true if a skip list with a lazy index, once built, has exactly the towers of one without an index:
+    every search visits the same nodes in both
+*/
+bool same_towers(SkipListOptions options, int max_number, bool remove_odd){
+    SkipList lazy(max_number, 0.5, options);
+    SkipList eager(max_number, 0.5);
+    build_sequentially(lazy, max_number, 16, remove_odd);
+    build_sequentially(eager, max_number, 16, remove_odd);
+    lazy.build_index();
+    bool same = average_path_length(lazy, max_number) == average_path_length(eager, max_number);
+    lazy.destroy();
+    eager.destroy();
+    return same;
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 16 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into a skip list with a lazy index," << endl;
+    cout << "which is then built. Every key must be found before and after, and the searches must then take the same paths" << endl;
+    cout << "as without an index. Deleted nodes are unlinked by the index too." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.lazy_index = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    if(holds(1, max_number)){
+        cout << "Unit Test 1: Search before index: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Search before index: FAIL" << endl;
+    }
+
+    skiplist.build_index();
+    if(skiplist.build_index() == 0 && holds(1, max_number) && same_towers(options, max_number, false)){
+        cout << "Unit Test 2: Build index: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Build index: FAIL" << endl;
+    }
+
+    // Keys removed while only part of their towers is linked
+    bool removed = true;
+    for (int key = max_number + 1; key <= max_number + 100; key++){
+        removed = removed && skiplist.add(key, to_string(key));
+    }
+    for (int key = max_number + 1; key <= max_number + 100; key += 2){
+        removed = removed && skiplist.remove(key);
+    }
+    skiplist.build_index();
+    for (int key = max_number + 1; key <= max_number + 100; key++){
+        removed = removed && skiplist.search(key) == (key % 2 == 0 ? to_string(key) : "");
+    }
+    if(removed && skiplist.stats().element_count == max_number + 50 && same_towers(options, max_number, true)){
+        cout << "Unit Test 3: Remove before index: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Remove before index: FAIL" << endl;
+    }
+
+    // A key deleted and inserted again before the maintenance unlinked its node
+    bool reinserted = true;
+    for (int key = max_number + 1; key <= max_number + 100; key += 2){
+        reinserted = reinserted && skiplist.add(key, "old") && skiplist.remove(key) && skiplist.add(key, to_string(key));
+    }
+    if(reinserted && holds(max_number + 1, max_number + 100) && skiplist.stats().element_count == max_number + 100){
+        cout << "Unit Test 4: Insert after delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Insert after delete: FAIL" << endl;
+    }
+
+    // The maintenance thread raises the nodes of the inserts running meanwhile, and unlinks those of the deletes
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    skiplist.start_index_maintenance(1);
+    run_chunks(skiplist_add, numbers_insert.size());
+    bool inserted = holds(1, max_number);
+    run_chunks(skiplist_remove, numbers_insert.size());
+    skiplist.stop_index_maintenance();
+    skiplist.build_index();
+    bool deleted = skiplist.range(1, max_number).size() == (size_t) max_number / 2;
+    for (int key = 1; key <= max_number; key++){
+        deleted = deleted && skiplist.search(key) == (key % 2 == 0 ? "" : to_string(key));
+    }
+    if(inserted && deleted && skiplist.build_index() == 0){
+        cout << "Unit Test 5: Index maintenance: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Index maintenance: FAIL" << endl;
+    }
+
+    return 0;
+}
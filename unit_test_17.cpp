@@ -0,0 +1,140 @@
+/**
+	Unit test 17 for the descending scans of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the multiples of 3
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 3 == 0){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Returns true if walking list from its largest key down gives exactly the keys of range, in reverse
+*/
+bool walks_back(SkipList &list){
+    map<int, string> range_output = list.range(numeric_limits<int>::min() + 1, numeric_limits<int>::max() - 1);
+    auto expected = range_output.rbegin();
+    for (ReverseIterator it = list.rbegin(); it.valid(); it.next()){
+        if(expected == range_output.rend() || it.key() != expected->first || it.value() != expected->second){
+            return false;
+        }
+        expected++;
+    }
+    return expected == range_output.rend();
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 17 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into the skip list and the" << endl;
+    cout << "multiples of 3 deleted parallelly. The descending scans must return the keys left in reverse order." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    run_chunks(skiplist_add, numbers_insert.size());
+    run_chunks(skiplist_remove, numbers_insert.size());
+
+    if(walks_back(skiplist)){
+        cout << "Unit Test 1: Reverse iteration: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Reverse iteration: FAIL" << endl;
+    }
+
+    // The keys left between 100 and 200, from 200 down
+    vector<pair<int, string>> reverse_output = skiplist.reverse_range(200, 100);
+    bool reversed = reverse_output.size() == 68 && reverse_output.front().first == 200 && reverse_output.back().first == 100;
+    for (size_t i = 1; reversed && i < reverse_output.size(); i++){
+        reversed = reverse_output[i].first < reverse_output[i - 1].first && reverse_output[i].first % 3 != 0;
+    }
+    if(reversed){
+        cout << "Unit Test 2: Reverse range: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Reverse range: FAIL" << endl;
+    }
+
+    vector<pair<int, string>> latest = skiplist.range_limit(1, 300, 3, true);
+    vector<pair<int, string>> earliest = skiplist.range_limit(300, max_number, 3);
+    ReverseIterator before = skiplist.rbegin(300);
+    if(latest.size() == 3 && latest[0].first == 299 && latest[1].first == 298 && latest[2].first == 296 && latest[2].second == "296"
+        && earliest.size() == 3 && earliest[0].first == 301 && earliest[2].first == 304
+        && before.valid() && before.key() == 299 && skiplist.range_limit(0, 0, 3, true).empty()){
+        cout << "Unit Test 3: Range limit: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Range limit: FAIL" << endl;
+    }
+
+    // remove_range, split_at and concat relink level 0 in other ways
+    skiplist.remove_range(5000, 6000);
+    SkipList upper;
+    bool relinked = skiplist.split_at(8000, upper) && walks_back(skiplist) && walks_back(upper) && upper.rbegin(7999).valid() == false;
+    relinked = relinked && skiplist.concat(upper) && walks_back(skiplist) && walks_back(upper);
+    if(relinked && skiplist.rbegin().key() == max_number){
+        cout << "Unit Test 4: Remove range, split and concat: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Remove range, split and concat: FAIL" << endl;
+    }
+
+    return 0;
+}
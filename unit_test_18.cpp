@@ -0,0 +1,136 @@
+/**
+	Unit test 18 for the paginated range of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the odd numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 1){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 18 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into the skip list and read back" << endl;
+    cout << "in pages of 128 keys, while the odd numbers are deleted parallelly. The pages must not overlap or skip keys." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    // Every page but the last is full, and together they hold the whole range
+    RangeCursor cursor;
+    map<int, string> page = skiplist.range(1001, 3000, 128, cursor);
+    map<int, string> pages = page;
+    size_t count = 1;
+    bool full = true;
+    while(!cursor.done){
+        full = full && page.size() == 128;
+        page = skiplist.range(cursor, 128);
+        pages.insert(page.begin(), page.end());
+        count++;
+    }
+    if(full && count == 16 && pages == skiplist.range(1001, 3000) && skiplist.range(cursor, 128).empty()){
+        cout << "Unit Test 1: Pages: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Pages: FAIL" << endl;
+    }
+
+    // Paging while keys are deleted: every even key exactly once, in order
+    thread remover(run_chunks, skiplist_remove, numbers_insert.size());
+    int last = 0;
+    int evens = 0;
+    bool ordered = true;
+    page = skiplist.range(1, max_number, 100, cursor);
+    while(true){
+        for (auto const& x : page){
+            ordered = ordered && x.first > last;
+            last = x.first;
+            evens += x.first % 2 == 0 ? 1 : 0;
+        }
+        if(cursor.done){
+            break;
+        }
+        page = skiplist.range(cursor, 100);
+    }
+    remover.join();
+    if(ordered && evens == max_number / 2){
+        cout << "Unit Test 2: Pages with deletes: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Pages with deletes: FAIL" << endl;
+    }
+
+    // The cursor still resumes after its last key is deleted
+    page = skiplist.range(1, max_number, 10, cursor);
+    skiplist.remove(page.rbegin()->first);
+    page = skiplist.range(cursor, 10);
+    if(page.begin()->first == 22 && page.size() == 10 && skiplist.range(5, 4, 10, cursor).empty() && cursor.done){
+        cout << "Unit Test 3: Resume after delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Resume after delete: FAIL" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+	Unit test 19 for the parallel range scans of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the odd numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 1){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 19 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into the skip list and scanned by" << endl;
+    cout << "up to 8 threads at once, while the odd numbers are deleted parallelly. The parts must hold every key once." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    // The parts are appended in order and hold the same keys as range
+    map<int, string> range_output = skiplist.range(1001, 9000);
+    vector<pair<int, string>> parallel_output = skiplist.parallel_range(1001, 9000, 8);
+    if(map<int, string>(parallel_output.begin(), parallel_output.end()) == range_output && is_sorted(parallel_output.begin(), parallel_output.end())
+        && skiplist.parallel_range(5, 4, 8).empty() && skiplist.parallel_range(7, 7, 8).size() == 1){
+        cout << "Unit Test 1: Parallel range: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Parallel range: FAIL" << endl;
+    }
+
+    // A reduction with one accumulator per part, over parts of about the same size
+    vector<long long> counts(8), sums(8);
+    int parts = skiplist.parallel_scan(1, max_number, 8, [&counts, &sums](int part, int key, const string &value){
+        counts[part]++;
+        sums[part] += key;
+    });
+    long long count = 0, sum = 0;
+    bool balanced = true;
+    for (int i = 0; i < parts; i++){
+        count += counts[i];
+        sum += sums[i];
+        balanced = balanced && counts[i] > max_number / parts / 4;
+    }
+    if(parts == 8 && balanced && count == max_number && sum == (long long) max_number * (max_number + 1) / 2){
+        cout << "Unit Test 2: Parallel reduction: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Parallel reduction: FAIL" << endl;
+    }
+
+    // Scanning while keys are deleted: every even key exactly once, in order within each part
+    thread remover(run_chunks, skiplist_remove, numbers_insert.size());
+    vector<int> lasts(8, 0), evens(8, 0);
+    vector<int> ordered(8, 1);
+    parts = skiplist.parallel_scan(1, max_number, 8, [&lasts, &evens, &ordered](int part, int key, const string &value){
+        ordered[part] = ordered[part] && key > lasts[part] && value == to_string(key);
+        lasts[part] = key;
+        evens[part] += key % 2 == 0 ? 1 : 0;
+    });
+    remover.join();
+    int even_count = 0;
+    bool in_order = true;
+    for (int i = 0; i < parts; i++){
+        even_count += evens[i];
+        in_order = in_order && ordered[i];
+    }
+    if(in_order && even_count == max_number / 2 && skiplist.parallel_range(1, max_number, 8).size() == (size_t) max_number / 2){
+        cout << "Unit Test 3: Parallel scan with deletes: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Parallel scan with deletes: FAIL" << endl;
+    }
+
+    return 0;
+}
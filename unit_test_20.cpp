@@ -0,0 +1,172 @@
+/**
+	Unit test 20 for the range aggregation of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <limits>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the odd numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 1){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+double value_of(int key, const string &value){
+    return stod(value);
+}
+
+double sum(double a, double b){
+    return a + b;
+}
+
+double maximum(double a, double b){
+    return max(a, b);
+}
+
+/**
+    Returns true if the aggregate of every one of count intervals matches the fold of range over it
+*/
+bool matches_range(int max_number, int count){
+    for (int i = 0; i < count; i++){
+        int start = rand() % (max_number + 10) - 5;
+        int end = start + rand() % (max_number / 4);
+        double total = -1;
+        if(!skiplist.aggregate(start, end, total)){
+            return false;
+        }
+        double expected = 0;
+        for (auto const& x : skiplist.range(start, end)){
+            expected += stod(x.second);
+        }
+        if(total != expected){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 20 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into a skip list which sums its values" << endl;
+    cout << "over every link. The sums of random intervals must match the ones of range, also after parallel deletes." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.aggregate.measure = value_of;
+    options.aggregate.combine = sum;
+    options.aggregate.identity = 0;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+
+    double total = -1, empty = -1;
+    if(skiplist.aggregate(1, max_number, total) && total == (double) max_number * (max_number + 1) / 2
+        && skiplist.aggregate(5, 4, empty) && empty == 0 && matches_range(max_number, 200)){
+        cout << "Unit Test 1: Sum: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Sum: FAIL" << endl;
+    }
+
+    // Deletes flag the links over the deleted nodes, and remove_range the whole skip list
+    run_chunks(skiplist_remove, numbers_insert.size());
+    bool removed = matches_range(max_number, 200);
+    skiplist.remove_range(2001, 3000);
+    skiplist.add(2500, "2500");
+    if(removed && matches_range(max_number, 200) && skiplist.aggregate(2001, 3000, total) && total == 2500){
+        cout << "Unit Test 2: Sum after deletes: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Sum after deletes: FAIL" << endl;
+    }
+
+    // Aggregates read while the writers run are exact once they are done
+    thread adder(run_chunks, skiplist_add, numbers_insert.size());
+    for (int i = 0; i < 100; i++){
+        skiplist.aggregate(1, max_number, total);
+    }
+    adder.join();
+    if(matches_range(max_number, 200) && skiplist.aggregate(1, max_number, total) && total == (double) max_number * (max_number + 1) / 2){
+        cout << "Unit Test 3: Sum with concurrent inserts: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Sum with concurrent inserts: FAIL" << endl;
+    }
+
+    // A maximum, with a lazy index raising the nodes after the aggregates were first computed
+    options.aggregate.combine = maximum;
+    options.aggregate.identity = -numeric_limits<double>::infinity();
+    options.lazy_index = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+    double before = 0, after = 0, none = 0;
+    skiplist.aggregate(1, 5000, before);
+    skiplist.build_index();
+    skiplist.remove(5000);
+    skiplist.aggregate(1, 5000, after);
+    skiplist.aggregate(max_number + 1, max_number + 100, none);
+    if(before == 5000 && after == 4999 && none == options.aggregate.identity){
+        cout << "Unit Test 4: Maximum: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Maximum: FAIL" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+	Unit test 21 for the multimap mode of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the odd numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 1){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Adds the number as a second value of its key
+*/
+void skiplist_add_again(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], "again " + to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Appends ten values to the key of the number in one batch
+*/
+void skiplist_add_all(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        vector<string> values;
+        for (int j = 0; j < 10; j++){
+            values.push_back(to_string(j));
+        }
+        skiplist.add_all(numbers_insert[i] % 100, values);
+    }
+}
+
+double value_count(int key, const string &value){
+    return 1;
+}
+
+double sum(double a, double b){
+    return a + b;
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 21 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly into a multimap twice, with two values" << endl;
+    cout << "per key, and values are deleted one at a time and by key. Batches of ten values are appended parallelly and" << endl;
+    cout << "counted with an aggregate." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    SkipListOptions options;
+    options.multimap = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+    run_chunks(skiplist_add_again, numbers_insert.size());
+
+    // Both values of every key, oldest first, and the oldest one for search and range
+    bool ordered = true;
+    for (int key = 1; key <= max_number; key++){
+        vector<string> values = skiplist.equal_range(key);
+        ordered = ordered && values.size() == 2 && values[0] == to_string(key) && values[1] == "again " + to_string(key);
+    }
+    map<int, string> range_output = skiplist.range(1, max_number);
+    if(ordered && skiplist.search(7) == "7" && range_output.size() == (size_t) max_number && range_output[9] == "9"
+        && skiplist.parallel_range(1, max_number, 4).size() == 2 * (size_t) max_number){
+        cout << "Unit Test 1: Duplicate keys: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Duplicate keys: FAIL" << endl;
+    }
+
+    // remove_one deletes the matching value only, remove_all every value of the key
+    bool one = skiplist.remove_one(5, "again 5") && !skiplist.remove_one(5, "again 5") && skiplist.equal_range(5) == vector<string>{"5"};
+    bool oldest = skiplist.remove_one(6, "6") && skiplist.search(6) == "again 6";
+    bool all = skiplist.remove_all(8) == 2 && skiplist.equal_range(8).empty() && skiplist.remove_all(8) == 0;
+    if(one && oldest && all && skiplist.stats().element_count == 2 * max_number - 4){
+        cout << "Unit Test 2: Remove one and all: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Remove one and all: FAIL" << endl;
+    }
+
+    // Batches for the same keys from many threads stay whole, and each key keeps its first value in front
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    for (int key = 0; key < 100; key++){
+        skiplist.add(key, "first");
+    }
+    run_chunks(skiplist_add_all, 1000);
+    bool batches = true;
+    for (int key = 0; key < 100; key++){
+        vector<string> values = skiplist.equal_range(key);
+        batches = batches && values.size() == 101 && values[0] == "first";
+        for (size_t i = 1; batches && i < values.size(); i++){
+            batches = values[i] == to_string((i - 1) % 10);
+        }
+    }
+    if(batches && skiplist.stats().element_count == 100 * 101){
+        cout << "Unit Test 3: Append batches: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Append batches: FAIL" << endl;
+    }
+
+    // Deleting values one at a time while others are appended
+    thread adder(run_chunks, skiplist_add_all, 1000);
+    long long removed = 0;
+    for (int key = 0; key < 100; key++){
+        for (int j = 0; j < 10; j++){
+            removed += skiplist.remove_one(key, to_string(j)) ? 1 : 0;
+        }
+    }
+    adder.join();
+    size_t total = 0;
+    for (int key = 0; key < 100; key++){
+        total += skiplist.equal_range(key).size();
+    }
+    if(removed == 1000 && total == 100 * 191 && skiplist.remove_all(42) == 191){
+        cout << "Unit Test 4: Remove while appending: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Remove while appending: FAIL" << endl;
+    }
+
+    // Links over the values of one key fold every one of them
+    options.aggregate.measure = value_count;
+    options.aggregate.combine = sum;
+    options.aggregate.identity = 0;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add_all, 1000);
+    double count = 0, some = 0;
+    if(skiplist.aggregate(0, 99, count) && count == 10000 && skiplist.aggregate(10, 19, some) && some == 1000){
+        cout << "Unit Test 5: Aggregate of duplicates: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Aggregate of duplicates: FAIL" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+/**
+	Unit test 22 for the concurrent skip list for string keys
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "string_skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+StringSkipList skiplist;
+
+/**
+    URL like keys to be used for operations
+*/
+vector<string> keys_insert;
+
+/*
+    Generates URLs sharing long prefixes, many of them only told apart after the first 8 bytes of a path
+*/
+void generate_input(int max_number){
+    for(int i = 0; i < max_number; i++){
+        keys_insert.push_back("https://www.site" + to_string(i % 50) + ".com/articles/" + to_string(i / 50 % 20) + "/page-" + to_string(i));
+    }
+    random_shuffle(keys_insert.begin(), keys_insert.end());
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= keys_insert.size()) end = keys_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(keys_insert[i], to_string(i));
+    }
+}
+
+/**
+    Deletes the keys at odd positions
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= keys_insert.size()) end = keys_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(i % 2 == 1){
+            skiplist.remove(keys_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 22 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. URLs sharing long prefixes are inserted parallelly into the skip list for" << endl;
+    cout << "string keys, and half of them are removed parallelly while the others are searched. Keys which are prefixes" << endl;
+    cout << "of each other are compared with a std::set, and so are keys stored out of line for their length." << endl;
+    cout << "Finally every key is removed parallelly, unlinking the blocks left empty." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 20000;
+    generate_input(max_number);
+
+    skiplist = StringSkipList(keys_insert.size(), 0.5);
+    run_chunks(skiplist_add, keys_insert.size());
+
+    bool found = true;
+    for(size_t i = 0; i < keys_insert.size(); i++){
+        found = found && skiplist.search(keys_insert[i]) == to_string(i);
+    }
+    if(found && skiplist.search("https://www.site1.com/articles/") == "" && skiplist.search("") == ""){
+        cout << "Unit Test 1: Insert: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Insert: FAIL" << endl;
+    }
+
+    // Keys already present are refused, keys longer than STRING_KEY_MAX are stored out of line
+    string long_key(STRING_KEY_MAX + 1, 'x');
+    if(!skiplist.add(keys_insert[3], "again") && skiplist.search(keys_insert[3]) == "3" && skiplist.add(long_key, "long")
+        && skiplist.search(long_key) == "long" && !skiplist.add(long_key, "again") && skiplist.remove(long_key)
+        && skiplist.search(long_key) == ""){
+        cout << "Unit Test 2: Duplicate and long keys: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Duplicate and long keys: FAIL" << endl;
+    }
+
+    // Searching the kept keys while the others are deleted
+    thread remover(run_chunks, skiplist_remove, keys_insert.size());
+    bool kept = true;
+    for(size_t i = 0; i < keys_insert.size(); i += 2){
+        kept = kept && skiplist.search(keys_insert[i]) == to_string(i);
+    }
+    remover.join();
+    bool removed = true;
+    for(size_t i = 1; i < keys_insert.size(); i += 2){
+        removed = removed && skiplist.search(keys_insert[i]) == "";
+    }
+    if(kept && removed && !skiplist.remove(keys_insert[1])){
+        cout << "Unit Test 3: Delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Delete: FAIL" << endl;
+    }
+
+    // Range returns the kept keys in order
+    set<string> expected;
+    for(size_t i = 0; i < keys_insert.size(); i += 2){
+        if(keys_insert[i] >= "https://www.site1" && keys_insert[i] <= "https://www.site3"){
+            expected.insert(keys_insert[i]);
+        }
+    }
+    map<string, string> range_output = skiplist.range("https://www.site1", "https://www.site3");
+    bool same = range_output.size() == expected.size();
+    for (auto const& x : range_output){
+        same = same && expected.count(x.first) == 1;
+    }
+    if(same && skiplist.range("b", "a").empty()){
+        cout << "Unit Test 4: Range: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Range: FAIL" << endl;
+    }
+
+    // Keys which end within or right after their abbreviation, embedded zero bytes included, with and without
+    // abbreviated keys
+    vector<string> tricky = {"a", "ab", string("ab\0", 3), string("ab\0\0", 4), "abcdefgh", "abcdefghi", "abcdefghij",
+        "abcdefgg", "abcdefgh\xff", "b", "abcdefghij0123456789", "abcdefghij0123456788", "abcdefghj"};
+    for (int i = 0; i < 200; i++){
+        tricky.push_back("abcdefgh" + to_string(i));
+    }
+    bool ordered = true;
+    for (int abbreviated = 0; abbreviated <= 1; abbreviated++){
+        StringSkipList list(tricky.size(), 0.5, abbreviated);
+        set<string> reference;
+        for (size_t i = 0; i < tricky.size(); i++){
+            ordered = ordered && list.add(tricky[i], tricky[i]) == reference.insert(tricky[i]).second;
+        }
+        for (size_t i = 0; i < tricky.size(); i++){
+            ordered = ordered && list.search(tricky[i]) == tricky[i];
+        }
+        ordered = ordered && list.search("abcdefgh0000") == "" && list.search(string("ab\0\0\0", 5)) == "";
+        map<string, string> all = list.range("", "c");
+        ordered = ordered && all.size() == reference.size() && equal(reference.begin(), reference.end(), all.begin(),
+            [](const string &a, const pair<const string, string> &b){ return a == b.first; });
+    }
+    if(ordered){
+        cout << "Unit Test 5: Abbreviated keys: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Abbreviated keys: FAIL" << endl;
+    }
+
+    // Keys longer than STRING_KEY_MAX sharing long prefixes, among short keys, added and removed parallelly
+    vector<string> mixed;
+    string path = "https://www.site.com/" + string(STRING_KEY_MAX, 'p');
+    for (int i = 0; i < 3000; i++){
+        mixed.push_back(i % 3 == 0 ? "https://www.site.com/" + to_string(i) : path + "/" + to_string(i % 7) + string(i % 50, 'q') + to_string(i));
+    }
+    bool long_keys = true;
+    for (int abbreviated = 0; abbreviated <= 1; abbreviated++){
+        StringSkipList list(mixed.size(), 0.5, abbreviated);
+        vector<thread> threads;
+        for (int t = 0; t < 4; t++){
+            threads.push_back(thread([&list, &mixed, t](){
+                for (size_t i = t; i < mixed.size(); i += 4){
+                    list.add(mixed[i], to_string(i));
+                }
+                for (size_t i = t; i < mixed.size(); i += 4){
+                    if(i % 2 == 1){
+                        list.remove(mixed[i]);
+                    }
+                }
+            }));
+        }
+        for (auto &th : threads){
+            th.join();
+        }
+        set<string> reference;
+        for (size_t i = 0; i < mixed.size(); i++){
+            long_keys = long_keys && list.search(mixed[i]) == (i % 2 == 0 ? to_string(i) : "");
+            if(i % 2 == 0){
+                reference.insert(mixed[i]);
+            }
+        }
+        map<string, string> all = list.range("", "z");
+        long_keys = long_keys && all.size() == reference.size() && equal(reference.begin(), reference.end(), all.begin(),
+            [](const string &a, const pair<const string, string> &b){ return a == b.first; });
+    }
+    if(long_keys){
+        cout << "Unit Test 6: Long keys: PASS" << endl;
+    }else{
+        cout << "Unit Test 6: Long keys: FAIL" << endl;
+    }
+
+    // Removing every key parallelly, while other keys are added after them, unlinks the blocks left empty
+    vector<string> added;
+    for (int i = 0; i < 2000; i++){
+        added.push_back("https://www.site99.com/new/" + to_string(i));
+    }
+    thread adder([&added](){
+        for (size_t i = 0; i < added.size(); i++){
+            skiplist.add(added[i], "new");
+        }
+    });
+    vector<thread> removers;
+    for (int t = 0; t < 4; t++){
+        removers.push_back(thread([t](){
+            for (size_t i = t * 2; i < keys_insert.size(); i += 8){
+                skiplist.remove(keys_insert[i]);
+            }
+        }));
+    }
+    for (auto &th : removers){
+        th.join();
+    }
+    adder.join();
+    bool emptied = skiplist.range("", "z").size() == added.size() && skiplist.search(added[5]) == "new";
+    for (size_t i = 0; i < added.size(); i++){
+        emptied = emptied && skiplist.remove(added[i]);
+    }
+    emptied = emptied && skiplist.range("", "z").empty()
+        && skiplist.memory_usage() == StringSkipList(keys_insert.size(), 0.5).memory_usage();
+    skiplist.add(keys_insert[0], "again");
+    if(emptied && skiplist.search(keys_insert[0]) == "again"){
+        cout << "Unit Test 7: Empty blocks: PASS" << endl;
+    }else{
+        cout << "Unit Test 7: Empty blocks: FAIL" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+/**
+	Unit test 23 for the key-value separation of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <atomic>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// Length of the values
+#define VALUE_LENGTH 200
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+/**
+    Returns the value of the number after the given number of updates
+*/
+string make_value(int number, int version){
+    string value = to_string(number) + "-" + to_string(version) + "-";
+    return value + string(VALUE_LENGTH - value.size(), 'x');
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], make_value(numbers_insert[i], 0));
+    }
+}
+
+/**
+    Updates every number five times
+*/
+void skiplist_update(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for (int version = 1; version <= 5; version++){
+        for(size_t i = start; i < end; i++){
+            skiplist.update(numbers_insert[i], make_value(numbers_insert[i], version));
+        }
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Returns true if every number has the value of the given version
+*/
+bool check_values(int version){
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if(skiplist.search(numbers_insert[i]) != make_value(numbers_insert[i], version)){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 23 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted parallelly with values of 200 bytes stored in" << endl;
+    cout << "a value log, then updated parallelly five times and the dead values compacted, also while readers search." << endl;
+    cout << "Compaction then runs while four readers search without a pause." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    run_chunks(skiplist_add, numbers_insert.size());
+    long long inline_bytes = skiplist.stats().node_bytes;
+    bool no_log = !skiplist.update(1, "new");
+
+    SkipListOptions options;
+    options.value_log = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+    run_chunks(skiplist_add, numbers_insert.size());
+    long long live = 0, segments = 0;
+    skiplist.value_log_usage(live, segments);
+    if(no_log && check_values(0) && skiplist.stats().node_bytes < inline_bytes - (long long) max_number * (VALUE_LENGTH - 16)
+        && live == (long long) max_number * (VALUE_LENGTH + VALUE_LOG_RECORD_HEADER)){
+        cout << "Unit Test 1: Values in the log: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Values in the log: FAIL" << endl;
+    }
+
+    // Updates leave the live bytes as they were, and the replaced values dead
+    run_chunks(skiplist_update, numbers_insert.size());
+    long long updated_live = 0, updated_segments = 0;
+    skiplist.value_log_usage(updated_live, updated_segments);
+    if(check_values(5) && updated_live == live && updated_segments >= 5 * live && !skiplist.update(max_number + 1, "missing")){
+        cout << "Unit Test 2: Update: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Update: FAIL" << endl;
+    }
+
+    // Compaction frees the sealed segments and keeps every value
+    long long freed = skiplist.compact_values();
+    long long compacted_live = 0, compacted_segments = 0;
+    skiplist.value_log_usage(compacted_live, compacted_segments);
+    if(freed > 0 && compacted_segments < updated_segments && compacted_live == live && check_values(5)){
+        cout << "Unit Test 3: Compaction: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Compaction: FAIL" << endl;
+    }
+
+    // Readers always find a whole value of their key while updates and the background compaction run
+    atomic<bool> done(false);
+    atomic<int> torn(0);
+    thread reader([&]() {
+        while(!done){
+            for(int number = 1; number <= max_number; number += 7){
+                string value = skiplist.search(number);
+                if(value.size() != VALUE_LENGTH || value.compare(0, to_string(number).size() + 1, to_string(number) + "-") != 0){
+                    torn++;
+                }
+            }
+        }
+    });
+    skiplist.start_value_compaction(1);
+    run_chunks(skiplist_update, numbers_insert.size());
+    done = true;
+    reader.join();
+    skiplist.stop_value_compaction();
+    if(torn == 0 && check_values(5)){
+        cout << "Unit Test 4: Read while compacting: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Read while compacting: FAIL" << endl;
+    }
+
+    // Deleted keys give their value back, pop_min and range read values from the log
+    int key;
+    string value;
+    bool popped = skiplist.pop_min(key, value) && key == 1 && value == make_value(1, 5);
+    bool removed = skiplist.remove(2) && skiplist.search(2) == "" && !skiplist.update(2, "gone");
+    map<int, string> range_output = skiplist.range(3, 5);
+    skiplist.compact_values();
+    long long final_live = 0, final_segments = 0;
+    skiplist.value_log_usage(final_live, final_segments);
+    if(popped && removed && range_output.size() == 3 && range_output[4] == make_value(4, 5)
+        && final_live == live - 2 * (VALUE_LENGTH + VALUE_LOG_RECORD_HEADER)){
+        cout << "Unit Test 5: Delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Delete: FAIL" << endl;
+    }
+
+    // Compaction does not wait for a moment with no reader, readers never stop here until it is done
+    atomic<bool> compacted(false);
+    vector<thread> readers;
+    for (int i = 0; i < 4; i++){
+        readers.push_back(thread([&]() {
+            while(!compacted){
+                for(int number = 3; number <= max_number && !compacted; number++){
+                    skiplist.search(number);
+                }
+            }
+        }));
+    }
+    // The values of the first round fill sealed segments of this thread, and the second round leaves them dead
+    for (int version = 6; version <= 7; version++){
+        for(int number = 3; number <= max_number; number++){
+            skiplist.update(number, make_value(number, version));
+        }
+    }
+    long long busy_freed = skiplist.compact_values();
+    compacted = true;
+    for (auto &th : readers) {
+        th.join();
+    }
+    long long busy_live = 0, busy_segments = 0;
+    skiplist.value_log_usage(busy_live, busy_segments);
+    if(busy_freed > 0 && busy_live == final_live && skiplist.search(max_number) == make_value(max_number, 7)){
+        cout << "Unit Test 6: Compaction under readers: PASS" << endl;
+    }else{
+        cout << "Unit Test 6: Compaction under readers: FAIL" << endl;
+    }
+    skiplist.destroy();
+
+    return 0;
+}
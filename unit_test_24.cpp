@@ -0,0 +1,212 @@
+/**
+	Unit test 24 for the concurrent skip list shared between processes
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <thread>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "shared_skip_list.h"
+
+using namespace std;
+
+size_t num_processes = 4;
+size_t num_threads = 2;
+SharedSkipList skiplist;
+string region_name;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes the even numbers
+*/
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        if(numbers_insert[i] % 2 == 0){
+            skiplist.remove(numbers_insert[i]);
+        }
+    }
+}
+
+/**
+    Runs the function over a part of the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t start, size_t end){
+    vector<thread> threads;
+    int chunk_size = ceil(float(end - start) / num_threads);
+    for(size_t i = start; i < end; i = i + chunk_size){
+        threads.push_back(thread(function, i, min(i + chunk_size, end)));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Runs the function over the vector in processes which open the region by name, one part per process
+*/
+void run_processes(void (*function)(size_t, size_t)){
+    vector<pid_t> children;
+    int part_size = ceil(float(numbers_insert.size()) / num_processes);
+    for(size_t i = 0; i < numbers_insert.size(); i = i + part_size){
+        pid_t pid = fork();
+        if(pid == 0){
+            SharedSkipList child_list;
+            if(!child_list.open(region_name)){
+                _exit(1);
+            }
+            skiplist = child_list;
+            run_chunks(function, i, min(i + part_size, numbers_insert.size()));
+            skiplist.close();
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (size_t i = 0; i < children.size(); i++){
+        waitpid(children[i], NULL, 0);
+    }
+}
+
+/**
+    Main function
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 24 ----------" << endl;
+
+    cout << "\nThis Unit test uses 4 Processes of 2 Threads. Numbers (1-10000) are inserted into a skip list in shared memory" << endl;
+    cout << "by the processes, then the even ones deleted. Writers are then killed in the middle of their operations." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+
+    region_name = "/skiplist_unit_test_24_" + to_string(getpid());
+    SharedSkipList::remove_region(region_name);
+    if(!skiplist.create(region_name, 64 << 20, max_number, 0.5)){
+        cout << "Unit Test 1: Insert: FAIL" << endl;
+        return 1;
+    }
+
+    run_processes(skiplist_add);
+    bool inserted = true;
+    for(int number = 1; number <= max_number; number++){
+        inserted = inserted && skiplist.search(number) == to_string(number);
+    }
+    if(inserted && skiplist.range(1, max_number).size() == (size_t) max_number){
+        cout << "Unit Test 1: Insert: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Insert: FAIL" << endl;
+    }
+
+    run_processes(skiplist_remove);
+    bool removed = true;
+    for(int number = 1; number <= max_number; number++){
+        removed = removed && skiplist.search(number) == (number % 2 == 0 ? "" : to_string(number));
+    }
+    if(removed && skiplist.range(1, max_number).size() == (size_t) max_number / 2 && !skiplist.remove(2)){
+        cout << "Unit Test 2: Delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Delete: FAIL" << endl;
+    }
+
+    // This process searches while another one inserts
+    pid_t writer = fork();
+    if(writer == 0){
+        SharedSkipList child_list;
+        child_list.open(region_name);
+        for(int number = max_number + 1; number <= 2 * max_number; number++){
+            child_list.add(number, to_string(number));
+        }
+        _exit(0);
+    }
+    bool found = true;
+    for(int round = 0; round < 20; round++){
+        for(int number = 1; number <= max_number; number += 2){
+            found = found && skiplist.search(number) == to_string(number);
+        }
+    }
+    waitpid(writer, NULL, 0);
+    if(found && skiplist.range(max_number + 1, 2 * max_number).size() == (size_t) max_number){
+        cout << "Unit Test 3: Search while another process writes: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Search while another process writes: FAIL" << endl;
+    }
+
+    // Writers killed at random points, possibly holding node locks or halfway through linking or unlinking
+    int start_key = 3 * max_number, end_key = 3 * max_number + 100;
+    srand(24);
+    for(int round = 0; round < 50; round++){
+        pid_t victim = fork();
+        if(victim == 0){
+            SharedSkipList child_list;
+            child_list.open(region_name);
+            while(true){
+                for(int number = start_key; number < end_key; number++){
+                    if(!child_list.add(number, to_string(number))){
+                        child_list.remove(number);
+                    }
+                }
+            }
+        }
+        usleep(rand() % 3000);
+        kill(victim, SIGKILL);
+        waitpid(victim, NULL, 0);
+        skiplist.recover();
+    }
+
+    // Every key can be deleted and inserted again, and the keys outside stayed as they were
+    bool recovered = true;
+    for(int number = start_key; number < end_key; number++){
+        string value = skiplist.search(number);
+        recovered = recovered && (value == "" || value == to_string(number));
+        skiplist.remove(number);
+        recovered = recovered && skiplist.search(number) == "" && skiplist.add(number, to_string(number));
+    }
+    if(recovered && skiplist.range(start_key, end_key).size() == (size_t) (end_key - start_key)
+        && skiplist.range(1, 2 * max_number).size() == (size_t) max_number * 3 / 2){
+        cout << "Unit Test 4: Recovery after a writer died: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Recovery after a writer died: FAIL" << endl;
+    }
+
+    // Only one skip list per name, and opening needs an existing one
+    SharedSkipList other;
+    bool created = other.create(region_name, 1 << 20, 100, 0.5);
+    skiplist.close();
+    SharedSkipList::remove_region(region_name);
+    bool opened = other.open(region_name);
+    if(!created && !opened){
+        cout << "Unit Test 5: Create and open: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Create and open: FAIL" << endl;
+    }
+
+    return 0;
+}
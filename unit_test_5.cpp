@@ -0,0 +1,161 @@
+/**
+	Unit test 5 for the order statistics of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+vector<int> numbers_delete;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+
+    // generating delete data
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if( rand() % 3 == 0 ){
+            numbers_delete.push_back(numbers_insert[i]);
+        }
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_delete.size()) end = numbers_delete.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.remove(numbers_delete[i]);
+    }
+}
+
+/**
+    Checks rank, select and count against the keys returned by range
+*/
+bool check_order_statistics(int max_number){
+    map<int, string> range_output = skiplist.range(1, max_number);
+
+    if(skiplist.count(1, max_number) != (long long) range_output.size()){
+        return false;
+    }
+
+    long long k = 0;
+    for (auto const& x : range_output){
+        int key;
+        string value;
+        if(skiplist.rank(x.first) != k || !skiplist.select(k, key, value) || key != x.first || value != x.second){
+            return false;
+        }
+        k++;
+    }
+
+    int key;
+    string value;
+    return !skiplist.select(k, key, value);
+}
+
+/**
+    Performs the insert and delete opetations on an indexable skiplist and checks the order statistics
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 5 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-1000) are inserted into an indexable skip list by one thread," << endl;
+    cout << "then numbers (1001-5000) are inserted parallelly and a few numbers at random are removed parallelly." << endl;
+    cout << "Rank, select and count are checked after each step, once the spans are repaired." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    generate_input(5000);
+
+    SkipListOptions options;
+    options.indexable = true;
+    skiplist = SkipList(numbers_insert.size(), 0.5, options);
+
+    vector<thread> threads;
+    int chunk_size;
+
+    // a single writer keeps the spans exact
+    skiplist_add(0, 1000);
+
+    if(skiplist.rank(500) == 499 && skiplist.count(10, 20) == 11 && skiplist.count(1, 1000) == 1000){
+        cout << "Unit Test 1: Rank: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Rank: FAIL" << endl;
+    }
+
+    if(check_order_statistics(1000)){
+        cout << "Unit Test 2: Select: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Select: FAIL" << endl;
+    }
+
+    // parallel insert
+    chunk_size = ceil(float(numbers_insert.size() - 1000) / num_threads);
+    for(size_t i = 1000; i < numbers_insert.size(); i = i + chunk_size){
+        threads.push_back(thread(skiplist_add, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    skiplist.repair_spans();
+
+    if(skiplist.count(1, 5000) == 5000 && skiplist.rank(5000) == 4999){
+        cout << "Unit Test 3: Count: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Count: FAIL" << endl;
+    }
+
+    // parallel delete with the periodic repair running
+    skiplist.start_span_repair(1);
+    chunk_size = ceil(float(numbers_delete.size()) / num_threads);
+    for(size_t i = 0; i < numbers_delete.size(); i = i + chunk_size){
+        threads.push_back(thread(skiplist_remove, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+    skiplist.stop_span_repair();
+
+    skiplist.repair_spans();
+
+    if(skiplist.count(1, 5000) == (long long) (numbers_insert.size() - numbers_delete.size())){
+        cout << "Unit Test 4: Count: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Count: FAIL" << endl;
+    }
+
+    if(check_order_statistics(5000)){
+        cout << "Unit Test 5: Select: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Select: FAIL" << endl;
+    }
+
+    return 0;
+}
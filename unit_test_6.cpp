@@ -0,0 +1,141 @@
+/**
+	Unit test 6 for the range delete of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// Every window of 1000 keys starting at an even multiple of 1000 is deleted with remove_range
+int window = 1000;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Deletes one window with remove_range
+*/
+void skiplist_remove_range(int start, int end){
+    skiplist.remove_range(start, end);
+}
+
+/**
+    Deletes single keys of a window, racing with remove_range on the same keys
+*/
+void skiplist_remove(int start, int end){
+    for(int key = start; key <= end; key += 7){
+        skiplist.remove(key);
+    }
+}
+
+/**
+    Returns true if the key belongs to a deleted window
+*/
+bool in_deleted_window(int key){
+    return ((key / window) % 2) == 0;
+}
+
+/**
+    Performs range deletes racing with single deletes on the skiplist
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 6 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-20000) are inserted into the skip list parallelly." << endl;
+    cout << "Then windows of 1000 numbers are deleted with remove_range parallelly, while other threads delete" << endl;
+    cout << "single numbers of the same windows. Finally the skip list is cleared." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 20000;
+    generate_input(max_number);
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+
+    vector<thread> threads;
+
+    // insert
+    int chunk_size = ceil(float(numbers_insert.size()) / num_threads);
+    for(size_t i = 0; i < numbers_insert.size(); i = i + chunk_size){
+        threads.push_back(thread(skiplist_add, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    // range delete and single deletes of the same windows
+    for(int start = 0; start <= max_number; start += 2 * window){
+        threads.push_back(thread(skiplist_remove_range, start, start + window - 1));
+        threads.push_back(thread(skiplist_remove, start, start + window - 1));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    // checking that exactly the keys outside the windows are left
+    bool valid = true;
+    for(int key = 1; key <= max_number; key++){
+        bool present = skiplist.search(key) != "";
+        if(present == in_deleted_window(key)){
+            valid = false;
+        }
+    }
+    if(valid){
+        cout << "Unit Test 1: Remove range: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Remove range: FAIL" << endl;
+    }
+
+    map<int, string> range_output = skiplist.range(1, max_number);
+    if((long long) range_output.size() == skiplist.stats().element_count){
+        cout << "Unit Test 2: Remove range: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Remove range: FAIL" << endl;
+    }
+
+    // the deleted keys can be inserted again
+    skiplist.add(5, "5");
+    if(skiplist.search(5) == "5"){
+        cout << "Unit Test 3: Insert: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Insert: FAIL" << endl;
+    }
+
+    skiplist.clear();
+    if(skiplist.range(1, max_number).empty() && skiplist.stats().element_count == 0){
+        cout << "Unit Test 4: Clear: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Clear: FAIL" << endl;
+    }
+
+    return 0;
+}
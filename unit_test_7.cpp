@@ -0,0 +1,133 @@
+/**
+	Unit test 7 for the snapshot save and load of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// File used by the test, deleted at the end
+#define SNAPSHOT_FILE "unit_test_7_snapshot.bin"
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+/**
+    Returns true if the skip list holds exactly the keys of the given list
+*/
+bool same_keys(SkipList &list, int max_number){
+    map<int, string> expected = skiplist.range(1, max_number);
+    map<int, string> actual = list.range(1, max_number);
+    return expected == actual && (long long) actual.size() == list.stats().element_count;
+}
+
+/**
+    Saves the skiplist to a snapshot and loads it back
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 7 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-10000) are inserted into the skip list parallelly," << endl;
+    cout << "the skip list is saved to a snapshot file, and the file is loaded into empty and non empty skip lists." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 10000;
+    generate_input(max_number);
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+
+    vector<thread> threads;
+
+    // insert
+    int chunk_size = ceil(float(numbers_insert.size()) / num_threads);
+    for(size_t i = 0; i < numbers_insert.size(); i = i + chunk_size){
+        threads.push_back(thread(skiplist_add, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    threads.clear();
+
+    if(skiplist.save(SNAPSHOT_FILE)){
+        cout << "Unit Test 1: Save: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Save: FAIL" << endl;
+    }
+
+    // bulk build of an empty skip list
+    SkipList loaded(numbers_insert.size(), 0.5);
+    if(loaded.load(SNAPSHOT_FILE) && same_keys(loaded, max_number) && loaded.search(4321) == "4321"){
+        cout << "Unit Test 2: Load: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Load: FAIL" << endl;
+    }
+
+    // the loaded skip list accepts inserts and deletes
+    if(loaded.add(max_number + 1, "new") && loaded.remove(1) && loaded.search(1) == "" && loaded.search(max_number + 1) == "new"){
+        cout << "Unit Test 3: Insert and Delete: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Insert and Delete: FAIL" << endl;
+    }
+
+    // loading into a skip list which is not empty merges the keys
+    SkipList merged(numbers_insert.size(), 0.5);
+    merged.add(5, "5");
+    if(merged.load(SNAPSHOT_FILE) && same_keys(merged, max_number)){
+        cout << "Unit Test 4: Load: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Load: FAIL" << endl;
+    }
+
+    // an indexable skip list has exact spans after load
+    SkipListOptions options;
+    options.indexable = true;
+    SkipList indexed(numbers_insert.size(), 0.5, options);
+    if(indexed.load(SNAPSHOT_FILE) && indexed.rank(5000) == 4999 && indexed.count(1, max_number) == max_number){
+        cout << "Unit Test 5: Load: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Load: FAIL" << endl;
+    }
+
+    // a damaged file is rejected
+    FILE *file = fopen(SNAPSHOT_FILE, "r+b");
+    fseek(file, 100, SEEK_SET);
+    fputc('x', file);
+    fclose(file);
+    SkipList damaged(numbers_insert.size(), 0.5);
+    if(!damaged.load(SNAPSHOT_FILE) && !damaged.load("missing_snapshot.bin") && damaged.search(1) == ""){
+        cout << "Unit Test 6: Load: PASS" << endl;
+    }else{
+        cout << "Unit Test 6: Load: FAIL" << endl;
+    }
+
+    remove(SNAPSHOT_FILE);
+    return 0;
+}
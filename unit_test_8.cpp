@@ -0,0 +1,186 @@
+/**
+	Unit test 8 for the write-ahead log of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/resource.h>
+
+#include "skip_list.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+SkipList skiplist;
+
+// File used by the test, deleted at the end
+#define LOG_FILE "unit_test_8.wal"
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+vector<int> numbers_delete;
+
+/*
+    Generates input to test the skip list
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+
+    // generating delete data
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if( rand() % 3 == 0 ){
+            numbers_delete.push_back(numbers_insert[i]);
+        }
+    }
+}
+
+void skiplist_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void skiplist_remove(size_t start, size_t end){
+    if(end >= numbers_delete.size()) end = numbers_delete.size();
+    for(size_t i = start; i < end; i++){
+        skiplist.remove(numbers_delete[i]);
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Inserts and deletes parallelly with the log open in the given mode, then recovers the log into a new skip list.
+    Returns true if the recovered skip list has the same keys and values.
+*/
+bool check_recovery(WalMode mode, int max_number){
+    remove(LOG_FILE);
+    skiplist = SkipList(numbers_insert.size(), 0.5);
+    if(!skiplist.open_log(LOG_FILE, mode, 1)){
+        return false;
+    }
+
+    run_chunks(skiplist_add, numbers_insert.size());
+    run_chunks(skiplist_remove, numbers_delete.size());
+    skiplist.remove_range(100, 200);
+    skiplist.close_log();
+
+    SkipList recovered(numbers_insert.size(), 0.5);
+    bool valid = recovered.open_log(LOG_FILE, mode, 1);
+    recovered.close_log();
+    return valid && recovered.range(1, max_number) == skiplist.range(1, max_number);
+}
+
+/**
+    Performs the insert and delete opetations on a logged skiplist and recovers it from the log
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 8 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-5000) are inserted into a skip list with a write-ahead log" << endl;
+    cout << "parallelly and a few numbers at random are removed parallelly. The log is then replayed into a new" << endl;
+    cout << "skip list, once for each durability mode and once after a torn write at the end of the log." << endl;
+    cout << "Then the log fails to grow, and a log is opened while a background thread runs." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    int max_number = 5000;
+    generate_input(max_number);
+
+    if(check_recovery(WAL_SYNC, max_number)){
+        cout << "Unit Test 1: Recovery: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Recovery: FAIL" << endl;
+    }
+
+    if(check_recovery(WAL_PERIODIC, max_number)){
+        cout << "Unit Test 2: Recovery: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Recovery: FAIL" << endl;
+    }
+
+    if(check_recovery(WAL_ASYNC, max_number)){
+        cout << "Unit Test 3: Recovery: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Recovery: FAIL" << endl;
+    }
+
+    // a crash in the middle of a write leaves part of a record at the end of the log
+    FILE *file = fopen(LOG_FILE, "ab");
+    fwrite("\x01\x02\x03\x04\x01", 5, 1, file);
+    fclose(file);
+
+    SkipList recovered(numbers_insert.size(), 0.5);
+    bool valid = recovered.open_log(LOG_FILE, WAL_SYNC, 1);
+    valid = valid && recovered.range(1, max_number) == skiplist.range(1, max_number);
+
+    // records logged after the torn one are recovered as well
+    valid = valid && recovered.add(max_number + 1, "new");
+    recovered.close_log();
+    SkipList recovered_again(numbers_insert.size(), 0.5);
+    valid = valid && recovered_again.open_log(LOG_FILE, WAL_SYNC, 1) && recovered_again.search(max_number + 1) == "new";
+    recovered_again.close_log();
+
+    if(valid){
+        cout << "Unit Test 4: Recovery: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Recovery: FAIL" << endl;
+    }
+
+    // A log which may not grow fails, and stays failed, while the mutations still apply
+    remove(LOG_FILE);
+    SkipList failing(100, 0.5);
+    valid = failing.open_log(LOG_FILE, WAL_SYNC, 1) && failing.add(1, "1") && !failing.log_failed();
+    struct rlimit limit, small;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    small = limit;
+    small.rlim_cur = 4096;
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &small);
+    for (int key = 2; key <= 100; key++){
+        failing.add(key, string(100, 'x'));
+    }
+    setrlimit(RLIMIT_FSIZE, &limit);
+    valid = valid && failing.log_failed() && failing.search(100) != "";
+    failing.close_log();
+
+    // A log opened after a background thread started would miss the mutations of its copy of the skip list
+    SkipList reaped(100, 0.5);
+    reaped.start_reaper(10);
+    valid = valid && !reaped.open_log(LOG_FILE, WAL_SYNC, 1);
+    reaped.stop_reaper();
+    remove(LOG_FILE);
+    valid = valid && reaped.open_log(LOG_FILE, WAL_SYNC, 1);
+    reaped.close_log();
+
+    if(valid){
+        cout << "Unit Test 5: Log failure: PASS" << endl;
+    }else{
+        cout << "Unit Test 5: Log failure: FAIL" << endl;
+    }
+
+    remove(LOG_FILE);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+	Unit test 9 for the LSM memtable on top of the concurrent skip list data structure
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "memtable.h"
+
+using namespace std;
+
+size_t num_threads = 8;
+MemTable *memtable;
+
+/**
+    Integers to be used for operations
+*/
+vector<int> numbers_insert;
+vector<int> numbers_delete;
+
+/*
+    Generates input to test the memtable
+*/
+void generate_input(int max_number){
+    // generating insert data
+    for(int i = 1; i <= max_number; i++){
+        numbers_insert.push_back(i);
+    }
+
+    // generating delete data
+    for(size_t i = 0; i < numbers_insert.size(); i++){
+        if( rand() % 3 == 0 ){
+            numbers_delete.push_back(numbers_insert[i]);
+        }
+    }
+}
+
+void memtable_add(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i++){
+        memtable->add(numbers_insert[i], to_string(numbers_insert[i]));
+    }
+}
+
+void memtable_update(size_t start, size_t end){
+    if(end >= numbers_insert.size()) end = numbers_insert.size();
+    for(size_t i = start; i < end; i += 2){
+        memtable->add(numbers_insert[i], "new" + to_string(numbers_insert[i]));
+    }
+}
+
+void memtable_remove(size_t start, size_t end){
+    if(end >= numbers_delete.size()) end = numbers_delete.size();
+    for(size_t i = start; i < end; i++){
+        memtable->remove(numbers_delete[i]);
+    }
+}
+
+/**
+    Runs the function over the vector in chunks, one chunk per thread
+*/
+void run_chunks(void (*function)(size_t, size_t), size_t size){
+    vector<thread> threads;
+    int chunk_size = ceil(float(size) / num_threads);
+    for(size_t i = 0; i < size; i = i + chunk_size){
+        threads.push_back(thread(function, i, i+chunk_size));
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+/**
+    Checks that every key has its latest value and that deleted keys are not found
+*/
+bool check_values(){
+    vector<bool> deleted(numbers_insert.size() + 1, false);
+    for (size_t i = 0; i < numbers_delete.size(); i++){
+        deleted[numbers_delete[i]] = true;
+    }
+
+    for (size_t i = 0; i < numbers_insert.size(); i++){
+        int key = numbers_insert[i];
+        string expected = deleted[key] ? "" : (i % 2 == 0 ? "new" : "") + to_string(key);
+        if(memtable->search(key) != expected){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+    Performs the insert, update and delete opetations on a memtable which flushes to run files
+*/
+int main(int argc, char *argv[]){
+
+    cout << "\n---------- Unit Test - 9 ----------" << endl;
+
+    cout << "\nThis Unit test uses 8 Threads. Numbers (1-20000) are inserted into a memtable which is flushed every" << endl;
+    cout << "64 KB, every other number is updated and a few numbers at random are removed, all parallelly." << endl;
+    cout << "The values are checked while they are spread over skip lists and run files, and after a full flush." << endl;
+    cout << "Then a key is overwritten while it is searched." << endl;
+    cout << "This is an automated test, and only the test results are displayed. " << endl;
+
+    generate_input(20000);
+
+    MemTableOptions options;
+    options.flush_bytes = 64 << 10;
+    options.directory = ".";
+    memtable = new MemTable(options);
+
+    run_chunks(memtable_add, numbers_insert.size());
+    run_chunks(memtable_update, numbers_insert.size());
+    run_chunks(memtable_remove, numbers_delete.size());
+
+    if(check_values()){
+        cout << "Unit Test 1: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 1: Search: FAIL" << endl;
+    }
+
+    memtable->flush();
+    if(memtable->frozen_count() == 0 && memtable->run_count() > 1 && check_values()){
+        cout << "Unit Test 2: Flush: PASS" << endl;
+    }else{
+        cout << "Unit Test 2: Flush: FAIL" << endl;
+    }
+
+    // a key deleted in a newer run stays deleted, and can be inserted again
+    memtable->add(numbers_delete[0], "back");
+    memtable->flush();
+    if(memtable->search(numbers_delete[0]) == "back" && memtable->search(numbers_delete[1]) == "" && memtable->search(-5) == ""){
+        cout << "Unit Test 3: Search: PASS" << endl;
+    }else{
+        cout << "Unit Test 3: Search: FAIL" << endl;
+    }
+
+    size_t runs = memtable->run_count();
+    delete memtable;
+    for (size_t i = 0; i < runs; i++){
+        remove(("./run_" + to_string(i) + ".sst").c_str());
+    }
+
+    // A key written again is replaced in place, so a search never misses it in between
+    options.flush_bytes = 64 << 20;
+    memtable = new MemTable(options);
+    memtable->add(1, "0");
+    thread writer([](){
+        for (int i = 1; i <= 100000; i++){
+            memtable->add(1, to_string(i % 2));
+        }
+    });
+    bool found = true;
+    for (int i = 0; i < 100000; i++){
+        found = found && memtable->search(1) != "";
+    }
+    writer.join();
+    if(found && memtable->search(1) == "0"){
+        cout << "Unit Test 4: Overwrite: PASS" << endl;
+    }else{
+        cout << "Unit Test 4: Overwrite: FAIL" << endl;
+    }
+
+    memtable->flush();
+    runs = memtable->run_count();
+    delete memtable;
+    for (size_t i = 0; i < runs; i++){
+        remove(("./run_" + to_string(i) + ".sst").c_str());
+    }
+    return 0;
+}
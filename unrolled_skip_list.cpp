@@ -0,0 +1,441 @@
+/**
+    Implements the unrolled Concurrent Skip list for integer keys with insert, delete, search and range operations.
+
+    Level 0 is a linked list of blocks. A block owns every key from its low key up to the low key of the next block.
+    Writers lock the block owning the key and bump its version around the modification. Readers never lock, they
+    read a block and retry if its version was odd or changed. A full block splits in two: the upper half moves into a
+    new block which is published at level 0 while the full block is locked, and is linked into the index levels
+    afterwards one level at a time. The index may be stale but never wrong: a search always finishes by moving right
+    at level 0 while the next block's low key is not greater than the key.
+    A block left empty by a remove is marked removed, so that nothing is added to it any more, then unlinked from the
+    top level down to level 0, locking its predecessor and then itself at each level. Its predecessor owns its keys
+    once it is unlinked at level 0. The threads which still reach a removed block look for their block again, and
+    the block, like the values removed, is freed through an epoch reclaimer once no operation may still read it.
+*/
+
+#include <iostream>
+#include <math.h>
+#include <limits>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include "unrolled_skip_list.h"
+
+#define INT_MINI numeric_limits<int>::min()
+
+/**
+    Reclaimer of the blocks and values removed from every unrolled skip list. Never freed, so that it outlives the
+    skip lists.
+*/
+static EpochReclaimer* block_reclaimer(){
+    static EpochReclaimer *reclaimer = new EpochReclaimer();
+    return reclaimer;
+}
+
+/**
+    Frees a block retired once unlinked
+*/
+static void free_block(void *block, void *context){
+    delete (Block*) block;
+}
+
+/**
+    Frees a value retired once removed
+*/
+static void free_value(void *value, void *context){
+    delete (string*) value;
+}
+
+/**
+    Constructor
+*/
+UnrolledSkipList::UnrolledSkipList(int max_elements, float prob){
+    // The index holds blocks, which are at least half full
+    int max_blocks = max_elements / (BLOCK_CAPACITY / 2) + 1;
+    max_level = max_blocks > 1 ? (int) round(log(max_blocks) / log(1/prob)) : 0;
+    head = new Block(INT_MINI, max_level);
+}
+
+/**
+    Randomly generates a number and increments level if number less than or equal to 0.5
+    Once more than 0.5, returns the level or available max level.
+    This decides until which level a new Block is available.
+*/
+int UnrolledSkipList::get_random_level() {
+    int l = 0;
+    while(static_cast <float> (rand()) / static_cast <float> (RAND_MAX) <= 0.5){
+        l++;
+    }
+    return l > max_level ? max_level : l;
+}
+
+/**
+    Descends the index and returns the last block at level 0 whose low key is not greater than key.
+    The block may have split since, the callers move right at level 0 if needed.
+*/
+Block* UnrolledSkipList::find_block(int key){
+    Block *curr = head;
+
+    for (int level = max_level; level >= 0; level--){
+        Block *next = curr->get_next(level);
+        while (next != NULL && next->low <= key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+    }
+    return curr;
+}
+
+/**
+    Finds the last block with a low key smaller than key at each level of the index
+*/
+void UnrolledSkipList::find_index_predecessors(int key, vector<Block*> &predecessors){
+    Block *curr = head;
+
+    for (int level = max_level; level >= 0; level--){
+        Block *next = curr->get_next(level);
+        while (next != NULL && next->low < key){
+            curr = next;
+            next = curr->get_next(level);
+        }
+        predecessors[level] = curr;
+    }
+}
+
+/**
+    Links a block already published at level 0 into the index levels until its top level.
+    A predecessor stays valid as long as no other block was linked after it and it is not removed. Stops once the
+    block is removed, checked under its lock, which unlink_block also takes at each level.
+*/
+void UnrolledSkipList::link_index(Block* block){
+    vector<Block*> preds(max_level + 1);
+
+    for (int level = 1; level <= block->top_level; level++){
+        while(true){
+            find_index_predecessors(block->low, preds);
+            Block *pred = preds[level];
+
+            pred->lock();
+            Block *succ = pred->get_next(level);
+
+            // Another block was linked after the predecessor, or the predecessor is being unlinked, try again
+            if(pred->removed.load(memory_order_relaxed) || (succ != NULL && succ->low < block->low)){
+                pred->unlock();
+                this_thread::yield();
+                continue;
+            }
+
+            block->lock();
+            bool removed = block->removed.load(memory_order_relaxed);
+            if(!removed){
+                block->next[level].store(succ, memory_order_relaxed);
+                pred->set_next(level, block);
+            }
+            block->unlock();
+            pred->unlock();
+            if(removed){
+                return;
+            }
+            break;
+        }
+    }
+}
+
+/**
+    Unlinks a block left empty by a remove, unless a key was added to it meanwhile, and retires it.
+    Level by level from the top, locks the predecessor and then the block, and unlinks the block if the predecessor
+    links it. Levels the block was never linked at are passed over, link_index does not link a removed block.
+*/
+void UnrolledSkipList::unlink_block(Block* block){
+    block->lock();
+    if(block->removed.load(memory_order_relaxed) || block->count.load(memory_order_relaxed) != 0){
+        block->unlock();
+        return;
+    }
+    block->begin_write();
+    block->removed.store(true, memory_order_release);
+    block->end_write();
+    block->unlock();
+
+    vector<Block*> preds(max_level + 1);
+    for (int level = block->top_level; level >= 0; level--){
+        while(true){
+            find_index_predecessors(block->low, preds);
+            Block *pred = preds[level];
+
+            pred->lock();
+            Block *succ = pred->get_next(level);
+            if(pred->removed.load(memory_order_relaxed) || (succ != NULL && succ != block && succ->low < block->low)){
+                pred->unlock();
+                this_thread::yield();
+                continue;
+            }
+
+            if(succ == block){
+                block->lock();
+
+                // The predecessor now owns the keys of the block, readers of it must see the change
+                if(level == 0){
+                    pred->begin_write();
+                }
+                pred->set_next(level, block->get_next(level));
+                if(level == 0){
+                    pred->end_write();
+                }
+                block->unlock();
+            }
+            pred->unlock();
+            break;
+        }
+    }
+    block_reclaimer()->retire(block, free_block);
+}
+
+/**
+    Inserts into the block owning the key using its lock. Splits the block if it is full.
+    Return if already exists.
+*/
+bool UnrolledSkipList::add(int key, string value) {
+    EpochGuard guard(block_reclaimer());
+    Block *block = find_block(key);
+
+    while(true){
+        block->lock();
+
+        // The block is being unlinked, find the block owning the key again once it is
+        if(block->removed.load(memory_order_relaxed)){
+            block->unlock();
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        // The block split after it was found, move right
+        Block *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block->unlock();
+            block = next;
+            continue;
+        }
+
+        int position = block->lower_bound(key);
+        if(position < block->count.load(memory_order_relaxed) && block->keys[position].load(memory_order_relaxed) == key){
+            block->unlock();
+            return false;
+        }
+
+        string *stored_value = new string(value);
+        Block *split = NULL;
+
+        block->begin_write();
+
+        if(block->count.load(memory_order_relaxed) == BLOCK_CAPACITY){
+            // Move the upper half into a new block and publish it at level 0
+            int half = BLOCK_CAPACITY / 2;
+            split = new Block(block->keys[half].load(memory_order_relaxed), get_random_level());
+            for (int i = half; i < BLOCK_CAPACITY; i++){
+                split->insert_at(i - half, block->keys[i].load(memory_order_relaxed), block->values[i].load(memory_order_relaxed));
+            }
+            if(key >= split->low){
+                split->insert_at(split->lower_bound(key), key, stored_value);
+            }
+            split->next[0].store(next, memory_order_relaxed);
+            block->set_next(0, split);
+
+            for (int i = BLOCK_CAPACITY - 1; i >= half; i--){
+                block->erase_at(i);
+            }
+            if(key < split->low){
+                block->insert_at(position, key, stored_value);
+            }
+        }else{
+            block->insert_at(position, key, stored_value);
+        }
+
+        block->end_write();
+        block->unlock();
+
+        if(split != NULL && split->top_level > 0){
+            link_index(split);
+        }
+        return true;
+    }
+}
+
+/**
+    Performs search to find if a key exists without taking any lock.
+    Return value if the key found, else return empty
+*/
+string UnrolledSkipList::search(int key){
+    EpochGuard guard(block_reclaimer());
+    Block *block = find_block(key);
+
+    while(true){
+        unsigned long long version = block->version.load(memory_order_acquire);
+
+        // A writer is modifying the block
+        if(version & 1){
+            this_thread::yield();
+            continue;
+        }
+
+        // The block is being unlinked, its predecessor is about to own the key
+        if(block->removed.load(memory_order_acquire)){
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        Block *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block = next;
+            continue;
+        }
+
+        int position = block->lower_bound(key);
+        bool found = position < block->count.load(memory_order_acquire) && block->keys[position].load(memory_order_acquire) == key;
+        string *value = found ? block->values[position].load(memory_order_acquire) : NULL;
+
+        // The block changed while it was read, read it again. The loads above are acquires, so this one is not
+        // moved before them.
+        if(block->version.load(memory_order_relaxed) != version){
+            continue;
+        }
+
+        // Values are only freed once no operation which may have loaded them, this one included, is running
+        return value != NULL ? *value : "";
+    }
+}
+
+/**
+    Deletes the key from the block owning it using its lock.
+    Return if key doesn't exist in the list. A block other than the head is unlinked once it becomes empty.
+*/
+bool UnrolledSkipList::remove(int key){
+    EpochGuard guard(block_reclaimer());
+    Block *block = find_block(key);
+
+    while(true){
+        block->lock();
+
+        if(block->removed.load(memory_order_relaxed)){
+            block->unlock();
+            this_thread::yield();
+            block = find_block(key);
+            continue;
+        }
+
+        Block *next = block->get_next(0);
+        if(next != NULL && next->low <= key){
+            block->unlock();
+            block = next;
+            continue;
+        }
+
+        int position = block->lower_bound(key);
+        if(position >= block->count.load(memory_order_relaxed) || block->keys[position].load(memory_order_relaxed) != key){
+            block->unlock();
+            return false;
+        }
+
+        string *value = block->values[position].load(memory_order_relaxed);
+        block->begin_write();
+        block->erase_at(position);
+        block->end_write();
+        bool empty = block != head && block->count.load(memory_order_relaxed) == 0;
+        block->unlock();
+
+        // A concurrent search may still be reading the value
+        block_reclaimer()->retire(value, free_value);
+        if(empty){
+            unlink_block(block);
+        }
+        return true;
+    }
+}
+
+/**
+    Finds the block owning start_key and walks level 0 until a block starts after end_key.
+    Every block is copied under its version and read again if it changed. A removed block is empty, the walk moves
+    on to the block after it.
+    Updates and returns the key value pairs in a map.
+*/
+map<int, string> UnrolledSkipList::range(int start_key, int end_key){
+    map<int, string> range_output;
+
+    if(start_key > end_key){
+        return range_output;
+    }
+
+    EpochGuard guard(block_reclaimer());
+    Block *block = find_block(start_key);
+    int keys[BLOCK_CAPACITY];
+    string *values[BLOCK_CAPACITY];
+
+    while(block != NULL && block->low <= end_key){
+        unsigned long long version = block->version.load(memory_order_acquire);
+        if(version & 1){
+            this_thread::yield();
+            continue;
+        }
+
+        int count = block->count.load(memory_order_acquire);
+        for (int i = 0; i < count; i++){
+            keys[i] = block->keys[i].load(memory_order_acquire);
+            values[i] = block->values[i].load(memory_order_acquire);
+        }
+        Block *next = block->get_next(0);
+
+        if(block->version.load(memory_order_relaxed) != version){
+            continue;
+        }
+
+        for (int i = 0; i < count; i++){
+            if(keys[i] >= start_key && keys[i] <= end_key){
+                range_output.insert(make_pair(keys[i], *values[i]));
+            }
+        }
+        block = next;
+    }
+
+    return range_output;
+}
+
+/**
+    Returns the bytes taken by the blocks, values left out.
+    Called while no writer runs.
+*/
+long long UnrolledSkipList::memory_usage(){
+    long long bytes = 0;
+    Block *block = head;
+    while (block != NULL){
+        bytes += sizeof(Block) + (block->top_level + 1) * sizeof(atomic<Block*>);
+        block = block->get_next(0);
+    }
+    return bytes;
+}
+
+/**
+    Display the blocks at level 0 in readable format
+*/
+void UnrolledSkipList::display(){
+    Block *block = head;
+    while (block != NULL){
+        printf("[");
+        for (int i = 0; i < block->count.load(); i++){
+            printf(i == 0 ? "%d" : " %d", block->keys[i].load());
+        }
+        printf("] -> ");
+        block = block->get_next(0);
+    }
+    cout << endl;
+    printf("---------- Display done! ----------\n\n");
+}
+
+UnrolledSkipList::UnrolledSkipList(){
+    head = NULL;
+    max_level = 0;
+}
+
+UnrolledSkipList::~UnrolledSkipList(){
+}
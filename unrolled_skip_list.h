@@ -0,0 +1,40 @@
+#ifndef UNROLLED_SKIP_LIST_H
+#define UNROLLED_SKIP_LIST_H
+
+#include <map>
+#include <vector>
+#include "block.h"
+#include "epoch.h"
+
+/**
+    Skip list for integer keys whose level 0 is made of blocks of BLOCK_CAPACITY sorted keys.
+    A level 0 hop skips a whole block instead of a single key, and the keys of a block are searched with vector compares.
+*/
+class UnrolledSkipList{
+    private:
+        // First block of the skip list, its low key is INT_MIN and it is available at every level
+        Block *head;
+
+        // The Maximum level of the index
+        int max_level;
+
+        Block* find_block(int key);
+        void find_index_predecessors(int key, vector<Block*> &predecessors);
+        void link_index(Block* block);
+        void unlink_block(Block* block);
+    public:
+        UnrolledSkipList();
+        UnrolledSkipList(int max_elements, float probability);
+        ~UnrolledSkipList();
+        int get_random_level();
+
+        // Supported operations
+        bool add(int key, string value);
+        string search(int key);
+        bool remove(int key);
+        map<int, string> range(int start_key, int end_key);
+        long long memory_usage();
+        void display();
+};
+
+#endif
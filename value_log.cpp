@@ -0,0 +1,306 @@
+/**
+    Implements the in-memory value log of a skip list.
+
+    Readers never lock. A reader enters a critical section of the reclaimer (epoch.h) before it loads the handle
+    of a node. Once no node holds a handle of a segment, compaction retires the segment, and its bytes and slot
+    are freed once every reader which entered before has left: a reader which entered after cannot load one of
+    its handles any more. Compaction never waits for the readers.
+*/
+
+#include <string.h>
+#include "value_log.h"
+
+static atomic<unsigned int> next_value_log_stripe(0);
+
+/**
+    Returns the stripe of the calling thread. Threads are assigned stripes round robin on first use.
+*/
+static int local_stripe(){
+    static thread_local int stripe = next_value_log_stripe.fetch_add(1, memory_order_relaxed) % VALUE_LOG_STRIPES;
+    return stripe;
+}
+
+/**
+    Constructor
+*/
+ValueLog::ValueLog(){
+    segments = new atomic<ValueSegment*>[VALUE_LOG_MAX_SEGMENTS];
+    for (int i = 0; i < VALUE_LOG_MAX_SEGMENTS; i++){
+        segments[i].store(NULL, memory_order_relaxed);
+    }
+    slot_count = 0;
+    for (int i = 0; i < VALUE_LOG_STRIPES; i++){
+        appenders[i].active = -1;
+    }
+    compaction_running = false;
+}
+
+/**
+    Returns the handle of the record at offset in the segment of the slot
+*/
+uint64_t ValueLog::make_handle(int slot, uint16_t generation, uint32_t offset){
+    return ((uint64_t) slot << 48) | ((uint64_t) generation << 32) | offset;
+}
+
+/**
+    Returns the segment a handle of the log points into
+*/
+ValueSegment* ValueLog::segment_of(uint64_t handle){
+    return segments[(handle >> 48) & (VALUE_LOG_MAX_SEGMENTS - 1)].load(memory_order_acquire);
+}
+
+/**
+    Returns the number of bytes of a record
+*/
+uint32_t ValueLog::record_size(const char *record){
+    uint32_t length;
+    memcpy(&length, record, 4);
+    return VALUE_LOG_RECORD_HEADER + length;
+}
+
+/**
+    Allocates a segment of capacity bytes in a free slot.
+    Returns the slot, or -1 if every slot is used.
+*/
+int ValueLog::new_segment(uint32_t capacity){
+    lock_guard<mutex> guard(slot_mutex);
+    int slot;
+    if(!free_slots.empty()){
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }else if(slot_count < VALUE_LOG_MAX_SEGMENTS){
+        slot = slot_count++;
+    }else{
+        return -1;
+    }
+
+    ValueSegment *segment = segments[slot].load(memory_order_relaxed);
+    if(segment == NULL){
+        segment = new ValueSegment();
+        segment->generation = 1;
+    }
+    segment->bytes = new char[capacity];
+    segment->capacity = capacity;
+    segment->used = 0;
+    segment->live_bytes = 0;
+    segment->state.store(VALUE_SEGMENT_ACTIVE, memory_order_release);
+    segments[slot].store(segment, memory_order_release);
+    return slot;
+}
+
+/**
+    Appends the value of key to the segment of the stripe of the calling thread, sealing it and starting a new
+    one if the value does not fit.
+    Returns the handle of the value, or 0 if every slot is used.
+*/
+uint64_t ValueLog::append(int key, const string &value){
+    uint32_t size = VALUE_LOG_RECORD_HEADER + value.size();
+    AppendStripe &stripe = appenders[local_stripe()];
+    lock_guard<mutex> guard(stripe.append_mutex);
+
+    ValueSegment *segment = stripe.active >= 0 ? segments[stripe.active].load(memory_order_relaxed) : NULL;
+    if(segment == NULL || segment->used + size > segment->capacity){
+        if(segment != NULL){
+            segment->state.store(VALUE_SEGMENT_SEALED, memory_order_release);
+        }
+        stripe.active = new_segment(size > VALUE_LOG_SEGMENT_BYTES ? size : VALUE_LOG_SEGMENT_BYTES);
+        if(stripe.active < 0){
+            return 0;
+        }
+        segment = segments[stripe.active].load(memory_order_relaxed);
+    }
+
+    uint32_t offset = segment->used;
+    uint32_t length = value.size();
+    memcpy(segment->bytes + offset, &length, 4);
+    memcpy(segment->bytes + offset + 4, &key, 4);
+    memcpy(segment->bytes + offset + VALUE_LOG_RECORD_HEADER, value.data(), length);
+    segment->used += size;
+    segment->live_bytes.fetch_add(size);
+    return make_handle(stripe.active, segment->generation, offset);
+}
+
+/**
+    Copies the value of the handle stored in a node into value.
+    Returns false if the node has no handle.
+*/
+bool ValueLog::read(const atomic<uint64_t> &handle, string &value){
+    // The segment of the handle is not freed before the reader leaves
+    EpochGuard guard(&reclaimer);
+    uint64_t current = handle.load();
+    if(current == 0){
+        return false;
+    }
+    if(current & VALUE_HANDLE_KEPT){
+        value = *(string*) (uintptr_t) (current & ~VALUE_HANDLE_KEPT);
+        return true;
+    }
+    const char *record = segment_of(current)->bytes + (uint32_t) current;
+    uint32_t length;
+    memcpy(&length, record, 4);
+    value.assign(record + VALUE_LOG_RECORD_HEADER, length);
+    return true;
+}
+
+/**
+    Counts the value of a handle of the log as dead. Called once the handle was replaced in its node, or was
+    never stored in one.
+*/
+void ValueLog::release(uint64_t handle){
+    ValueSegment *segment = segment_of(handle);
+    segment->live_bytes.fetch_sub(record_size(segment->bytes + (uint32_t) handle));
+}
+
+/**
+    Moves the value of the handle stored in a node out of the log, into a string of its own which the handle
+    then points to. Called when the node is unlinked: readers which reached it before may still read its value,
+    and it must not keep its segment from being freed.
+*/
+void ValueLog::keep(atomic<uint64_t> &handle){
+    while(true){
+        uint64_t current = handle.load();
+        if(current == 0 || (current & VALUE_HANDLE_KEPT)){
+            return;
+        }
+        string *value = new string();
+        read(handle, *value);
+
+        // Compaction may have moved the value meanwhile
+        if(handle.compare_exchange_strong(current, VALUE_HANDLE_KEPT | (uint64_t) (uintptr_t) value)){
+            release(current);
+            return;
+        }
+        delete value;
+    }
+}
+
+/**
+    Frees the string of a kept value. Called when the node holding the handle is freed.
+*/
+void ValueLog::discard(atomic<uint64_t> &handle){
+    uint64_t current = handle.exchange(0);
+    if(current & VALUE_HANDLE_KEPT){
+        delete (string*) (uintptr_t) (current & ~VALUE_HANDLE_KEPT);
+    }
+}
+
+/**
+    Returns the slots of the sealed segments with less than VALUE_LOG_COMPACT_RATIO of their bytes live
+*/
+vector<int> ValueLog::compactable_segments(){
+    vector<int> slots;
+    int count;
+    {
+        lock_guard<mutex> guard(slot_mutex);
+        count = slot_count;
+    }
+    for (int slot = 0; slot < count; slot++){
+        ValueSegment *segment = segments[slot].load(memory_order_acquire);
+        if(segment != NULL && segment->state.load(memory_order_acquire) == VALUE_SEGMENT_SEALED
+            && segment->live_bytes.load() < segment->used * VALUE_LOG_COMPACT_RATIO){
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+/**
+    Stores the key and the handle of every record of a sealed segment
+*/
+void ValueLog::records(int slot, vector<pair<int, uint64_t>> &records){
+    ValueSegment *segment = segments[slot].load(memory_order_acquire);
+    uint32_t offset = 0;
+    while(offset < segment->used){
+        int key;
+        memcpy(&key, segment->bytes + offset + 4, 4);
+        records.push_back(make_pair(key, make_handle(slot, segment->generation, offset)));
+        offset += record_size(segment->bytes + offset);
+    }
+}
+
+/**
+    Returns the value of a handle of the log. Only compaction frees segments, so it may read them directly.
+*/
+string ValueLog::read_record(uint64_t handle){
+    const char *record = segment_of(handle)->bytes + (uint32_t) handle;
+    uint32_t length;
+    memcpy(&length, record, 4);
+    return string(record + VALUE_LOG_RECORD_HEADER, length);
+}
+
+/**
+    Retires the segment of the slot if none of its values is live any more. Its bytes and its slot are freed
+    once no reader may still be in it, without waiting for the readers.
+    Returns the number of bytes retired.
+*/
+long long ValueLog::free_segment(int slot){
+    ValueSegment *segment = segments[slot].load(memory_order_acquire);
+    if(segment->live_bytes.load() != 0){
+        return 0;
+    }
+    long long freed = segment->capacity;
+    segment->state.store(VALUE_SEGMENT_RETIRED, memory_order_release);
+    reclaimer.retire((void*) (intptr_t) slot, free_slot, this);
+    reclaimer.reclaim();
+    return freed;
+}
+
+/**
+    Frees the bytes of a retired segment and makes its slot free, called by the reclaimer
+*/
+void ValueLog::free_slot(void *slot, void *log){
+    ValueLog *value_log = (ValueLog*) log;
+    int index = (int) (intptr_t) slot;
+    ValueSegment *segment = value_log->segments[index].load(memory_order_acquire);
+
+    lock_guard<mutex> guard(value_log->slot_mutex);
+    delete[] segment->bytes;
+    segment->bytes = NULL;
+    segment->capacity = 0;
+    segment->used = 0;
+    segment->generation = segment->generation == UINT16_MAX ? 1 : segment->generation + 1;
+    segment->state.store(VALUE_SEGMENT_FREE, memory_order_release);
+    value_log->free_slots.push_back(index);
+}
+
+/**
+    Returns the bytes of the values still live
+*/
+long long ValueLog::live_bytes(){
+    lock_guard<mutex> guard(slot_mutex);
+    long long bytes = 0;
+    for (int slot = 0; slot < slot_count; slot++){
+        ValueSegment *segment = segments[slot].load(memory_order_acquire);
+        if(segment != NULL){
+            bytes += segment->live_bytes.load();
+        }
+    }
+    return bytes;
+}
+
+/**
+    Returns the bytes allocated to segments
+*/
+long long ValueLog::segment_bytes(){
+    lock_guard<mutex> guard(slot_mutex);
+    long long bytes = 0;
+    for (int slot = 0; slot < slot_count; slot++){
+        ValueSegment *segment = segments[slot].load(memory_order_acquire);
+        if(segment != NULL){
+            bytes += segment->capacity;
+        }
+    }
+    return bytes;
+}
+
+ValueLog::~ValueLog(){
+    reclaimer.drain();
+    for (int slot = 0; slot < slot_count; slot++){
+        ValueSegment *segment = segments[slot].load(memory_order_relaxed);
+        if(segment != NULL){
+            delete[] segment->bytes;
+            delete segment;
+        }
+    }
+    delete[] segments;
+}
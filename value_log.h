@@ -0,0 +1,128 @@
+#ifndef VALUE_LOG_H
+#define VALUE_LOG_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "epoch.h"
+
+using namespace std;
+
+/**
+    Append-only log of the values of a skip list, kept in memory.
+
+    Record: value length (uint32) | key (int32) | value bytes
+    Values are appended to segments of VALUE_LOG_SEGMENT_BYTES, and a node stores the handle of its value instead
+    of the value. Each thread appends to the segment of its own stripe, so writers do not contend on one buffer.
+    A full segment is sealed and never written again. The live bytes of a segment drop when the handle of one
+    of its values is replaced, and compaction moves the values still live out of the sealed segments which are
+    mostly dead, then frees them.
+
+    Handle: segment slot (15 bits) | generation of the slot (16 bits) | offset of the record (32 bits)
+    0 is no handle. A handle with VALUE_HANDLE_KEPT set points to a string of its own instead, for nodes which
+    were unlinked and whose value left the log. The string is freed with its node, by discard.
+*/
+
+// Bytes of a segment. A larger value gets a segment of its own.
+#define VALUE_LOG_SEGMENT_BYTES (1 << 20)
+
+// Number of segment slots, so at most 32 GB of segments of the default size
+#define VALUE_LOG_MAX_SEGMENTS (1 << 15)
+
+// Number of stripes of appenders
+#define VALUE_LOG_STRIPES 16
+
+// Size of a record without its value
+#define VALUE_LOG_RECORD_HEADER 8
+
+// Sealed segments with less than this share of their bytes live are compacted
+#define VALUE_LOG_COMPACT_RATIO 0.5
+
+#define VALUE_HANDLE_KEPT (1ULL << 63)
+
+#define VALUE_SEGMENT_FREE 0
+#define VALUE_SEGMENT_ACTIVE 1
+#define VALUE_SEGMENT_SEALED 2
+#define VALUE_SEGMENT_RETIRED 3
+
+/**
+    One segment of the value log. The object of a slot is never freed, only its bytes, once no reader may still
+    be in them.
+*/
+struct ValueSegment{
+    char *bytes;
+    uint32_t capacity;
+
+    // Written by the appender of the stripe while the segment is active, fixed once it is sealed
+    uint32_t used;
+
+    // Bytes of the records whose handle is still stored in a node, or about to be
+    atomic<long long> live_bytes;
+
+    atomic<int> state;
+
+    // Changed every time the slot is freed, so a handle of a freed segment never matches a new one
+    uint16_t generation;
+};
+
+/**
+    Segment appended to by the threads of a stripe
+*/
+struct AppendStripe{
+    mutex append_mutex;
+    int active;
+};
+
+class ValueLog{
+    private:
+        atomic<ValueSegment*> *segments;
+
+        // Slots used so far and the slots of the freed segments, changed under slot_mutex
+        int slot_count;
+        vector<int> free_slots;
+        mutex slot_mutex;
+
+        AppendStripe appenders[VALUE_LOG_STRIPES];
+
+        // Readers are in a critical section while they copy a value, and freed segments wait for them
+        EpochReclaimer reclaimer;
+
+        int new_segment(uint32_t capacity);
+        static void free_slot(void *slot, void *log);
+        ValueSegment* segment_of(uint64_t handle);
+        static uint64_t make_handle(int slot, uint16_t generation, uint32_t offset);
+        static uint32_t record_size(const char *record);
+    public:
+        // Serializes the compactions
+        mutex compaction_mutex;
+
+        // Background compaction, run by SkipList::start_value_compaction
+        thread compaction_thread;
+        mutex compaction_thread_mutex;
+        condition_variable compaction_condition;
+        bool compaction_running;
+
+        ValueLog();
+        ~ValueLog();
+
+        uint64_t append(int key, const string &value);
+        bool read(const atomic<uint64_t> &handle, string &value);
+        void release(uint64_t handle);
+        void keep(atomic<uint64_t> &handle);
+        static void discard(atomic<uint64_t> &handle);
+
+        // Compaction, called with compaction_mutex held
+        vector<int> compactable_segments();
+        void records(int slot, vector<pair<int, uint64_t>> &records);
+        string read_record(uint64_t handle);
+        long long free_segment(int slot);
+
+        long long live_bytes();
+        long long segment_bytes();
+};
+
+#endif
@@ -0,0 +1,273 @@
+/**
+    Implements the write-ahead log of the skip list with group commit
+*/
+
+#include <iostream>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include "write_ahead_log.h"
+#include "snapshot.h"
+
+// Initial value of the record checksums, the FNV-1a offset basis
+#define WAL_CHECKSUM_BASIS 14695981039346656037ULL
+
+/**
+    Constructor
+*/
+WriteAheadLog::WriteAheadLog(){
+    fd = -1;
+    mode = WAL_SYNC;
+    sync_interval_ms = 0;
+    appended_lsn = 0;
+    written_lsn = 0;
+    synced_lsn = 0;
+    flushing = false;
+    failed = false;
+    records = 0;
+    syncs = 0;
+    background_running = false;
+}
+
+/**
+    Opens the log at path for appending and starts the background thread of the periodic and asynchronous modes
+*/
+bool WriteAheadLog::open(const string &path, WalMode wal_mode, int interval_ms){
+    close();
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd < 0){
+        return false;
+    }
+
+    mode = wal_mode;
+    sync_interval_ms = interval_ms;
+    failed = false;
+    buffer.clear();
+    appended_lsn = written_lsn = synced_lsn = lseek(fd, 0, SEEK_END);
+
+    if(mode != WAL_SYNC){
+        background_running = true;
+        background_thread = thread([this]() {
+            unique_lock<mutex> guard(log_mutex);
+            while(background_running){
+                background_condition.wait_for(guard, chrono::milliseconds(sync_interval_ms));
+                uint64_t lsn = appended_lsn;
+                guard.unlock();
+                flush(lsn, mode == WAL_PERIODIC);
+                guard.lock();
+            }
+        });
+    }
+    return true;
+}
+
+/**
+    Writes and syncs every record appended so far, stops the background thread and closes the file
+*/
+void WriteAheadLog::close(){
+    if(fd < 0){
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(log_mutex);
+        background_running = false;
+    }
+    background_condition.notify_all();
+    if(background_thread.joinable()){
+        background_thread.join();
+    }
+
+    uint64_t lsn;
+    {
+        lock_guard<mutex> guard(log_mutex);
+        lsn = appended_lsn;
+    }
+    flush(lsn, true);
+
+    lock_guard<mutex> guard(log_mutex);
+    ::close(fd);
+    fd = -1;
+}
+
+bool WriteAheadLog::is_open(){
+    return fd >= 0;
+}
+
+/**
+    Encodes a record into the buffer. Returns its log sequence number, or 0 if the log is not open.
+*/
+uint64_t WriteAheadLog::append(uint8_t type, int key, const char *value, uint32_t length){
+    char header[WAL_RECORD_HEADER];
+    int32_t record_key = key;
+    header[4] = type;
+    memcpy(header + 5, &record_key, sizeof(record_key));
+    memcpy(header + 9, &length, sizeof(length));
+
+    uint64_t checksum = snapshot_checksum(header + 4, WAL_RECORD_HEADER - 4, WAL_CHECKSUM_BASIS);
+    uint32_t stored_checksum = (uint32_t) snapshot_checksum(value, length, checksum);
+    memcpy(header, &stored_checksum, sizeof(stored_checksum));
+
+    lock_guard<mutex> guard(log_mutex);
+    if(fd < 0){
+        return 0;
+    }
+    buffer.append(header, WAL_RECORD_HEADER);
+    buffer.append(value, length);
+    appended_lsn += WAL_RECORD_HEADER + length;
+    records++;
+    return appended_lsn;
+}
+
+uint64_t WriteAheadLog::append_add(int key, const string &value, long long expiry_ms){
+    if(expiry_ms == 0){
+        return append(WAL_RECORD_ADD, key, value.data(), value.size());
+    }
+    int64_t expiry = expiry_ms;
+    string record_value((const char*) &expiry, sizeof(expiry));
+    record_value += value;
+    return append(WAL_RECORD_ADD_EXPIRING, key, record_value.data(), record_value.size());
+}
+
+uint64_t WriteAheadLog::append_remove(int key){
+    return append(WAL_RECORD_REMOVE, key, "", 0);
+}
+
+/**
+    Waits until the log is written, and synced if sync is set, up to lsn.
+    If no other thread is flushing, this thread becomes the leader and writes the whole buffer with one write
+    and at most one fdatasync, for itself and every writer which appended before.
+*/
+bool WriteAheadLog::flush(uint64_t lsn, bool sync){
+    unique_lock<mutex> guard(log_mutex);
+    while((sync ? synced_lsn : written_lsn) < lsn){
+        if(failed){
+            return false;
+        }
+        if(flushing){
+            flushed.wait(guard);
+            continue;
+        }
+
+        flushing = true;
+        string batch;
+        batch.swap(buffer);
+        uint64_t target = appended_lsn;
+        guard.unlock();
+
+        bool written = true;
+        size_t offset = 0;
+        while(written && offset < batch.size()){
+            ssize_t count = write(fd, batch.data() + offset, batch.size() - offset);
+            if(count < 0 && errno != EINTR){
+                written = false;
+            }else if(count > 0){
+                offset += count;
+            }
+        }
+        if(written && sync){
+            written = fdatasync(fd) == 0;
+        }
+
+        guard.lock();
+        flushing = false;
+        if(written){
+            written_lsn = target;
+            if(sync){
+                synced_lsn = target;
+                syncs++;
+            }
+        }else{
+            cerr << "write-ahead log: " << strerror(errno) << '\n';
+            failed = true;
+        }
+        flushed.notify_all();
+    }
+    return true;
+}
+
+/**
+    Makes the record with the given log sequence number durable as required by the mode
+*/
+bool WriteAheadLog::commit(uint64_t lsn){
+    if(lsn == 0){
+        return true;
+    }
+    if(mode == WAL_SYNC){
+        return flush(lsn, true);
+    }
+    if(mode == WAL_PERIODIC){
+        return flush(lsn, false);
+    }
+    return true;
+}
+
+bool WriteAheadLog::has_failed(){
+    lock_guard<mutex> guard(log_mutex);
+    return failed;
+}
+
+uint64_t WriteAheadLog::record_count(){
+    lock_guard<mutex> guard(log_mutex);
+    return records;
+}
+
+uint64_t WriteAheadLog::sync_count(){
+    lock_guard<mutex> guard(log_mutex);
+    return syncs;
+}
+
+WriteAheadLog::~WriteAheadLog(){
+    close();
+}
+
+/**
+    Reads the whole log and applies its valid records in order
+*/
+long long read_write_ahead_log(const string &path, void (*apply)(void *context, uint8_t type, int key, const string &value), void *context){
+    int file = ::open(path.c_str(), O_RDONLY);
+    if(file < 0){
+        return errno == ENOENT ? 0 : -1;
+    }
+
+    string data;
+    char chunk[1 << 16];
+    ssize_t count;
+    while((count = read(file, chunk, sizeof(chunk))) != 0){
+        if(count < 0 && errno != EINTR){
+            ::close(file);
+            return -1;
+        }
+        if(count > 0){
+            data.append(chunk, count);
+        }
+    }
+    ::close(file);
+
+    size_t offset = 0;
+    while(offset + WAL_RECORD_HEADER <= data.size()){
+        const char *record = data.data() + offset;
+        uint32_t stored_checksum;
+        int32_t key;
+        uint32_t length;
+        memcpy(&stored_checksum, record, sizeof(stored_checksum));
+        memcpy(&key, record + 5, sizeof(key));
+        memcpy(&length, record + 9, sizeof(length));
+
+        if(length > data.size() - offset - WAL_RECORD_HEADER){
+            break;
+        }
+        uint64_t checksum = snapshot_checksum(record + 4, WAL_RECORD_HEADER - 4 + length, WAL_CHECKSUM_BASIS);
+        uint8_t type = record[4];
+        if((uint32_t) checksum != stored_checksum || (type != WAL_RECORD_ADD && type != WAL_RECORD_REMOVE && type != WAL_RECORD_ADD_EXPIRING)){
+            break;
+        }
+
+        apply(context, type, key, string(record + WAL_RECORD_HEADER, length));
+        offset += WAL_RECORD_HEADER + length;
+    }
+    return offset;
+}
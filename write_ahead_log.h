@@ -0,0 +1,110 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+/**
+    Write-ahead log of the mutations of a skip list.
+
+    Record: checksum (uint32) | type (uint8) | key (int32) | value length (uint32) | value bytes
+    The checksum covers everything after it. Recovery stops at the first record which is torn or does not match
+    its checksum, and cuts the file there.
+*/
+
+#define WAL_RECORD_ADD 1
+#define WAL_RECORD_REMOVE 2
+
+// An add of a key which expires. The value starts with the expiry time (int64, milliseconds since the epoch).
+#define WAL_RECORD_ADD_EXPIRING 3
+
+// Size of a record without its value
+#define WAL_RECORD_HEADER 13
+
+/**
+    When a mutation is durable
+    - WAL_SYNC: before add or remove returns. Concurrent writers share one fdatasync (group commit).
+    - WAL_PERIODIC: add or remove returns once the record is written to the file, a background thread calls
+      fdatasync every sync_interval_ms. A crash of the machine loses at most the last interval.
+    - WAL_ASYNC: records are buffered in memory and written by a background thread every sync_interval_ms,
+      without fdatasync. A crash of the process loses at most the last interval.
+*/
+enum WalMode{
+    WAL_SYNC,
+    WAL_PERIODIC,
+    WAL_ASYNC
+};
+
+/**
+    Log file shared by all the writers of a skip list.
+    Records are appended to an in-memory buffer inside the critical section of the operation, so the order of
+    the log matches the order of the mutations. The writer which then finds no flush running becomes the leader:
+    it writes the whole buffer, including the records of the writers which arrived meanwhile, and the others wait.
+*/
+class WriteAheadLog{
+    private:
+        int fd;
+        WalMode mode;
+        int sync_interval_ms;
+
+        mutex log_mutex;
+        condition_variable flushed;
+
+        // Records appended and not yet handed to a leader
+        string buffer;
+
+        // Log sequence numbers: the end offset of the last record appended, written to the file and synced
+        uint64_t appended_lsn;
+        uint64_t written_lsn;
+        uint64_t synced_lsn;
+
+        // Set while a leader writes outside the mutex
+        bool flushing;
+
+        // Set once a write or fdatasync failed. Nothing is written after a failure.
+        bool failed;
+
+        // Number of records appended and number of fdatasync calls, to measure the size of the groups
+        uint64_t records;
+        uint64_t syncs;
+
+        // Background writer or syncer of the periodic and asynchronous modes
+        thread background_thread;
+        condition_variable background_condition;
+        bool background_running;
+
+        uint64_t append(uint8_t type, int key, const char *value, uint32_t length);
+        bool flush(uint64_t lsn, bool sync);
+    public:
+        WriteAheadLog();
+        ~WriteAheadLog();
+        bool open(const string &path, WalMode mode, int sync_interval_ms);
+        void close();
+        bool is_open();
+
+        // Called inside the critical section of the mutation, return the log sequence number of the record
+        uint64_t append_add(int key, const string &value, long long expiry_ms = 0);
+        uint64_t append_remove(int key);
+
+        // Called after the locks of the mutation are released, waits until the record is durable for the mode
+        bool commit(uint64_t lsn);
+
+        // True once a write or fdatasync failed, from then on nothing is logged
+        bool has_failed();
+
+        uint64_t record_count();
+        uint64_t sync_count();
+};
+
+/**
+    Reads the records of the log at path in order, calling apply for each.
+    Returns the length of the valid prefix of the file, or -1 if it cannot be read.
+*/
+long long read_write_ahead_log(const string &path, void (*apply)(void *context, uint8_t type, int key, const string &value), void *context);
+
+#endif